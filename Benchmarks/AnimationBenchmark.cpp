@@ -0,0 +1,1259 @@
+#include "Core/Core.hpp"
+#include "Core/Log/Logger.hpp"
+#include "Core/Math/Base.hpp"
+#include "Core/Math/Ext.hpp"
+#include "Core/Thread/JobSystem.hpp"
+#include "Engine/ECS/Animation/Animation.hpp"
+#include "Engine/ECS/Animation/Animator.hpp"
+#include "Engine/ECS/Animation/AnimationSystem.hpp"
+#include "Engine/ECS/Transform.hpp"
+#include "Engine/ECS/Animation/KeyframeSearch.hpp"
+#include "Engine/ECS/Skeleton/SkeletalMesh.hpp"
+#include "Engine/ECS/Skeleton/MorphTargets.hpp"
+#include "Engine/ECS/Animation/AnimationFile.hpp"
+#include "Engine/ECS/Animation/BakedClip.hpp"
+#include "Engine/ECS/Animation/Skinning.hpp"
+#include "Engine/ECS/Animation/BoneMask.hpp"
+#include "Engine/Filesystem/Filesystem.hpp"
+#include "Engine/Subsystems/AnimationsManager.hpp"
+
+#include "AnimationFixtures.hpp"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// ----------------------------------------------------
+//										ALLOCATION COUNTER
+// ----------------------------------------------------
+
+/** @brief Number of heap allocations made by the process, on every thread. */
+static std::atomic<u64> g_nrAllocations{ 0 };
+
+void* operator new(std::size_t size)
+{
+	g_nrAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	g_nrAllocations.fetch_add(1, std::memory_order_relaxed);
+	size = (size + static_cast<std::size_t>(alignment) - 1) / static_cast<std::size_t>(alignment) * static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+	if (void* ptr = _aligned_malloc(size ? size : 1, static_cast<std::size_t>(alignment)))
+#else
+	if (void* ptr = std::aligned_alloc(static_cast<std::size_t>(alignment), size ? size : static_cast<std::size_t>(alignment)))
+#endif
+		return ptr;
+	throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+#if defined(_MSC_VER)
+void operator delete(void* ptr, std::align_val_t) noexcept { _aligned_free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { _aligned_free(ptr); }
+#else
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+#endif
+
+// ----------------------------------------------------
+//										UTILITIES
+// ----------------------------------------------------
+
+/** @brief Builds a position track with evenly spaced keys, one every tick. */
+static UniquePtr<KeyPosition[]> CreatePositionTrack(u32 nrKeys)
+{
+	auto keys = std::make_unique<KeyPosition[]>(nrKeys);
+	for (u32 i = 0; i < nrKeys; i++)
+	{
+		keys[i].timeStamp = static_cast<f32>(i);
+		keys[i].position = vec3f(static_cast<f32>(i));
+	}
+	return keys;
+}
+
+/** @brief Builds a cylinder of vertices with three or four influences each, spread over the bones. The weights sum to one. */
+static Vector<Vertex_P_N_UV_T_B> CreateSkinnedVertices(u32 nrVertices, u32 nrBones)
+{
+	Vector<Vertex_P_N_UV_T_B> vertices(nrVertices);
+	for (u32 i = 0; i < nrVertices; i++)
+	{
+		Vertex_P_N_UV_T_B& vertex = vertices[i];
+		f32 t = static_cast<f32>(i);
+		vertex.position = vec3f(std::sin(t * 0.01f), t / nrVertices, std::cos(t * 0.01f));
+		vertex.normal = glm::normalize(vec3f(std::sin(t), 0.5f, std::cos(t)));
+
+		// Four influences, the last one left out on every other vertex
+		const u32 nrInfluences = i % 2 == 0 ? 4 : 3;
+		for (u32 k = 0; k < nrInfluences; k++)
+			vertex.AddBone(static_cast<i32>((i * 7 + k * 13) % nrBones), 1.0f / nrInfluences);
+	}
+	return vertices;
+}
+
+/** @brief Same as the conversion of `SkeletalMesh`: the letters of Assimp are the rows, the digits the columns. */
+static mat4f AiMatrixToGLM(const aiMatrix4x4& matrix)
+{
+	mat4f m{};
+	m[0][0] = matrix.a1; m[1][0] = matrix.a2; m[2][0] = matrix.a3; m[3][0] = matrix.a4;
+	m[0][1] = matrix.b1; m[1][1] = matrix.b2; m[2][1] = matrix.b3; m[3][1] = matrix.b4;
+	m[0][2] = matrix.c1; m[1][2] = matrix.c2; m[2][2] = matrix.c3; m[3][2] = matrix.c4;
+	m[0][3] = matrix.d1; m[1][3] = matrix.d2; m[2][3] = matrix.d3; m[3][3] = matrix.d4;
+	return m;
+}
+
+/**
+ * @brief Loads the bones and the node hierarchy of a skeletal model, in the order of `SkeletalMesh::CreateFromFile`,
+ * without its meshes. No OpenGL context is required.
+ *
+ * @param relative The path of the model inside the skeletal model directory. E.g. "Mutant/Mutant.gltf".
+ */
+static bool LoadSkeletonBones(SkeletalMesh& skeleton, const fs::path& relative)
+{
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile((Filesystem::GetSkeletalModelsPath() / relative).string(), aiProcess_Triangulate | aiProcess_LimitBoneWeights);
+	if (!scene || !scene->mRootNode)
+		return false;
+
+	u32 totalBones = 0;
+	for (u32 i = 0; i < scene->mNumMeshes; i++)
+		totalBones += scene->mMeshes[i]->mNumBones;
+
+	skeleton.bones = std::make_shared<Bone[]>(totalBones);
+	skeleton.boneNames = std::make_shared<Array<char, 32>[]>(totalBones);
+	skeleton.nrBones = 0;
+
+	auto loadNode = [&](auto& self, const aiNode* node) -> void {
+		for (u32 i = 0; i < node->mNumMeshes; i++)
+		{
+			const aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+			for (u32 j = 0; j < mesh->mNumBones; j++)
+			{
+				const char* name = mesh->mBones[j]->mName.C_Str();
+				if (skeleton.FindBone(name) != -1)
+					continue;
+
+				skeleton.boneNames[skeleton.nrBones].fill(0);
+				std::strncpy(skeleton.boneNames[skeleton.nrBones].data(), name, 31);
+				skeleton.bones[skeleton.nrBones].offset = AiMatrixToGLM(mesh->mBones[j]->mOffsetMatrix);
+				skeleton.nrBones++;
+			}
+		}
+		for (u32 i = 0; i < node->mNumChildren; i++)
+			self(self, node->mChildren[i]);
+	};
+	loadNode(loadNode, scene->mRootNode);
+	skeleton.HashBoneNames();
+
+	// Pre-order, as `SkeletalMesh::LoadBoneHierarchy`
+	Vector<BoneNode> hierarchy;
+	auto loadHierarchy = [&](auto& self, const aiNode* src, i32 parent) -> u32 {
+		const i32 boneIndex = skeleton.FindBone(src->mName.C_Str());
+		const i32 nodeIndex = static_cast<i32>(hierarchy.size());
+		BoneNode& node = hierarchy.emplace_back();
+		node.bindPoseTransform = AiMatrixToGLM(src->mTransformation);
+		node.offset = boneIndex != -1 ? skeleton.bones[boneIndex].offset : mat4f(1.0f);
+		node.parent = parent;
+		node.index = boneIndex;
+
+		u32 height = 0;
+		for (u32 i = 0; i < src->mNumChildren; i++)
+			height = std::max(height, self(self, src->mChildren[i], nodeIndex) + 1);
+		hierarchy[nodeIndex].height = height;
+		return height;
+	};
+	loadHierarchy(loadHierarchy, scene->mRootNode, -1);
+	skeleton.nrNodes = static_cast<u32>(hierarchy.size());
+	skeleton.nodes = std::make_shared<BoneNode[]>(skeleton.nrNodes);
+	std::copy(hierarchy.begin(), hierarchy.end(), skeleton.nodes.get());
+	return skeleton.nrBones > 0;
+}
+
+/** @brief The skeletal models found in the skeletal model directory: one directory per model, named as its model file. */
+static Vector<fs::path> FindSkeletalModels()
+{
+	Vector<fs::path> models;
+	if (!fs::is_directory(Filesystem::GetSkeletalModelsPath()))
+		return models;
+
+	for (const fs::directory_entry& entry : fs::directory_iterator(Filesystem::GetSkeletalModelsPath()))
+	{
+		if (!entry.is_directory())
+			continue;
+
+		for (const char* extension : { ".gltf", ".glb", ".fbx", ".dae" })
+		{
+			const fs::path modelFile = entry.path().filename().string() + extension;
+			if (fs::exists(entry.path() / modelFile))
+			{
+				models.push_back(entry.path().filename() / modelFile);
+				break;
+			}
+		}
+	}
+	std::sort(models.begin(), models.end());
+	return models;
+}
+
+/** @brief The clips listed in the "animlist.txt" file of a skeletal model, relative to the skeletal model directory. */
+static Vector<fs::path> ReadClipList(const fs::path& model)
+{
+	Vector<fs::path> clips;
+	IStream file(Filesystem::GetSkeletalModelsPath() / model / "animlist.txt");
+	for (fs::path clip; file >> clip;)
+		clips.push_back(model / clip);
+	return clips;
+}
+
+/** @brief Runs the callable `iterations` times and returns the elapsed time in nanoseconds. */
+template<typename Func>
+static f64 Measure(u32 iterations, Func&& func)
+{
+	auto t0 = chrono::steady_clock::now();
+	for (u32 i = 0; i < iterations; i++)
+		func();
+	auto t1 = chrono::steady_clock::now();
+	return chrono::duration_cast<chrono::duration<f64, std::nano>>(t1 - t0).count();
+}
+
+// ----------------------------------------------------
+//										RESULTS
+// ----------------------------------------------------
+
+/** @brief Results file given with "--csv=<path>": one row per case of the suite, to compare the runs of two versions. */
+static OStream g_results;
+
+/**
+ * @brief Reports a case of the suite on the standard output and in the results file.
+ *
+ * @param ns The time of one run of the case over all its instances, in nanoseconds.
+ */
+static void Report(StringView benchmark, StringView model, u32 nrBones, u32 nrInstances, f64 ns)
+{
+	const f64 nsPerBone = ns / (static_cast<f64>(nrBones) * nrInstances);
+	const f64 instancesPerMs = ns > 0.0 ? nrInstances * 1e6 / ns : 0.0;
+	std::cout << std::format("result benchmark={} model={} bones={} instances={} ns_per_bone={:.3f} instances_per_ms={:.3f}\n",
+		benchmark, model, nrBones, nrInstances, nsPerBone, instancesPerMs);
+	if (g_results.is_open())
+		g_results << std::format("{},{},{},{},{:.3f},{:.3f}\n", benchmark, model, nrBones, nrInstances, nsPerBone, instancesPerMs);
+}
+
+// ----------------------------------------------------
+//										BENCHMARKS
+// ----------------------------------------------------
+
+/**
+ * @brief Compares the key lookup strategies on a clip played forward at 60 frames per second.
+ *
+ * Every frame each bone looks up its position key: the linear scan restarts from the first key,
+ * the cursor resumes from the key found by the previous frame. Bones start at evenly spaced
+ * points of the clip so that the average covers the whole clip, and the loop at the end makes
+ * the cursor pay for the binary search fallback too.
+ */
+static void BenchKeyframeSearch(u32 nrKeys, u32 nrBones, u32 nrFrames)
+{
+	constexpr f32 ticksPerFrame = 30.0f / 60.0f; // 30 ticks per second clip, 60 frames per second playback
+	const f32 duration = static_cast<f32>(nrKeys - 1);
+
+	auto keys = CreatePositionTrack(nrKeys);
+	auto cursors = std::make_unique<u32[]>(nrBones);
+	auto BoneTime = [&](u32 frame, u32 bone) {
+		f32 phase = duration * static_cast<f32>(bone) / static_cast<f32>(nrBones);
+		return std::fmod(phase + ticksPerFrame * static_cast<f32>(frame), duration);
+	};
+
+	u64 checksumLinear = 0;
+	f64 nsLinear = Measure(nrFrames, [&, frame = 0u]() mutable {
+		for (u32 bone = 0; bone < nrBones; bone++)
+			checksumLinear += KeyframeSearch::FindLinear(keys.get(), nrKeys, BoneTime(frame, bone));
+		frame++;
+	});
+
+	u64 checksumBinary = 0;
+	f64 nsBinary = Measure(nrFrames, [&, frame = 0u]() mutable {
+		for (u32 bone = 0; bone < nrBones; bone++)
+			checksumBinary += KeyframeSearch::FindBinary(keys.get(), nrKeys, BoneTime(frame, bone));
+		frame++;
+	});
+
+	u64 checksumCursor = 0;
+	f64 nsCursor = Measure(nrFrames, [&, frame = 0u]() mutable {
+		for (u32 bone = 0; bone < nrBones; bone++)
+			checksumCursor += KeyframeSearch::FindWithCursor(keys.get(), nrKeys, BoneTime(frame, bone), cursors[bone]);
+		frame++;
+	});
+
+	if (checksumLinear != checksumBinary || checksumLinear != checksumCursor)
+		std::cout << std::format("keyframe_search keys={}: MISMATCH between strategies\n", nrKeys);
+
+	const f64 lookups = static_cast<f64>(nrFrames) * nrBones;
+	std::cout << std::format("keyframe_search keys={:<6} bones={} linear={:>10.2f} ns/lookup binary={:>7.2f} ns/lookup cursor={:>7.2f} ns/lookup\n",
+		nrKeys, nrBones, nsLinear / lookups, nsBinary / lookups, nsCursor / lookups);
+}
+
+/**
+ * @brief Compares `Animator::UpdateAnimation` sampling the keys of a clip against sampling its cooked layout.
+ * Also reports the largest difference between the two bone palettes, caused by the resampling.
+ */
+static void BenchCookedSampling(u32 nrBones, u32 nrKeys, f32 framesPerSecond, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+
+	Animation keyed;
+	CreateAnimation(keyed, nrBones, nrKeys);
+	Animation cooked;
+	CreateAnimation(cooked, nrBones, nrKeys);
+	cooked.Cook(framesPerSecond);
+
+	Animator keyedAnimator;
+	keyedAnimator.SetTargetSkeleton(skeleton);
+	keyedAnimator.SetTargetAnimation(&keyed);
+	keyedAnimator.PlayAnimation();
+
+	Animator cookedAnimator;
+	cookedAnimator.SetTargetSkeleton(skeleton);
+	cookedAnimator.SetTargetAnimation(&cooked);
+	cookedAnimator.PlayAnimation();
+
+	constexpr f32 dt = 1.0f / 60.0f;
+	f64 nsKeyed = Measure(nrFrames, [&]() { keyedAnimator.UpdateAnimation(dt); });
+	f64 nsCooked = Measure(nrFrames, [&]() { cookedAnimator.UpdateAnimation(dt); });
+
+	f32 maxError = 0.0f;
+	for (u32 i = 0; i < nrBones; i++)
+		for (i32 c = 0; c < 4; c++)
+			for (i32 r = 0; r < 4; r++)
+				maxError = std::max(maxError, std::abs(keyedAnimator.boneTransforms[i][c][r] - cookedAnimator.boneTransforms[i][c][r]));
+
+	const f64 samples = static_cast<f64>(nrFrames) * nrBones;
+	std::cout << std::format("cooked_sampling bones={} keys={} fps={} keyed={:>7.2f} ns/bone cooked={:>7.2f} ns/bone max_error={:.6f} cooked_bytes={}\n",
+		nrBones, nrKeys, framesPerSecond, nsKeyed / samples, nsCooked / samples, maxError, cooked.cooked.GetMemorySize());
+}
+
+/**
+ * @brief Compresses a clip, then compares `Animator::UpdateAnimation` on the compressed keys against the
+ * full precision keys. Reports the compression ratio, the error measured by the compressor and the
+ * largest difference between the two bone palettes.
+ *
+ * @param unitScale Keys every scale at 1, as most clips do: the scale tracks are dropped by the compression.
+ */
+static void BenchCompressedSampling(u32 nrBones, u32 nrKeys, f32 maxPositionError, bool unitScale, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+
+	Animation keyed;
+	CreateAnimation(keyed, nrBones, nrKeys);
+	Animation compressed;
+	CreateAnimation(compressed, nrBones, nrKeys);
+	if (unitScale)
+	{
+		for (Animation* animation : { &keyed, &compressed })
+			for (u32 bone = 0; bone < nrBones; bone++)
+				for (u32 i = 0; i < nrKeys; i++)
+					animation->bonesAnimKeys[bone].scaleKeys[i].scale = vec3f(1.0f);
+	}
+
+	ClipCompressionSettings settings{};
+	settings.maxPositionError = maxPositionError;
+	ClipCompressionReport report{};
+	f64 nsCompress = Measure(1, [&]() { report = compressed.Compress(settings); });
+
+	Animator keyedAnimator;
+	keyedAnimator.SetTargetSkeleton(skeleton);
+	keyedAnimator.SetTargetAnimation(&keyed);
+	keyedAnimator.PlayAnimation();
+
+	Animator compressedAnimator;
+	compressedAnimator.SetTargetSkeleton(skeleton);
+	compressedAnimator.SetTargetAnimation(&compressed);
+	compressedAnimator.PlayAnimation();
+
+	constexpr f32 dt = 1.0f / 60.0f;
+	f64 nsKeyed = Measure(nrFrames, [&]() { keyedAnimator.UpdateAnimation(dt); });
+	f64 nsCompressed = Measure(nrFrames, [&]() { compressedAnimator.UpdateAnimation(dt); });
+
+	f32 maxError = 0.0f;
+	for (u32 i = 0; i < nrBones; i++)
+		maxError = std::max(maxError, glm::length(vec3f(keyedAnimator.boneTransforms[i][3] - compressedAnimator.boneTransforms[i][3])));
+
+	const f64 samples = static_cast<f64>(nrFrames) * nrBones;
+	std::cout << std::format("compressed_sampling bones={} keys={} scale={} tolerance={} raw_bytes={} compressed_bytes={} ratio={:.2f} keys_kept={}/{} constant_tracks={}/{} dropped_tracks={} over_budget={} max_error={:.6f} palette_error={:.6f} compress={:.2f} ms keyed={:>7.2f} ns/bone compressed={:>7.2f} ns/bone\n",
+		nrBones, nrKeys, unitScale ? "unit" : "animated", maxPositionError, report.rawSize, report.compressedSize, report.GetRatio(), report.nrKeys, report.nrResampledKeys,
+		report.nrConstantTracks, report.nrTracks, report.nrDroppedTracks, report.nrTracksOverBudget, report.maxError, maxError, nsCompress / 1e6, nsKeyed / samples, nsCompressed / samples);
+}
+
+/**
+ * @brief Plays one clip on two skeletons of the same rig whose bones are stored in opposite orders:
+ * the first one samples the clip directly, the second one through its remap table. Compares the cost of
+ * the remapping, with the keys and with the cooked layout, and checks that both skeletons get the same pose.
+ */
+static void BenchChannelRemap(u32 nrBones, u32 nrKeys, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+	SkeletalMesh reversed;
+	CreateSkeleton(reversed, nrBones);
+	for (u32 i = 0; i < nrBones; i++)
+	{
+		reversed.boneNames[i].fill(0);
+		std::format_to_n(reversed.boneNames[i].data(), 31, "bone_{}", nrBones - 1 - i);
+	}
+	reversed.HashBoneNames();
+
+	// Channels in the order of the first skeleton, as exported from it
+	Animation keyed;
+	CreateAnimation(keyed, nrBones, nrKeys);
+	Animation cooked;
+	CreateAnimation(cooked, nrBones, nrKeys);
+	cooked.Cook(30.0f);
+	for (Animation* animation : { &keyed, &cooked })
+	{
+		animation->channelHashes = std::make_unique<u64[]>(nrBones);
+		std::copy(skeleton.boneHashes.get(), skeleton.boneHashes.get() + nrBones, animation->channelHashes.get());
+	}
+
+	ChannelRemap remap = ChannelRemap::Create(skeleton.boneHashes.get(), nrBones, keyed.channelHashes.get(), nrBones);
+	ChannelRemap reversedRemap = ChannelRemap::Create(reversed.boneHashes.get(), nrBones, keyed.channelHashes.get(), nrBones);
+	for (Animation* animation : { &keyed, &cooked })
+	{
+		animation->BindSkeleton(skeleton.rigHash, &remap);
+		animation->BindSkeleton(reversed.rigHash, &reversedRemap);
+	}
+
+	for (Animation* animation : { &keyed, &cooked })
+	{
+		Animator direct;
+		direct.SetTargetSkeleton(skeleton);
+		direct.SetTargetAnimation(animation);
+		direct.PlayAnimation();
+
+		Animator remapped;
+		remapped.SetTargetSkeleton(reversed);
+		remapped.SetTargetAnimation(animation);
+		remapped.PlayAnimation();
+
+		constexpr f32 dt = 1.0f / 60.0f;
+		f64 nsDirect = Measure(nrFrames, [&]() { direct.UpdateAnimation(dt); });
+		f64 nsRemapped = Measure(nrFrames, [&]() { remapped.UpdateAnimation(dt); });
+
+		f32 maxError = 0.0f;
+		for (u32 i = 0; i < nrBones; i++)
+		{
+			const mat4f& a = direct.GetPose().localTransforms[i];
+			const mat4f& b = remapped.GetPose().localTransforms[nrBones - 1 - i];
+			for (i32 c = 0; c < 4; c++)
+				maxError = std::max(maxError, glm::length(a[c] - b[c]));
+		}
+
+		const f64 samples = static_cast<f64>(nrFrames) * nrBones;
+		std::cout << std::format("channel_remap bones={} keys={} layout={} direct={:>7.2f} ns/bone remapped={:>7.2f} ns/bone max_error={:.6f} {}\n",
+			nrBones, nrKeys, animation->IsCooked() ? "cooked" : "keyed", nsDirect / samples, nsRemapped / samples, maxError,
+			maxError == 0.0f ? "PASS" : "FAIL");
+	}
+}
+
+/**
+ * @brief Bakes a clip, then compares the palettes of a crowd updated by animators against the palettes
+ * interpolated from the baked frames, as the GPU does for each instance (see "SkeletalAnimBaked.vert").
+ * Reports the bake time and memory, and the largest palette error halfway between two baked frames.
+ */
+static void BenchBakedClip(u32 nrInstances, u32 nrBones, f32 framesPerSecond, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+	Animation animation;
+	CreateAnimation(animation, nrBones, 300);
+
+	BakedClip baked;
+	f64 nsBake = Measure(1, [&]() { baked.Create(skeleton, animation, framesPerSecond); });
+
+	Vector<Animator> animators(nrInstances);
+	for (u32 i = 0; i < nrInstances; i++)
+	{
+		animators[i].SetTargetSkeleton(skeleton);
+		animators[i].SetTargetAnimation(&animation);
+		animators[i].currentTime = animation.duration * static_cast<f32>(i) / static_cast<f32>(nrInstances);
+		animators[i].PlayAnimation();
+	}
+	auto palette = std::make_unique<mat4f[]>(nrBones);
+
+	constexpr f32 dt = 1.0f / 60.0f;
+	f64 nsAnimator = Measure(nrFrames, [&]() {
+		for (Animator& animator : animators)
+			animator.UpdateAnimation(dt);
+	});
+	f64 nsBaked = Measure(nrFrames, [&, time = 0.0f]() mutable {
+		time += dt;
+		for (u32 i = 0; i < nrInstances; i++)
+			baked.SamplePalette(time + baked.GetDuration() * static_cast<f32>(i) / static_cast<f32>(nrInstances), palette.get());
+	});
+
+	// The baked frames match the animator exactly, the error grows between them
+	f32 maxError = 0.0f;
+	Animator reference;
+	reference.SetTargetSkeleton(skeleton);
+	reference.SetTargetAnimation(&animation);
+	for (u32 frame = 0; frame + 1 < baked.GetNumFrames(); frame++)
+	{
+		const f32 phase = (static_cast<f32>(frame) + 0.5f) / static_cast<f32>(baked.GetNumFrames());
+		reference.EvaluatePose(phase * animation.duration);
+		baked.SamplePalette(phase * baked.GetDuration(), palette.get());
+		for (u32 i = 0; i < nrBones; i++)
+			for (i32 c = 0; c < 4; c++)
+				maxError = std::max(maxError, glm::length(reference.GetPalette()[i][c] - palette[i][c]));
+	}
+
+	const f64 samples = static_cast<f64>(nrFrames) * nrInstances;
+	std::cout << std::format("baked_clip instances={} bones={} fps={} animator={:>8.2f} ns/instance baked={:>8.2f} ns/instance bake={:.2f} ms baked_bytes={} max_error={:.6f}\n",
+		nrInstances, nrBones, framesPerSecond, nsAnimator / samples, nsBaked / samples, nsBake / 1e6, baked.GetMemorySize(), maxError);
+}
+
+/**
+ * @brief Skins a mesh on the CPU with the scalar reference and with the SIMD kernel.
+ * Each vertex has four influences spread over the skeleton. Reports the throughput of both
+ * and the largest difference between their positions and normals.
+ */
+static void BenchSkinning(u32 nrVertices, u32 nrBones, u32 iterations)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+	Animation animation;
+	CreateAnimation(animation, nrBones, 300);
+	Animator animator;
+	animator.SetTargetSkeleton(skeleton);
+	animator.SetTargetAnimation(&animation);
+	animator.EvaluatePose(animation.duration * 0.37f);
+
+	Vector<Vertex_P_N_UV_T_B> vertices = CreateSkinnedVertices(nrVertices, nrBones);
+
+	Vector<vec3f> scalarPositions(nrVertices), scalarNormals(nrVertices);
+	Vector<vec3f> simdPositions(nrVertices), simdNormals(nrVertices);
+	f64 nsScalar = Measure(iterations, [&]() {
+		Skinning::SkinVerticesScalar(vertices.data(), nrVertices, animator.GetPalette(), scalarPositions.data(), scalarNormals.data());
+	});
+	f64 nsSimd = Measure(iterations, [&]() {
+		Skinning::SkinVertices(vertices.data(), nrVertices, animator.GetPalette(), simdPositions.data(), simdNormals.data());
+	});
+
+	f32 maxError = 0.0f;
+	for (u32 i = 0; i < nrVertices; i++)
+	{
+		maxError = std::max(maxError, glm::length(scalarPositions[i] - simdPositions[i]));
+		maxError = std::max(maxError, glm::length(scalarNormals[i] - simdNormals[i]));
+	}
+
+	const f64 skinned = static_cast<f64>(iterations) * nrVertices;
+	std::cout << std::format("cpu_skinning vertices={} bones={} scalar={:>8.2f} Mvertices/s simd={:>8.2f} Mvertices/s speedup={:.2f} max_error={:.6f} {}\n",
+		nrVertices, nrBones, skinned / nsScalar * 1e3, skinned / nsSimd * 1e3, nsScalar / nsSimd, maxError, maxError < 1e-4f ? "PASS" : "FAIL");
+}
+
+/**
+ * @brief Computes the bounds of an animated mesh from its per-bone bounds, and checks them against the
+ * bounds of the mesh skinned on the CPU at every frame. Reports the cost of both and how much larger
+ * the per-bone bounds are, in volume.
+ */
+static void BenchBoneBounds(u32 nrVertices, u32 nrBones, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+	Vector<Vertex_P_N_UV_T_B> vertices = CreateSkinnedVertices(nrVertices, nrBones);
+	skeleton.ExpandBoneBounds(vertices.data(), nrVertices);
+
+	Animation animation;
+	CreateAnimation(animation, nrBones, 300);
+	Animator animator;
+	animator.SetTargetSkeleton(skeleton);
+	animator.SetTargetAnimation(&animation);
+	animator.PlayAnimation();
+
+	Vector<vec3f> positions(nrVertices);
+	u32 nrMisses = 0;
+	f64 nsBounds = 0.0;
+	f64 nsSkinned = 0.0;
+	f64 volumeRatio = 0.0;
+	constexpr f32 dt = 1.0f / 60.0f;
+	for (u32 frame = 0; frame < nrFrames; frame++)
+	{
+		animator.UpdateAnimation(dt);
+
+		AABB bounds;
+		nsBounds += Measure(1, [&]() { bounds = animator.GetBounds(); });
+
+		AABB skinned;
+		nsSkinned += Measure(1, [&]() {
+			Skinning::SkinVertices(vertices.data(), nrVertices, animator.GetPalette(), positions.data(), nullptr);
+			for (const vec3f& position : positions)
+				skinned.Expand(position);
+		});
+
+		// Conservative: the skinned bounds must be inside, up to the rounding
+		constexpr f32 epsilon = 1e-4f;
+		if (glm::any(glm::lessThan(skinned.min, bounds.min - epsilon)) || glm::any(glm::greaterThan(skinned.max, bounds.max + epsilon)))
+			nrMisses++;
+
+		const vec3f size = bounds.max - bounds.min;
+		const vec3f skinnedSize = glm::max(skinned.max - skinned.min, vec3f(1e-6f));
+		volumeRatio += (size.x * size.y * size.z) / (skinnedSize.x * skinnedSize.y * skinnedSize.z);
+	}
+
+	std::cout << std::format("bone_bounds vertices={} bones={} bounds={:>8.2f} ns/bone skinned={:>10.2f} ns/frame volume_ratio={:.2f} misses={} {}\n",
+		nrVertices, nrBones, nsBounds / nrFrames / nrBones, nsSkinned / nrFrames, volumeRatio / nrFrames, nrMisses, nrMisses == 0 ? "PASS" : "FAIL");
+}
+
+/**
+ * @brief Compares the update of every node with the updates of a subtree and of the skeleton without its
+ * leaf levels. A mask over the whole skeleton must give the palette of the full update, the bones out of
+ * the subtree mask must keep their palette.
+ */
+static void BenchBoneMask(u32 nrBones, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+	Animation animation;
+	CreateAnimation(animation, nrBones, 300);
+
+	BoneMask wholeMask;
+	wholeMask.Create(skeleton);
+	wholeMask.SetSubtree(skeleton, "bone_0", true);
+
+	// Half of the binary tree
+	BoneMask subtreeMask;
+	subtreeMask.Create(skeleton);
+	subtreeMask.SetSubtree(skeleton, "bone_1", true);
+
+	BoneMask leafMask;
+	leafMask.Create(skeleton);
+	leafMask.SetSubtree(skeleton, "bone_0", true);
+	leafMask.RemoveLeafLevels(skeleton, 2);
+
+	struct Case
+	{
+		const char* name;
+		const BoneMask* mask;
+	};
+	const Case cases[] = { { "none", nullptr }, { "whole", &wholeMask }, { "subtree", &subtreeMask }, { "leaf_levels", &leafMask } };
+
+	constexpr f32 dt = 1.0f / 60.0f;
+	f64 nsFull = 0.0;
+	for (const Case& c : cases)
+	{
+		Animator reference;
+		Animator animator;
+		for (Animator* a : { &reference, &animator })
+		{
+			a->SetTargetSkeleton(skeleton);
+			a->SetTargetAnimation(&animation);
+			a->PlayAnimation();
+			a->UpdateAnimation(dt);
+		}
+		// The mask applies once every node has been evaluated
+		animator.SetBoneMask(c.mask);
+
+		u32 nrMismatches = 0;
+		f64 ns = 0.0;
+		u64 sampledBones = 0;
+		Vector<mat4f> previous(nrBones);
+		for (u32 frame = 0; frame < nrFrames; frame++)
+		{
+			std::copy_n(animator.GetPalette(), nrBones, previous.begin());
+			ns += Measure(1, [&]() { animator.UpdateAnimation(dt); });
+			sampledBones += animator.GetNumSampledBones();
+			reference.UpdateAnimation(dt);
+
+			const mat4f* palette = animator.GetPalette();
+			for (u32 i = 0; i < nrBones; i++)
+			{
+				const u32 node = i + 1;
+				const bool updated = !c.mask || std::find(c.mask->GetUpdatedNodes().begin(), c.mask->GetUpdatedNodes().end(), node) != c.mask->GetUpdatedNodes().end();
+				if (c.mask == &subtreeMask && !updated && palette[i] != previous[i])
+					nrMismatches++;
+				if ((!c.mask || c.mask == &wholeMask) && palette[i] != reference.GetPalette()[i])
+					nrMismatches++;
+			}
+		}
+		if (!c.mask)
+			nsFull = ns;
+
+		std::cout << std::format("bone_mask bones={} mask={:<11} updated_nodes={:>3} sampled_bones={:>3} frame={:>8.2f} ns/bone speedup={:.2f} mismatches={} {}\n",
+			nrBones, c.name, c.mask ? c.mask->GetUpdatedNodes().size() : skeleton.nrNodes, sampledBones / nrFrames,
+			ns / nrFrames / nrBones, nsFull / ns, nrMismatches, nrMismatches == 0 ? "PASS" : "FAIL");
+	}
+}
+
+/**
+ * @brief Compares the memory of the sparse quantized targets with dense targets storing every vertex, checks the
+ * quantization error against the deltas given to the targets, and measures `MorphTargetSet::Apply` with no active
+ * target, a few active targets and every target active.
+ */
+static void BenchMorphTargets(u32 nrVertices, u32 nrMoved, u32 nrTargets, u32 iterations)
+{
+	MorphTargetSet targets;
+	CreateMorphTargets(targets, nrVertices, nrMoved, nrTargets);
+
+	// Dense: a position and a normal of 32-bit floats for every vertex of every target
+	const u64 denseSize = static_cast<u64>(nrTargets) * nrVertices * 2 * sizeof(vec3f);
+
+	Vector<f32> weights(nrTargets, 1.0f);
+	Vector<vec3f> positions(targets.GetNumSlots()), normals(targets.GetNumSlots());
+	targets.Apply(weights.data(), positions.data(), normals.data());
+
+	Vector<vec3f> expectedPositions(nrMoved, vec3f(0.0f)), expectedNormals(nrMoved, vec3f(0.0f));
+	for (u32 t = 0; t < nrTargets; t++)
+	{
+		auto [first, count] = GetMorphTargetRange(t, nrMoved, nrTargets);
+		for (u32 i = first; i < first + count; i++)
+		{
+			expectedPositions[i] += GetMorphPositionDelta(i, t);
+			expectedNormals[i] += GetMorphNormalDelta(i, t);
+		}
+	}
+	f32 maxError = 0.0f;
+	for (u32 i = 0; i < nrMoved; i++)
+	{
+		maxError = std::max(maxError, glm::length(positions[i] - expectedPositions[i]));
+		maxError = std::max(maxError, glm::length(normals[i] - expectedNormals[i]) * 0.1f);
+	}
+
+	struct Case
+	{
+		StringView name;
+		u32 nrActive;
+	};
+	const Case cases[] = { { "none", 0 }, { "few", std::min(4u, nrTargets) }, { "all", nrTargets } };
+	f64 ns[3]{};
+	for (u32 c = 0; c < 3; c++)
+	{
+		std::fill(weights.begin(), weights.end(), 0.0f);
+		for (u32 t = 0; t < cases[c].nrActive; t++)
+			weights[t * nrTargets / std::max(cases[c].nrActive, 1u)] = 0.5f;
+		ns[c] = Measure(iterations, [&]() { targets.Apply(weights.data(), positions.data(), normals.data()); }) / iterations;
+	}
+
+	// The position deltas are below 0.03: an error of 1e-4 is far below what a quantization bug gives
+	std::cout << std::format("morph_targets vertices={} moved={} targets={} deltas={} sparse={} KB dense={} KB ratio={:.1f} max_error={:.2e} "
+		"apply_none={:.0f} ns apply_few={:.0f} ns apply_all={:.0f} ns {}\n",
+		nrVertices, nrMoved, nrTargets, targets.GetNumDeltas(), targets.GetMemorySize() / 1024, denseSize / 1024,
+		static_cast<f64>(denseSize) / targets.GetMemorySize(), maxError, ns[0], ns[1], ns[2], maxError < 1e-4f ? "PASS" : "FAIL");
+}
+
+/**
+ * @brief Runs the animation update stage on a crowd of instances sharing one skeleton and one clip,
+ * with an increasing number of threads.
+ */
+static void BenchAnimationSystem(u32 nrInstances, u32 nrBones, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+	Animation animation;
+	CreateAnimation(animation, nrBones, 300);
+
+	entt::registry registry;
+	for (u32 i = 0; i < nrInstances; i++)
+	{
+		Animator& animator = registry.emplace<Animator>(registry.create());
+		animator.SetTargetSkeleton(skeleton);
+		animator.SetTargetAnimation(&animation);
+		animator.currentTime = animation.duration * static_cast<f32>(i) / static_cast<f32>(nrInstances);
+		animator.PlayAnimation();
+	}
+
+	AnimationSystem system;
+	const u32 maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	f64 nsSingle = 0.0;
+	for (u32 nrThreads = 1; nrThreads <= maxThreads; nrThreads *= 2)
+	{
+		JobSystem jobSystem(nrThreads - 1);
+		constexpr f32 dt = 1.0f / 60.0f;
+		f64 ns = Measure(nrFrames, [&]() { system.Update(registry, dt, jobSystem); });
+		if (nrThreads == 1)
+			nsSingle = ns;
+
+		std::cout << std::format("animation_system instances={} bones={} threads={} frame={:>8.3f} ms speedup={:.2f}\n",
+			nrInstances, nrBones, nrThreads, ns / nrFrames / 1e6, nsSingle / ns);
+	}
+}
+
+/**
+ * @brief Runs the animation update stage on a crowd spread from 2 to 200 units in front of the viewpoint,
+ * with and without the level of detail.
+ */
+static void BenchAnimationLod(u32 nrInstances, u32 nrBones, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+	Animation animation;
+	CreateAnimation(animation, nrBones, 300);
+
+	entt::registry registry;
+	for (u32 i = 0; i < nrInstances; i++)
+	{
+		entt::entity entity = registry.create();
+		Transform& transform = registry.emplace<Transform>(entity);
+		transform.position = vec3f(0.0f, 0.0f, -2.0f - 198.0f * static_cast<f32>(i) / static_cast<f32>(nrInstances));
+		transform.UpdateTransformation();
+
+		Animator& animator = registry.emplace<Animator>(entity);
+		animator.SetTargetSkeleton(skeleton);
+		animator.SetTargetAnimation(&animation);
+		animator.PlayAnimation();
+	}
+
+	JobSystem jobSystem(0);
+	constexpr f32 dt = 1.0f / 60.0f;
+	for (bool enabled : { false, true })
+	{
+		AnimationSystem system;
+		AnimationLodSettings settings{};
+		settings.enabled = enabled;
+		system.SetLodSettings(settings);
+		system.SetViewpoint(vec3f(0.0f), 45.0f);
+
+		u64 sampledBones = 0;
+		f64 ns = Measure(nrFrames, [&]() {
+			system.Update(registry, dt, jobSystem);
+			sampledBones += system.GetStats().nrSampledBones;
+		});
+
+		const AnimationSystem::Stats& stats = system.GetStats();
+		std::cout << std::format("animation_lod instances={} bones={} lod={} frame={:>8.3f} ms sampled_bones={}/frame full={} half={} quarter={} skipped_leaf_bones={} skipped_frame_bones={}\n",
+			nrInstances, nrBones, enabled ? "on" : "off", ns / nrFrames / 1e6, sampledBones / nrFrames,
+			stats.nrAnimators[AnimationSystem::LOD_FULL_RATE], stats.nrAnimators[AnimationSystem::LOD_HALF_RATE], stats.nrAnimators[AnimationSystem::LOD_QUARTER_RATE],
+			stats.nrSkippedLeafBones, stats.nrSkippedFrameBones);
+	}
+}
+
+/**
+ * @brief Runs the animation update stage on a crowd playing one clip from a few distinct start times,
+ * with and without the pose cache. Reports the hit rate and the largest palette difference caused by
+ * the time quantization.
+ */
+static void BenchAnimationCache(u32 nrInstances, u32 nrGroups, u32 nrBones, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+	Animation animation;
+	CreateAnimation(animation, nrBones, 300);
+
+	entt::registry registry;
+	for (u32 i = 0; i < nrInstances; i++)
+	{
+		Animator& animator = registry.emplace<Animator>(registry.create());
+		animator.SetTargetSkeleton(skeleton);
+		animator.SetTargetAnimation(&animation);
+		// Instances of a group start a few ticks apart, within one quantization step
+		animator.currentTime = animation.duration * static_cast<f32>(i % nrGroups) / static_cast<f32>(nrGroups) + 0.01f * static_cast<f32>(i / nrGroups % 8);
+		animator.PlayAnimation();
+	}
+
+	JobSystem jobSystem(0);
+	constexpr f32 dt = 1.0f / 60.0f;
+	for (bool enabled : { false, true })
+	{
+		AnimationSystem system;
+		AnimationCacheSettings settings{};
+		settings.enabled = enabled;
+		system.SetCacheSettings(settings);
+
+		f64 ns = Measure(nrFrames, [&]() { system.Update(registry, dt, jobSystem); });
+
+		// Palette difference against an exact evaluation at the time of each animator
+		f32 maxError = 0.0f;
+		Animator reference;
+		reference.SetTargetSkeleton(skeleton);
+		reference.SetTargetAnimation(&animation);
+		for (auto [entity, animator] : registry.view<Animator>().each())
+		{
+			reference.EvaluatePose(animator.currentTime);
+			const mat4f* palette = animator.GetPalette();
+			for (u32 bone = 0; bone < nrBones; bone++)
+				maxError = std::max(maxError, glm::length(vec3f(reference.boneTransforms[bone][3] - palette[bone][3])));
+		}
+
+		const AnimationSystem::Stats& stats = system.GetStats();
+		std::cout << std::format("animation_cache instances={} groups={} bones={} cache={} frame={:>8.3f} ms hit_rate={:.3f} sampled_bones={} max_error={:.6f}\n",
+			nrInstances, nrGroups, nrBones, enabled ? "on" : "off", ns / nrFrames / 1e6, stats.GetCacheHitRate(), stats.nrSampledBones, maxError);
+	}
+}
+
+/** @brief A skeleton of the suite with its clips, loaded from the assets or built. */
+struct SuiteModel
+{
+	String name;
+	SkeletalMesh skeleton;
+	Vector<Animation> clips;
+};
+
+/**
+ * @brief Loads the skeleton and the clips of every model of the skeletal model directory, as the cases of the suite.
+ * The clips are read from their cooked files once written by a first load. Requires the assets: run from a directory
+ * of the project root, e.g. "build".
+ */
+static void BenchSkeletonLoad(Vector<UniquePtr<SuiteModel>>& models, u32 iterations)
+{
+	AnimationsManager& manager = AnimationsManager::Get();
+	for (const fs::path& modelFile : FindSkeletalModels())
+	{
+		auto model = std::make_unique<SuiteModel>();
+		model->name = modelFile.parent_path().string();
+		if (!LoadSkeletonBones(model->skeleton, modelFile))
+			continue;
+
+		f64 ns = Measure(iterations, [&]() {
+			SkeletalMesh skeleton;
+			LoadSkeletonBones(skeleton, modelFile);
+		});
+		Report("skeleton_load", model->name, model->skeleton.nrBones, 1, ns / iterations);
+
+		for (const fs::path& clip : ReadClipList(modelFile.parent_path()))
+		{
+			Animation animation;
+			manager.ImportAnimation(animation, clip);
+			if (animation.nrKeys == 0)
+				continue;
+
+			ns = Measure(iterations, [&]() {
+				Animation reloaded;
+				manager.ImportAnimation(reloaded, clip);
+			});
+			Report("clip_load", clip.generic_string(), animation.nrKeys, 1, ns / iterations);
+			model->clips.push_back(std::move(animation));
+		}
+		models.push_back(std::move(model));
+	}
+
+	if (models.empty())
+		std::cout << std::format("skeleton_load skipped: assets not found under {}\n", Filesystem::GetSkeletalModelsPath().string());
+}
+
+/**
+ * @brief Evaluates the first clip of a model at 60 frames per second, measuring the two stages separately:
+ * the sampling of the keys into the local transformations, then the propagation through the hierarchy.
+ */
+static void BenchPoseStages(const SuiteModel& model, u32 nrFrames)
+{
+	Animator animator;
+	animator.SetTargetSkeleton(model.skeleton);
+	animator.SetTargetAnimation(&model.clips.front());
+
+	const Animation& clip = model.clips.front();
+	const f32 step = clip.ticksPerSecond / 60.0f;
+	f32 time = 0.0f;
+	f64 nsSampling = 0.0;
+	f64 nsHierarchy = 0.0;
+	for (u32 frame = 0; frame < nrFrames; frame++)
+	{
+		time = std::fmod(time + step, clip.duration);
+		nsSampling += Measure(1, [&]() { animator.SamplePose(time); });
+		nsHierarchy += Measure(1, [&]() { animator.UpdatePalette(); });
+	}
+	Report("keyframe_sampling", model.name, model.skeleton.nrBones, 1, nsSampling / nrFrames);
+	Report("hierarchy", model.name, model.skeleton.nrBones, 1, nsHierarchy / nrFrames);
+}
+
+/** @brief Runs `Animator::UpdateAnimation` on a crowd of instances playing the first clip of a model, on one thread. */
+static void BenchAnimatorUpdate(const SuiteModel& model, u32 nrInstances)
+{
+	const Animation& clip = model.clips.front();
+	Vector<Animator> animators(nrInstances);
+	for (u32 i = 0; i < nrInstances; i++)
+	{
+		Animator& animator = animators[i];
+		animator.SetTargetSkeleton(model.skeleton);
+		animator.SetTargetAnimation(&clip);
+		animator.currentTime = clip.duration * static_cast<f32>(i) / static_cast<f32>(nrInstances);
+		animator.PlayAnimation();
+	}
+
+	// About the same number of updates for every crowd size
+	const u32 nrFrames = std::max(100000u / nrInstances, 16u);
+	constexpr f32 dt = 1.0f / 60.0f;
+	f64 ns = Measure(nrFrames, [&]() {
+		for (Animator& animator : animators)
+			animator.UpdateAnimation(dt);
+	});
+	Report("animator_update", model.name, model.skeleton.nrBones, nrInstances, ns / nrFrames);
+}
+
+/**
+ * @brief Loads the clips of a skeletal model from their source files with Assimp (cold), then from the
+ * cooked files written by the first load (warm). Requires the assets: run from a directory of the project root, e.g. "build".
+ *
+ * @param model The directory of the model inside the skeletal model directory. E.g. "Mutant".
+ */
+static void BenchAnimationLoad(const fs::path& model, const fs::path& modelFile, u32 iterations)
+{
+	fs::path animlistFile = Filesystem::GetSkeletalModelsPath() / model / "animlist.txt";
+	SkeletalMesh skeleton;
+	if (!fs::exists(animlistFile) || !LoadSkeletonBones(skeleton, model / modelFile))
+	{
+		std::cout << std::format("animation_load model={} skipped: assets not found under {}\n", model.string(), Filesystem::GetSkeletalModelsPath().string());
+		return;
+	}
+
+	IStream file(animlistFile);
+	Vector<fs::path> clips(std::istream_iterator<fs::path>(file), std::istream_iterator<fs::path>{});
+
+	AnimationsManager& manager = AnimationsManager::Get();
+	f64 totalCold = 0.0;
+	f64 totalWarm = 0.0;
+	for (const fs::path& clip : clips)
+	{
+		const fs::path relative = model / clip;
+		const fs::path cooked = AnimationFile::GetCookedPath(Filesystem::GetSkeletalModelsPath() / relative);
+
+		bool cookedCold = false;
+		f64 cold = Measure(iterations, [&]() {
+			fs::remove(cooked);
+			Animation animation;
+			cookedCold |= manager.ImportAnimation(animation, relative);
+		});
+
+		bool cookedWarm = true;
+		f64 warm = Measure(iterations, [&]() {
+			Animation animation;
+			cookedWarm &= manager.ImportAnimation(animation, relative);
+		});
+
+		totalCold += cold;
+		totalWarm += warm;
+		std::cout << std::format("animation_load model={} clip={} cold={:>8.3f} ms warm={:>8.3f} ms speedup={:.1f} cooked_file={}\n",
+			model.string(), clip.string(), cold / iterations / 1e6, warm / iterations / 1e6, cold / warm,
+			!cookedCold && cookedWarm ? "ok" : "error");
+	}
+	std::cout << std::format("animation_load model={} clips={} cold={:>8.3f} ms warm={:>8.3f} ms speedup={:.1f}\n",
+		model.string(), clips.size(), totalCold / iterations / 1e6, totalWarm / iterations / 1e6, totalCold / totalWarm);
+}
+
+/**
+ * @brief Loads `nrClips` clips of a skeletal model (the clips of its list, repeated) with an increasing
+ * number of threads, from the source files (cold) and from the cooked files (warm).
+ */
+static void BenchAnimationImport(const fs::path& model, const fs::path& modelFile, u32 nrClips)
+{
+	fs::path animlistFile = Filesystem::GetSkeletalModelsPath() / model / "animlist.txt";
+	SkeletalMesh skeleton;
+	if (!fs::exists(animlistFile) || !LoadSkeletonBones(skeleton, model / modelFile))
+	{
+		std::cout << std::format("animation_import model={} skipped: assets not found under {}\n", model.string(), Filesystem::GetSkeletalModelsPath().string());
+		return;
+	}
+
+	IStream file(animlistFile);
+	Vector<fs::path> clips(std::istream_iterator<fs::path>(file), std::istream_iterator<fs::path>{});
+	Vector<fs::path> relativeAnims;
+	for (u32 i = 0; i < nrClips && !clips.empty(); i++)
+		relativeAnims.push_back(model / clips[i % clips.size()]);
+
+	// Every load registers a new skeleton in the manager, the library is emptied so that the clips are imported again
+	AnimationsManager& manager = AnimationsManager::Get();
+	u32 skeletonId = 1000;
+
+	const u32 maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	f64 coldSingle = 0.0;
+	for (u32 nrThreads = 1; nrThreads <= maxThreads; nrThreads *= 2)
+	{
+		JobSystem jobSystem(nrThreads - 1);
+
+		manager.UnloadAnimations();
+		manager.SetAnimationCache(false);
+		skeleton.id = skeletonId++;
+		f64 cold = Measure(1, [&]() { manager.LoadAnimations(skeleton, relativeAnims, jobSystem); });
+
+		manager.UnloadAnimations();
+		manager.SetAnimationCache(true);
+		skeleton.id = skeletonId++;
+		manager.LoadAnimations(skeleton, relativeAnims, jobSystem);
+		manager.UnloadAnimations();
+		skeleton.id = skeletonId++;
+		f64 warm = Measure(1, [&]() { manager.LoadAnimations(skeleton, relativeAnims, jobSystem); });
+
+		// A second character of the same rig: the clips are taken from the library
+		skeleton.id = skeletonId++;
+		f64 shared = Measure(1, [&]() { manager.LoadAnimations(skeleton, relativeAnims, jobSystem); });
+
+		if (nrThreads == 1)
+			coldSingle = cold;
+
+		std::cout << std::format("animation_import model={} clips={} threads={} cold={:>8.3f} ms warm={:>8.3f} ms shared={:>8.3f} ms speedup={:.2f} library_clips={}\n",
+			model.string(), relativeAnims.size(), nrThreads, cold / 1e6, warm / 1e6, shared / 1e6, coldSingle / cold, manager.GetNumAnimations());
+	}
+}
+
+/**
+ * @brief Runs the animation update stage on characters that are all blending: half of them blend two clips
+ * with a fixed weight, the other half crossfade to another clip every second. Checks that no heap allocation
+ * happens once the pose pools are warmed up.
+ *
+ * @return Whether the blended updates made no allocation.
+ */
+static bool CheckBlendAllocations(u32 nrInstances, u32 nrBones, u32 nrFrames)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, nrBones);
+
+	// One clip per representation: keys, cooked, compressed
+	Array<Animation, 3> animations;
+	for (Animation& animation : animations)
+		CreateAnimation(animation, nrBones, 300);
+	animations[1].Cook(30.0f);
+	animations[2].Compress(ClipCompressionSettings{});
+
+	entt::registry registry;
+	for (u32 i = 0; i < nrInstances; i++)
+	{
+		Animator& animator = registry.emplace<Animator>(registry.create());
+		animator.SetTargetSkeleton(skeleton);
+		animator.SetTargetAnimation(&animations[i % 3]);
+		animator.currentTime = animations[i % 3].duration * static_cast<f32>(i) / static_cast<f32>(nrInstances);
+		animator.PlayAnimation();
+		if (i % 2 == 1)
+			animator.SetBlendAnimation(&animations[(i + 1) % 3], 0.5f);
+	}
+
+	// A fixed number of workers, whatever the machine: the jobs must not allocate either
+	JobSystem jobSystem(3);
+	AnimationSystem system;
+	AnimationLodSettings settings{};
+	settings.enabled = false;
+	system.SetLodSettings(settings);
+
+	constexpr f32 dt = 1.0f / 60.0f;
+	u32 frame = 0;
+	auto updateFrame = [&]() {
+		// Every second, the other half of the characters start a crossfade to the next clip, longer than a second
+		if (frame % 60 == 0)
+		{
+			for (auto [entity, animator] : registry.view<Animator>().each())
+			{
+				u32 i = entt::to_entity(entity);
+				if (i % 2 == 0)
+					animator.CrossFade(&animations[(frame / 60 + i) % 3], 1.5f);
+			}
+		}
+		system.Update(registry, dt, jobSystem);
+		frame++;
+	};
+
+	// Warm up: the pose pools of the threads and the containers of the system reach their size
+	for (u32 i = 0; i < 120; i++)
+		updateFrame();
+
+	u64 nrAllocations = g_nrAllocations.load();
+	f64 ns = Measure(nrFrames, updateFrame);
+	nrAllocations = g_nrAllocations.load() - nrAllocations;
+
+	u32 nrBlending = 0;
+	for (auto [entity, animator] : registry.view<Animator>().each())
+		nrBlending += animator.IsBlending();
+
+	std::cout << std::format("animation_blend instances={} bones={} blending={} frame={:>8.3f} ms allocations={} {}\n",
+		nrInstances, nrBones, nrBlending, ns / nrFrames / 1e6, nrAllocations, nrAllocations == 0 ? "PASS" : "FAIL");
+	return nrAllocations == 0;
+}
+
+i32 main(i32 argc, char** argv)
+{
+	Logger::Initialize();
+
+	String filter;
+	for (i32 i = 1; i < argc; i++)
+	{
+		const StringView arg = argv[i];
+		if (arg.starts_with("--csv="))
+		{
+			g_results.open(String(arg.substr(6)));
+			g_results << "benchmark,model,bones,instances,ns_per_bone,instances_per_ms\n";
+		}
+		else if (arg.starts_with("--filter="))
+		{
+			filter = arg.substr(9);
+		}
+		else
+		{
+			std::cout << "Usage: AnimationBenchmark [--csv=<results file>] [--filter=<part of a benchmark name>]\n";
+			return 1;
+		}
+	}
+	auto enabled = [&](StringView name) { return filter.empty() || name.find(filter) != StringView::npos; };
+
+	// The suite: the models of the assets, and a built one so that it always runs
+	if (enabled("suite"))
+	{
+		Vector<UniquePtr<SuiteModel>> models;
+		BenchSkeletonLoad(models, 8);
+
+		auto synthetic = std::make_unique<SuiteModel>();
+		synthetic->name = "synthetic";
+		CreateSkeleton(synthetic->skeleton, 64);
+		CreateAnimation(synthetic->clips.emplace_back(), 64, 300);
+		models.push_back(std::move(synthetic));
+
+		for (const UniquePtr<SuiteModel>& model : models)
+		{
+			if (model->clips.empty())
+				continue;
+
+			BenchPoseStages(*model, 4096);
+			for (u32 nrInstances : { 1u, 100u, 10000u })
+				BenchAnimatorUpdate(*model, nrInstances);
+		}
+	}
+
+	if (enabled("keyframe_search"))
+		for (u32 nrKeys : { 30u, 300u, 3000u, 30000u })
+			BenchKeyframeSearch(nrKeys, 64, 2048);
+
+	if (enabled("cooked_sampling"))
+		for (u32 nrBones : { 32u, 64u, 100u })
+			BenchCookedSampling(nrBones, 300, 30.0f, 4096);
+
+	if (enabled("compressed_sampling"))
+		for (bool unitScale : { false, true })
+			for (f32 maxPositionError : { 0.0001f, 0.001f, 0.01f })
+				BenchCompressedSampling(64, 300, maxPositionError, unitScale, 4096);
+
+	if (enabled("channel_remap"))
+		BenchChannelRemap(64, 300, 4096);
+
+	if (enabled("baked_clip"))
+		for (f32 framesPerSecond : { 15.0f, 30.0f, 60.0f })
+			BenchBakedClip(500, 64, framesPerSecond, 64);
+
+	if (enabled("skinning"))
+		for (u32 nrVertices : { 1003u, 20000u, 200000u })
+			BenchSkinning(nrVertices, 64, 2000000 / nrVertices);
+
+	if (enabled("bone_bounds"))
+		BenchBoneBounds(20000, 64, 200);
+	if (enabled("bone_mask"))
+		BenchBoneMask(64, 4096);
+	if (enabled("morph_targets"))
+		for (u32 nrTargets : { 8u, 52u })
+			BenchMorphTargets(20000, 2000, nrTargets, 2000);
+
+	if (enabled("animation_system"))
+		BenchAnimationSystem(500, 64, 64);
+	if (enabled("animation_lod"))
+		BenchAnimationLod(500, 64, 64);
+	if (enabled("animation_cache"))
+		BenchAnimationCache(500, 16, 64, 64);
+
+	if (enabled("animation_load"))
+		BenchAnimationLoad("Mutant", "Mutant.gltf", 8);
+	if (enabled("animation_import"))
+		BenchAnimationImport("Mutant", "Mutant.gltf", 20);
+
+	if (enabled("blend_allocations") && !CheckBlendAllocations(100, 64, 240))
+		return 1;
+
+	return 0;
+}
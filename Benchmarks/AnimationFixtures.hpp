@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+#include "Core/Math/Ext.hpp"
+#include "Engine/ECS/Animation/Animation.hpp"
+#include "Engine/ECS/Skeleton/SkeletalMesh.hpp"
+#include "Engine/ECS/Skeleton/MorphTargets.hpp"
+
+// Synthetic skeletons, clips and morph targets shared by the benchmarks and the GPU validation
+
+/** @brief Builds a skeleton without meshes: the bones form a binary tree under a root node with no bone. */
+inline void CreateSkeleton(SkeletalMesh& skeleton, u32 nrBones)
+{
+	skeleton.bones = std::make_shared<Bone[]>(nrBones);
+	skeleton.boneNames = std::make_shared<Array<char, 32>[]>(nrBones);
+	skeleton.nrBones = nrBones;
+	for (u32 i = 0; i < nrBones; i++)
+	{
+		skeleton.bones[i].offset = mat4f(1.0f);
+		std::format_to_n(skeleton.boneNames[i].data(), 31, "bone_{}", i);
+	}
+	skeleton.HashBoneNames();
+
+	// Node 0 is the root, node i + 1 holds bone i. Heap order is a valid parent-first order.
+	skeleton.nodes = std::make_shared<BoneNode[]>(nrBones + 1);
+	skeleton.nrNodes = nrBones + 1;
+	skeleton.nodes[0].bindPoseTransform = mat4f(1.0f);
+	for (u32 i = 0; i < nrBones; i++)
+	{
+		BoneNode& node = skeleton.nodes[i + 1];
+		node.bindPoseTransform = mat4f(1.0f);
+		node.offset = skeleton.bones[i].offset;
+		node.parent = i == 0 ? 0 : static_cast<i32>((i - 1) / 2 + 1);
+		node.index = static_cast<i32>(i);
+	}
+	for (u32 i = nrBones; i > 0; i--)
+	{
+		const BoneNode& node = skeleton.nodes[i];
+		BoneNode& parent = skeleton.nodes[node.parent];
+		parent.height = std::max(parent.height, node.height + 1);
+	}
+}
+
+/** @brief Builds an animation with `nrKeys` keys per channel on every bone, one key per tick at 30 ticks per second. */
+inline void CreateAnimation(Animation& animation, u32 nrBones, u32 nrKeys)
+{
+	animation.bonesAnimKeys = std::make_unique<BoneAnimationKeys[]>(nrBones);
+	animation.nrKeys = nrBones;
+	animation.duration = static_cast<f32>(nrKeys - 1);
+	animation.ticksPerSecond = 30.0f;
+	for (u32 bone = 0; bone < nrBones; bone++)
+	{
+		BoneAnimationKeys& boneKeys = animation.bonesAnimKeys[bone];
+		boneKeys.posKeys = std::make_unique<KeyPosition[]>(nrKeys);
+		boneKeys.rotKeys = std::make_unique<KeyRotation[]>(nrKeys);
+		boneKeys.scaleKeys = std::make_unique<KeyScale[]>(nrKeys);
+		boneKeys.nrPosKeys = boneKeys.nrRotKeys = boneKeys.nrScaleKeys = nrKeys;
+
+		vec3f axis = glm::normalize(vec3f(1.0f, static_cast<f32>(bone % 3), static_cast<f32>(bone % 5)));
+		for (u32 i = 0; i < nrKeys; i++)
+		{
+			f32 t = static_cast<f32>(i);
+			boneKeys.posKeys[i] = { t, vec3f(std::sin(t * 0.1f), 1.0f, std::cos(t * 0.1f)) };
+			boneKeys.rotKeys[i] = { t, glm::angleAxis(std::sin(t * 0.05f + bone), axis) };
+			boneKeys.scaleKeys[i] = { t, vec3f(1.0f + 0.1f * std::sin(t * 0.2f)) };
+		}
+	}
+}
+
+/** @brief The first vertex moved by the target and the number of vertices it moves, see `CreateMorphTargets`. */
+inline std::pair<u32, u32> GetMorphTargetRange(u32 target, u32 nrMoved, u32 nrTargets)
+{
+	const u32 first = target * nrMoved / nrTargets;
+	return { first, std::min(2 * nrMoved / nrTargets, nrMoved - first) };
+}
+
+/** @brief The deltas of the vertex in the target, as given to `MorphTargetSet::AddTarget`. */
+inline vec3f GetMorphPositionDelta(u32 vertex, u32 target)
+{
+	return vec3f(0.02f * std::sin(vertex * 0.1f + target), 0.01f * std::cos(vertex * 0.07f + target), 0.005f * static_cast<f32>(target % 3 + 1));
+}
+inline vec3f GetMorphNormalDelta(u32 vertex, u32 target)
+{
+	return vec3f(0.1f * std::sin(static_cast<f32>(vertex + target)), 0.0f, 0.05f);
+}
+
+/**
+ * @brief Builds `nrTargets` targets on a mesh of `nrVertices` vertices, as the expressions of a face: only the first
+ * `nrMoved` vertices are moved, each target moves its own range of them (see `GetMorphTargetRange`), overlapping the next one.
+ */
+inline void CreateMorphTargets(MorphTargetSet& targets, u32 nrVertices, u32 nrMoved, u32 nrTargets)
+{
+	Vector<i32> slots(nrVertices, -1);
+	for (u32 i = 0; i < nrMoved; i++)
+		slots[i] = static_cast<i32>(targets.AddSlot());
+
+	Vector<vec3f> positionDeltas(nrVertices);
+	Vector<vec3f> normalDeltas(nrVertices);
+	for (u32 t = 0; t < nrTargets; t++)
+	{
+		std::fill(positionDeltas.begin(), positionDeltas.end(), vec3f(0.0f));
+		std::fill(normalDeltas.begin(), normalDeltas.end(), vec3f(0.0f));
+		auto [first, count] = GetMorphTargetRange(t, nrMoved, nrTargets);
+		for (u32 i = first; i < first + count; i++)
+		{
+			positionDeltas[i] = GetMorphPositionDelta(i, t);
+			normalDeltas[i] = GetMorphNormalDelta(i, t);
+		}
+		targets.AddTarget(std::format("target_{}", t), 0.0f, positionDeltas.data(), normalDeltas.data(), slots.data(), nrVertices);
+	}
+}
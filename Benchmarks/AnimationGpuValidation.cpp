@@ -0,0 +1,314 @@
+#include "Core/Core.hpp"
+#include "Core/GL.hpp"
+#include "Core/Log/Logger.hpp"
+#include "Core/Math/Base.hpp"
+#include "Core/Math/Ext.hpp"
+#include "Engine/ECS/Animation/Animation.hpp"
+#include "Engine/ECS/Animation/Animator.hpp"
+#include "Engine/ECS/Skeleton/SkeletalMesh.hpp"
+#include "Engine/Filesystem/Filesystem.hpp"
+#include "Engine/Graphics/Shader.hpp"
+#include "Engine/Graphics/BonePaletteBuffer.hpp"
+#include "Engine/Graphics/GpuAnimationEvaluator.hpp"
+#include "Engine/Graphics/MorphTargetBuffer.hpp"
+
+#include "AnimationFixtures.hpp"
+
+#include <GLFW/glfw3.h>
+
+/** @brief Largest difference allowed between a palette element of the GPU and the CPU, relative to the element when larger than 1. */
+static constexpr f32 TOLERANCE = 1e-3f;
+
+// ----------------------------------------------------
+//										UTILITIES
+// ----------------------------------------------------
+
+/** @brief Creates a hidden window with an OpenGL 4.5 core context, the version exposed by Mesa llvmpipe. */
+static GLFWwindow* CreateContext()
+{
+	if (!glfwInit())
+	{
+		CONSOLE_ERROR("Failed to initialize GLFW");
+		return nullptr;
+	}
+
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(64, 64, "AnimationGpuValidation", nullptr, nullptr);
+	if (!window)
+	{
+		CONSOLE_ERROR("Failed to create an OpenGL 4.5 context");
+		glfwTerminate();
+		return nullptr;
+	}
+
+	glfwMakeContextCurrent(window);
+	if (gladLoadGL(glfwGetProcAddress) == 0)
+	{
+		CONSOLE_ERROR("Failed to load the OpenGL functions");
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return nullptr;
+	}
+
+	CONSOLE_INFO("OpenGL renderer: {}, version {}", reinterpret_cast<const char*>(glGetString(GL_RENDERER)), reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+	return window;
+}
+
+/** @brief Compiles a compute shader on its own: the shaders of the `ShadersManager` require OpenGL 4.6. */
+static Program CreateComputeProgram(StringView filename)
+{
+	const fs::path path = Filesystem::GetShadersPath() / filename;
+	IStream file(path);
+	String source{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	if (source.empty())
+	{
+		CONSOLE_ERROR("Compute shader not found: {}", path.string());
+		return Program{};
+	}
+
+	Shader shader;
+	shader.Create(GL_COMPUTE_SHADER, source);
+	if (!shader.Compile())
+	{
+		CONSOLE_ERROR("Error on compiling {}: {}", filename, shader.GetShaderInfo());
+		shader.Delete();
+		return Program{};
+	}
+
+	Program program;
+	program.Create();
+	program.AttachShader(shader);
+	const bool linked = program.Link();
+	shader.Delete();
+	if (!linked)
+	{
+		CONSOLE_ERROR("Error on linking {}: {}", filename, program.GetProgramInfo());
+		program.Delete();
+		return Program{};
+	}
+	return program;
+}
+
+// ----------------------------------------------------
+//										VALIDATION
+// ----------------------------------------------------
+
+struct ValidationCase
+{
+	StringView name;
+	u32 nrBones;
+	/** @brief Channels of the clip: fewer than the bones leaves the last bones to the identity. */
+	u32 nrChannels;
+	u32 nrInstances;
+	u32 nrFrames;
+};
+
+/**
+ * @brief Evaluates a crowd on the GPU for a few frames and compares every palette with the one of its `Animator`.
+ * The bind pose of the root and the bone offsets are not the identity, so that the whole hierarchy is checked.
+ *
+ * @return Whether every palette matches.
+ */
+static bool RunCase(const Program& program, const ValidationCase& validationCase)
+{
+	SkeletalMesh skeleton;
+	CreateSkeleton(skeleton, validationCase.nrBones);
+	skeleton.nodes[0].bindPoseTransform = glm::translate(mat4f(1.0f), vec3f(0.0f, 1.0f, 0.0f)) * glm::rotate(mat4f(1.0f), 0.5f, vec3f(0.0f, 0.0f, 1.0f));
+	for (u32 i = 0; i < validationCase.nrBones; i++)
+	{
+		skeleton.bones[i].offset = glm::translate(mat4f(1.0f), vec3f(0.0f, -0.1f * static_cast<f32>(i % 16), 0.05f));
+		skeleton.nodes[i + 1].offset = skeleton.bones[i].offset;
+	}
+
+	Animation animation;
+	CreateAnimation(animation, validationCase.nrChannels, 120);
+	animation.Cook(GpuAnimationEvaluator::COOKED_FRAMES_PER_SECOND);
+
+	Vector<Animator> animators(validationCase.nrInstances);
+	for (u32 i = 0; i < validationCase.nrInstances; i++)
+	{
+		Animator& animator = animators[i];
+		animator.SetTargetSkeleton(skeleton);
+		animator.SetTargetAnimation(&animation);
+		animator.currentTime = animation.duration * static_cast<f32>(i) / static_cast<f32>(validationCase.nrInstances);
+		animator.PlayAnimation();
+	}
+
+	BonePaletteBuffer palettes;
+	palettes.Create(validationCase.nrInstances * validationCase.nrBones);
+	GpuAnimationEvaluator evaluator;
+	evaluator.Create(program);
+
+	constexpr f32 dt = 1.0f / 60.0f;
+	GpuAnimationEvaluator::ValidationResult total{};
+	f64 dispatchNs = 0.0;
+	for (u32 frame = 0; frame < validationCase.nrFrames; frame++)
+	{
+		palettes.BeginFrame();
+		evaluator.BeginFrame();
+		for (u32 i = 0; i < validationCase.nrInstances; i++)
+		{
+			u32 offset = palettes.Reserve(i, animators[i].nrBoneTransforms);
+			evaluator.AddInstance(animators[i], offset);
+		}
+		palettes.EndFrame();
+
+		auto t0 = chrono::high_resolution_clock::now();
+		evaluator.Dispatch(palettes);
+		glFinish();
+		dispatchNs += static_cast<f64>(chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - t0).count());
+
+		GpuAnimationEvaluator::ValidationResult result = evaluator.Validate(palettes, TOLERANCE);
+		total.nrInstances += result.nrInstances;
+		total.nrMismatches += result.nrMismatches;
+		total.maxError = std::max(total.maxError, result.maxError);
+
+		for (Animator& animator : animators)
+			animator.AdvanceTime(dt);
+	}
+
+	evaluator.Delete();
+	palettes.Delete();
+
+	const bool passed = total.nrInstances > 0 && total.nrMismatches == 0;
+	std::cout << std::format("gpu_validation case={} bones={} channels={} instances={} frames={} max_error={:.3g} mismatches={} dispatch_ms={:.3f} {}\n",
+		validationCase.name, validationCase.nrBones, validationCase.nrChannels, validationCase.nrInstances, validationCase.nrFrames,
+		total.maxError, total.nrMismatches, dispatchNs / validationCase.nrFrames / 1e6, passed ? "PASS" : "FAIL");
+	return passed;
+}
+
+struct MorphValidationCase
+{
+	StringView name;
+	u32 nrVertices;
+	u32 nrMoved;
+	u32 nrTargets;
+	u32 nrEntities;
+};
+
+/**
+ * @brief Accumulates the targets of a crowd on the GPU and compares the vertices of every entity with `MorphTargetSet::Apply`.
+ * The entities alternate between two target sets, and activate a different subset of their targets: none for some of them.
+ *
+ * @return Whether every entity matches.
+ */
+static bool RunMorphCase(const Program& program, const MorphValidationCase& validationCase)
+{
+	MorphTargetSet sets[2];
+	CreateMorphTargets(sets[0], validationCase.nrVertices, validationCase.nrMoved, validationCase.nrTargets);
+	CreateMorphTargets(sets[1], validationCase.nrVertices / 2, validationCase.nrMoved / 2, validationCase.nrTargets / 2 + 1);
+
+	MorphTargetBuffer buffer;
+	buffer.Create(program);
+	buffer.BeginFrame();
+
+	Vector<Vector<f32>> weights(validationCase.nrEntities);
+	Vector<i32> offsets(validationCase.nrEntities);
+	for (u32 e = 0; e < validationCase.nrEntities; e++)
+	{
+		const MorphTargetSet& set = sets[e % 2];
+		weights[e].resize(set.GetNumTargets(), 0.0f);
+		for (u32 t = 0; t < set.GetNumTargets(); t++)
+			if ((e + t) % (e % 7 + 1) == 0)
+				weights[e][t] = std::sin(static_cast<f32>(e + t)) * 0.5f + 0.5f;
+		if (e % 5 == 0)
+			std::fill(weights[e].begin(), weights[e].end(), 0.0f);
+		offsets[e] = buffer.Update(set, weights[e].data());
+	}
+
+	auto t0 = chrono::high_resolution_clock::now();
+	buffer.Dispatch();
+	glFinish();
+	const f64 dispatchNs = static_cast<f64>(chrono::duration_cast<chrono::nanoseconds>(chrono::high_resolution_clock::now() - t0).count());
+
+	u32 nrMismatches = 0;
+	u32 nrMorphed = 0;
+	f32 maxError = 0.0f;
+	Vector<vec3f> cpuPositions, cpuNormals, gpuPositions, gpuNormals;
+	for (u32 e = 0; e < validationCase.nrEntities; e++)
+	{
+		const MorphTargetSet& set = sets[e % 2];
+		cpuPositions.resize(set.GetNumSlots());
+		cpuNormals.resize(set.GetNumSlots());
+		const u32 nrApplied = set.Apply(weights[e].data(), cpuPositions.data(), cpuNormals.data());
+
+		// No active target: nothing dispatched, the draw call reads no morph
+		if (offsets[e] == MorphTargetBuffer::NO_MORPH)
+		{
+			if (nrApplied > 0)
+				nrMismatches++;
+			continue;
+		}
+
+		gpuPositions.resize(set.GetNumSlots());
+		gpuNormals.resize(set.GetNumSlots());
+		buffer.Read(static_cast<u32>(offsets[e]), set.GetNumSlots(), gpuPositions.data(), gpuNormals.data());
+
+		f32 entityError = 0.0f;
+		for (u32 i = 0; i < set.GetNumSlots(); i++)
+		{
+			entityError = std::max(entityError, glm::length(gpuPositions[i] - cpuPositions[i]));
+			entityError = std::max(entityError, glm::length(gpuNormals[i] - cpuNormals[i]));
+		}
+		maxError = std::max(maxError, entityError);
+		if (entityError > TOLERANCE)
+			nrMismatches++;
+		nrMorphed++;
+	}
+	buffer.Delete();
+
+	const bool passed = nrMorphed > 0 && nrMismatches == 0;
+	std::cout << std::format("gpu_validation case={} vertices={} moved={} targets={} entities={} morphed={} max_error={:.3g} mismatches={} dispatch_ms={:.3f} {}\n",
+		validationCase.name, validationCase.nrVertices, validationCase.nrMoved, validationCase.nrTargets, validationCase.nrEntities, nrMorphed,
+		maxError, nrMismatches, dispatchNs / 1e6, passed ? "PASS" : "FAIL");
+	return passed;
+}
+
+// ----------------------------------------------------
+//										MAIN
+// ----------------------------------------------------
+
+i32 main()
+{
+	Logger::Initialize();
+
+	GLFWwindow* window = CreateContext();
+	if (!window)
+		return 1;
+
+	Program program = CreateComputeProgram("AnimationEval.comp");
+	Program morphProgram = CreateComputeProgram("MorphTargets.comp");
+	if (!program.IsValid() || !morphProgram.IsValid())
+	{
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return 1;
+	}
+
+	// 150 bones: beyond the 100 bones of the former uniform array
+	static constexpr ValidationCase cases[] = {
+		{ "bone_order", 64, 64, 1000, 8 },
+		{ "missing_channels", 64, 48, 256, 4 },
+		{ "large_skeleton", 150, 150, 1000, 8 },
+	};
+
+	// Faces: a part of the vertices moved by many overlapping targets
+	static constexpr MorphValidationCase morphCases[] = {
+		{ "morph_targets", 20000, 2000, 52, 256 },
+	};
+
+	bool passed = true;
+	for (const ValidationCase& validationCase : cases)
+		passed &= RunCase(program, validationCase);
+	for (const MorphValidationCase& validationCase : morphCases)
+		passed &= RunMorphCase(morphProgram, validationCase);
+
+	program.Delete();
+	morphProgram.Delete();
+	glfwDestroyWindow(window);
+	glfwTerminate();
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,419 @@
+#include "Core/Core.hpp"
+#include "Core/Log/Logger.hpp"
+#include "Core/Math/Base.hpp"
+#include "Core/Math/Ext.hpp"
+#include "Core/Thread/JobSystem.hpp"
+#include "Engine/ECS/ChangeObserver.hpp"
+#include "Engine/ECS/Light.hpp"
+#include "Engine/ECS/Transform.hpp"
+#include "Engine/ECS/TransformCompose.hpp"
+#include "Engine/ECS/TransformHierarchy.hpp"
+
+#include <entt/entt.hpp>
+
+#include <random>
+
+// ----------------------------------------------------
+//										UTILITIES
+// ----------------------------------------------------
+
+/** @brief Runs the callable `iterations` times and returns the elapsed time in nanoseconds. */
+template<typename Func>
+static f64 Measure(u32 iterations, Func&& func)
+{
+	auto t0 = chrono::steady_clock::now();
+	for (u32 i = 0; i < iterations; i++)
+		func();
+	auto t1 = chrono::steady_clock::now();
+	return chrono::duration_cast<chrono::duration<f64, std::nano>>(t1 - t0).count();
+}
+
+/**
+ * @brief Builds a forest of 4 trees where every node has 4 children, with random transforms.
+ * The entities are created in random order, so that the children are often created before their parent.
+ *
+ * @return The entity of each node, node i being the parent of nodes 4 * i + 4 to 4 * i + 7.
+ */
+static Vector<entt::entity> CreateHierarchy(entt::registry& registry, TransformHierarchy& hierarchy, u32 nrNodes, std::mt19937& rng)
+{
+	Vector<u32> creationOrder(nrNodes);
+	std::iota(creationOrder.begin(), creationOrder.end(), 0);
+	std::shuffle(creationOrder.begin(), creationOrder.end(), rng);
+
+	std::uniform_real_distribution<f32> distribution(-1.0f, 1.0f);
+	Vector<entt::entity> entities(nrNodes);
+	for (u32 node : creationOrder)
+	{
+		entities[node] = registry.create();
+		Transform& transform = registry.emplace<Transform>(entities[node]);
+		transform.position = vec3f(distribution(rng), distribution(rng), distribution(rng));
+		transform.SetEulerAngles(vec3f(distribution(rng), distribution(rng), distribution(rng)) * 180.0f);
+		transform.scale = vec3f(1.0f + 0.1f * distribution(rng));
+		transform.UpdateTransformation();
+	}
+	for (u32 node = 4; node < nrNodes; node++)
+		hierarchy.SetParent(entities[node], entities[node / 4 - 1]);
+	return entities;
+}
+
+/** @return The matrix translation * rotation * scale built by glm, with three matrices and two products */
+static mat4f ComposeReference(const vec3f& position, const quat& rotation, const vec3f& scale)
+{
+	return glm::translate(mat4f(1.0f), position) * glm::mat4_cast(rotation) * glm::scale(mat4f(1.0f), scale);
+}
+
+/** @return The largest distance between the columns of two matrices */
+static f32 MatrixError(const mat4f& a, const mat4f& b)
+{
+	f32 error = 0.0f;
+	for (i32 column = 0; column < 4; column++)
+		error = std::max(error, glm::length(a[column] - b[column]));
+	return error;
+}
+
+/** @return The number of world matrices further than the tolerance from the product of the local matrices up to the root. */
+static u32 CountMismatches(entt::registry& registry, const Vector<entt::entity>& entities)
+{
+	Vector<mat4f> worlds(entities.size());
+	u32 nrMismatches = 0;
+	for (u32 node = 0; node < entities.size(); node++)
+	{
+		Transform& transform = registry.get<Transform>(entities[node]);
+		const mat4f local = ComposeReference(transform.position, transform.rotation, transform.scale);
+		worlds[node] = node < 4 ? local : worlds[node / 4 - 1] * local;
+
+		const f32 error = MatrixError(transform.GetTransformation(), worlds[node]);
+		if (error > 1e-3f * std::max(1.0f, glm::length(worlds[node][3])))
+			nrMismatches++;
+	}
+	return nrMismatches;
+}
+
+// ----------------------------------------------------
+//										BENCHMARKS
+// ----------------------------------------------------
+
+/**
+ * @brief Moves `nrMoved` random nodes of a hierarchy every frame and updates the world matrices. Compares with
+ * the update of every node, and with the update after reparenting nodes, which sorts the hierarchy again.
+ * The world matrices are checked against the product of the local matrices.
+ */
+static void BenchTransformHierarchy(u32 nrNodes, u32 nrMoved, u32 nrFrames)
+{
+	std::mt19937 rng(42);
+	entt::registry registry;
+	TransformHierarchy hierarchy;
+	hierarchy.Connect(registry);
+	Vector<entt::entity> entities = CreateHierarchy(registry, hierarchy, nrNodes, rng);
+
+	const f64 nsFirst = Measure(1, [&]() { hierarchy.Update(); });
+
+	std::uniform_int_distribution<u32> pickNode(0, nrNodes - 1);
+	f64 nsMoved = 0.0;
+	u64 nrUpdated = 0;
+	for (u32 frame = 0; frame < nrFrames; frame++)
+	{
+		for (u32 i = 0; i < nrMoved; i++)
+		{
+			Transform& transform = registry.get<Transform>(entities[pickNode(rng)]);
+			transform.position.y += 0.01f;
+			transform.UpdateTransformation();
+		}
+		nsMoved += Measure(1, [&]() { hierarchy.Update(); });
+		nrUpdated += hierarchy.GetNumUpdated();
+	}
+
+	// Every node: the roots moved
+	f64 nsFull = 0.0;
+	for (u32 frame = 0; frame < nrFrames; frame++)
+	{
+		for (u32 root = 0; root < 4; root++)
+			registry.get<Transform>(entities[root]).UpdateTransformation();
+		nsFull += Measure(1, [&]() { hierarchy.Update(); });
+	}
+
+	// Leaves moved under another node: the order is rebuilt
+	f64 nsReparent = 0.0;
+	for (u32 frame = 0; frame < nrFrames; frame++)
+	{
+		const u32 leaf = nrNodes - 1 - frame % (nrNodes / 2);
+		hierarchy.SetParent(entities[leaf], entities[frame % 4]);
+		nsReparent += Measure(1, [&]() { hierarchy.Update(); });
+		hierarchy.SetParent(entities[leaf], entities[leaf / 4 - 1]);
+		hierarchy.Update();
+	}
+
+	const u32 nrMismatches = CountMismatches(registry, entities);
+	hierarchy.Disconnect(registry);
+
+	std::cout << std::format("transform_hierarchy nodes={} moved={} first={:>9.1f} us update={:>8.1f} us updated={:>6} full={:>9.1f} us reparent={:>9.1f} us mismatches={} {}\n",
+		nrNodes, nrMoved, nsFirst / 1e3, nsMoved / nrFrames / 1e3, nrUpdated / nrFrames, nsFull / nrFrames / 1e3, nsReparent / nrFrames / 1e3,
+		nrMismatches, nrMismatches == 0 ? "PASS" : "FAIL");
+}
+
+/**
+ * @brief Builds the local matrices of `nrTransforms` random transforms, every one dirty. Compares the former path
+ * of `Transform::UpdateTransformation` (Euler angles to a quaternion, three matrices, two products) with the
+ * batch composition from quaternions, scalar and AVX2. The matrices are checked against the former path.
+ */
+static void BenchTransformCompose(u32 nrTransforms, u32 iterations)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<f32> distribution(-1.0f, 1.0f);
+	Vector<vec3f> eulerAngles(nrTransforms);
+	Vector<TransformCompose::TRS> transforms(nrTransforms);
+	for (u32 i = 0; i < nrTransforms; i++)
+	{
+		eulerAngles[i] = vec3f(distribution(rng), distribution(rng), distribution(rng)) * 180.0f;
+		transforms[i].position = vec3f(distribution(rng), distribution(rng), distribution(rng)) * 100.0f;
+		transforms[i].scale = vec3f(1.0f + 0.5f * distribution(rng), 1.0f + 0.5f * distribution(rng), 1.0f + 0.5f * distribution(rng));
+		transforms[i].rotation = quat(glm::radians(eulerAngles[i]));
+	}
+	Vector<u32> indices(nrTransforms);
+	std::iota(indices.begin(), indices.end(), 0);
+
+	Vector<mat4f> reference(nrTransforms);
+	Vector<mat4f> scalar(nrTransforms);
+	Vector<mat4f> simd(nrTransforms);
+
+	const f64 nsEuler = Measure(iterations, [&]() {
+		for (u32 i = 0; i < nrTransforms; i++)
+		{
+			const vec3f& angles = eulerAngles[i];
+			const quat rotation(vec3f(glm::radians(angles.x), glm::radians(angles.y), glm::radians(angles.z)));
+			reference[i] = glm::translate(mat4f(1.0f), transforms[i].position) * mat4f(rotation) * glm::scale(mat4f(1.0f), transforms[i].scale);
+		}
+	});
+	const f64 nsScalar = Measure(iterations, [&]() { TransformCompose::ComposeMatricesScalar(transforms.data(), indices.data(), nrTransforms, scalar.data()); });
+	const f64 nsSimd = Measure(iterations, [&]() { TransformCompose::ComposeMatrices(transforms.data(), indices.data(), nrTransforms, simd.data()); });
+
+	f32 maxError = 0.0f;
+	for (u32 i = 0; i < nrTransforms; i++)
+	{
+		const f32 tolerance = std::max(1.0f, glm::length(reference[i][3]));
+		maxError = std::max(maxError, MatrixError(scalar[i], reference[i]) / tolerance);
+		maxError = std::max(maxError, MatrixError(simd[i], reference[i]) / tolerance);
+	}
+
+	const f64 count = static_cast<f64>(nrTransforms) * iterations;
+	std::cout << std::format("transform_compose transforms={} euler={:>7.2f} ns scalar={:>7.2f} ns simd={:>7.2f} ns speedup={:.2f} max_error={:.6f} {}\n",
+		nrTransforms, nsEuler / count, nsScalar / count, nsSimd / count, nsEuler / nsSimd, maxError, maxError < 1e-4f ? "PASS" : "FAIL");
+}
+
+/**
+ * @brief Keeps a staging copy of `nrLights` point lights up to date while `nrChanged` random lights are patched
+ * every frame. Compares the copy of every light with the copy of the lights listed by a `ChangeObserver`.
+ * The staging copy kept by the observer is checked against the registry.
+ */
+static void BenchChangeTracking(u32 nrLights, u32 nrChanged, u32 nrFrames)
+{
+	std::mt19937 rng(11);
+	entt::registry registry;
+	Vector<entt::entity> entities(nrLights);
+	for (u32 i = 0; i < nrLights; i++)
+	{
+		entities[i] = registry.create();
+		registry.emplace<PointLight>(entities[i]).position = vec3f(static_cast<f32>(i), 0.0f, 0.0f);
+	}
+
+	ChangeObserver<PointLight> changes;
+	changes.Connect(registry);
+
+	auto& storage = registry.storage<PointLight>();
+	auto view = registry.view<PointLight>();
+	Vector<PointLight> staging(nrLights);
+	auto CopyLight = [&](entt::entity entity) { staging[storage.index(entity)] = storage.get(entity); };
+	for (entt::entity entity : view)
+		CopyLight(entity);
+
+	std::uniform_int_distribution<u32> pickLight(0, nrLights - 1);
+	auto PatchLights = [&]() {
+		for (u32 i = 0; i < nrChanged; i++)
+			registry.patch<PointLight>(entities[pickLight(rng)], [](PointLight& light) { light.intensity += 0.01f; });
+	};
+
+	f64 nsFull = 0.0;
+	f64 nsPatch = 0.0;
+	f64 nsChanged = 0.0;
+	for (u32 frame = 0; frame < nrFrames; frame++)
+	{
+		nsPatch += Measure(1, PatchLights);
+		nsChanged += Measure(1, [&]() {
+			for (entt::entity entity : changes.GetChanged())
+				CopyLight(entity);
+			changes.Clear();
+		});
+	}
+
+	// The copy of the changed lights only is the same as the copy of every light
+	u32 nrMismatches = 0;
+	for (entt::entity entity : view)
+		if (staging[storage.index(entity)].intensity != storage.get(entity).intensity)
+			nrMismatches++;
+
+	for (u32 frame = 0; frame < nrFrames; frame++)
+	{
+		PatchLights();
+		nsFull += Measure(1, [&]() {
+			for (entt::entity entity : view)
+				CopyLight(entity);
+		});
+	}
+	changes.Disconnect();
+
+	std::cout << std::format("change_tracking lights={} changed={} full={:>9.1f} us observed={:>8.1f} us patch={:>8.1f} us mismatches={} {}\n",
+		nrLights, nrChanged, nsFull / nrFrames / 1e3, nsChanged / nrFrames / 1e3, nsPatch / nrFrames / 1e3, nrMismatches, nrMismatches == 0 ? "PASS" : "FAIL");
+}
+
+/**
+ * @brief Runs the same work on a job system of 1 thread, then 2, 4... up to `maxThreads`:
+ * the composition of `nrTransforms` matrices split into batches, the update of as many point lights through
+ * an entt view, and a graph of jobs in three stages, each stage depending on the counter of the previous one.
+ * The matrices and the lights are checked against the single thread run, the stages against their order.
+ */
+static void BenchJobSystem(u32 nrTransforms, u32 nrFrames, u32 maxThreads, bool pinThreads)
+{
+	constexpr u32 COMPOSE_BATCH_SIZE = 4096;
+	constexpr u32 LIGHTS_BATCH_SIZE = 4096;
+	constexpr u32 JOBS_PER_STAGE = 64;
+
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<f32> distribution(-1.0f, 1.0f);
+	Vector<TransformCompose::TRS> transforms(nrTransforms);
+	for (auto& transform : transforms)
+	{
+		transform.position = vec3f(distribution(rng), distribution(rng), distribution(rng)) * 100.0f;
+		transform.scale = vec3f(1.0f + 0.5f * distribution(rng));
+		transform.rotation = glm::normalize(quat(distribution(rng), distribution(rng), distribution(rng), distribution(rng)));
+	}
+	Vector<u32> indices(nrTransforms);
+	std::iota(indices.begin(), indices.end(), 0);
+
+	entt::registry registry;
+	for (u32 i = 0; i < nrTransforms; i++)
+		registry.emplace<PointLight>(registry.create()).position = transforms[i].position;
+	auto view = registry.view<PointLight>();
+	const f32 angle = 0.01f;
+	auto UpdateLight = [&](entt::entity entity) {
+		vec3f& position = view.get<PointLight>(entity).position;
+		position = vec3f(position.x * std::cos(angle) - position.z * std::sin(angle), position.y, position.x * std::sin(angle) + position.z * std::cos(angle));
+	};
+
+	Vector<mat4f> expectedMatrices;
+	Vector<vec3f> expectedPositions;
+	f64 nsComposeSingle = 0.0;
+	f64 nsLightsSingle = 0.0;
+	for (u32 nrThreads = 1; nrThreads <= maxThreads; nrThreads = (nrThreads < maxThreads && nrThreads * 2 > maxThreads) ? maxThreads : nrThreads * 2)
+	{
+		JobSystem jobSystem(nrThreads - 1, pinThreads);
+
+		Vector<mat4f> matrices(nrTransforms);
+		const f64 nsCompose = Measure(nrFrames, [&]() {
+			jobSystem.ParallelFor(nrTransforms, COMPOSE_BATCH_SIZE, [&](u32 begin, u32 end) {
+				TransformCompose::ComposeMatrices(transforms.data(), indices.data() + begin, end - begin, matrices.data());
+			});
+		});
+
+		for (auto [entity, light] : view.each())
+			light.position = transforms[view.handle()->index(entity)].position;
+		const f64 nsLights = Measure(nrFrames, [&]() { jobSystem.ParallelFor(view, LIGHTS_BATCH_SIZE, UpdateLight); });
+
+		// Each job of a stage adds its value to the sum of the stage, and checks that the previous stage is complete
+		struct Graph
+		{
+			std::atomic<u32> sums[3]{};
+			std::atomic<u32> nrOutOfOrder{ 0 };
+			u32 stageSum = JOBS_PER_STAGE * (JOBS_PER_STAGE + 1) / 2;
+		} graph;
+		auto RunStageJob = [](void* data, u32 stage, u32 value) {
+			Graph& graph = *static_cast<Graph*>(data);
+			if (stage > 0 && graph.sums[stage - 1].load() != graph.stageSum)
+				graph.nrOutOfOrder++;
+			graph.sums[stage] += value;
+		};
+		const f64 nsGraph = Measure(nrFrames, [&]() {
+			for (auto& sum : graph.sums)
+				sum = 0;
+			JobCounter stages[3];
+			for (u32 stage = 0; stage < 3; stage++)
+				for (u32 value = 1; value <= JOBS_PER_STAGE; value++)
+					jobSystem.Schedule(Job{ RunStageJob, &graph, stage, value }, &stages[stage], stage > 0 ? &stages[stage - 1] : nullptr);
+			for (auto& counter : stages)
+				jobSystem.Wait(counter);
+		});
+
+		Vector<vec3f> positions;
+		positions.reserve(nrTransforms);
+		for (auto [entity, light] : view.each())
+			positions.push_back(light.position);
+		if (nrThreads == 1)
+		{
+			nsComposeSingle = nsCompose;
+			nsLightsSingle = nsLights;
+			expectedMatrices = matrices;
+			expectedPositions = positions;
+		}
+
+		bool valid = graph.nrOutOfOrder == 0 && graph.sums[2] == graph.stageSum && matrices == expectedMatrices && positions == expectedPositions;
+		std::cout << std::format("job_system transforms={} threads={} compose={:>7.3f} ms lights={:>7.3f} ms graph={:>7.1f} us speedup_compose={:.2f} speedup_lights={:.2f} steals={} {}\n",
+			nrTransforms, nrThreads, nsCompose / nrFrames / 1e6, nsLights / nrFrames / 1e6, nsGraph / nrFrames / 1e3,
+			nsComposeSingle / nsCompose, nsLightsSingle / nsLights, jobSystem.GetNumSteals(), valid ? "PASS" : "FAIL");
+	}
+}
+
+// ----------------------------------------------------
+//										MAIN
+// ----------------------------------------------------
+
+i32 main(i32 argc, char** argv)
+{
+	Logger::Initialize();
+
+	String filter;
+	u32 maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	bool pinThreads = false;
+	for (i32 i = 1; i < argc; i++)
+	{
+		const StringView arg = argv[i];
+		if (arg.starts_with("--filter="))
+		{
+			filter = arg.substr(9);
+		}
+		else if (arg.starts_with("--threads="))
+		{
+			maxThreads = std::max(static_cast<u32>(std::stoul(String(arg.substr(10)))), 1u);
+		}
+		else if (arg == "--pin")
+		{
+			pinThreads = true;
+		}
+		else
+		{
+			std::cout << "Usage: SceneBenchmark [--filter=<part of a benchmark name>] [--threads=<maximum number of threads>] [--pin]\n";
+			return 1;
+		}
+	}
+	auto enabled = [&](StringView name) { return filter.empty() || name.find(filter) != StringView::npos; };
+
+	if (enabled("transform_hierarchy"))
+		for (u32 nrNodes : { 10000u, 100000u })
+			for (u32 nrMoved : { 0u, 300u })
+				BenchTransformHierarchy(nrNodes, nrMoved, 64);
+
+	if (enabled("transform_compose"))
+	{
+		BenchTransformCompose(10000, 100);
+		BenchTransformCompose(1000000, 4);
+	}
+
+	if (enabled("change_tracking"))
+		for (u32 nrLights : { 10000u, 1000000u })
+			for (u32 nrChanged : { 0u, 10u, 1000u })
+				BenchChangeTracking(nrLights, nrChanged, 32);
+
+	if (enabled("job_system"))
+		for (u32 nrTransforms : { 100000u, 1000000u })
+			BenchJobSystem(nrTransforms, 16, maxThreads, pinThreads);
+
+	return 0;
+}
@@ -0,0 +1,95 @@
+#version 460
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aUv;
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in ivec4 aBoneIds; 
+layout (location = 5) in vec4 aWeights;
+
+out vec2 TexCoord;
+out vec3 Normal;
+out vec3 FragPos;
+out vec3 ViewPos;
+out mat3 TBN;
+out vec3 TangentViewPos;
+out vec3 TangentFragPos;
+
+layout (std140, binding = 0) uniform CameraBlock
+{
+  mat4 u_view;
+  mat4 u_projection;
+};
+uniform vec3 u_viewPos;
+
+/* Playback time shared by all the instances, in seconds */
+uniform float u_time;
+
+/* The baked clips: each row holds the palette of a frame, 3 texels per bone (see BakedClip) */
+uniform sampler2D u_bakedAnimation;
+
+struct BakedInstance
+{
+  mat4 model;
+  vec4 clip;      /* first frame, number of frames, duration */
+  vec4 playback;  /* time offset, speed */
+};
+layout (std430, binding = 3) readonly buffer InstanceBlock
+{
+  BakedInstance u_instances[];
+};
+
+const int MAX_BONE_INFLUENCE = 4;
+const int TEXELS_PER_BONE = 3;
+
+vec3 TransformByBone(int bone, int frame, vec4 position)
+{
+  int x = bone * TEXELS_PER_BONE;
+  vec4 row0 = texelFetch(u_bakedAnimation, ivec2(x + 0, frame), 0);
+  vec4 row1 = texelFetch(u_bakedAnimation, ivec2(x + 1, frame), 0);
+  vec4 row2 = texelFetch(u_bakedAnimation, ivec2(x + 2, frame), 0);
+  return vec3(dot(row0, position), dot(row1, position), dot(row2, position));
+}
+
+void main()
+{
+  BakedInstance instance = u_instances[gl_InstanceID];
+  mat4 model = instance.model;
+
+  // The two frames around the playback time of the instance, the clip loops
+  int firstFrame = int(instance.clip.x);
+  int nrFrames = int(instance.clip.y);
+  float phase = fract((u_time * instance.playback.y + instance.playback.x) / instance.clip.z) * float(nrFrames);
+  int frame0 = min(int(phase), nrFrames - 1);
+  int frame1 = (frame0 + 1) % nrFrames;
+  float factor = phase - float(frame0);
+
+  vec4 position = vec4(aPos, 1.0f);
+  vec4 totalPosition = vec4(0.0f);
+  for(int i = 0; i < MAX_BONE_INFLUENCE; i++)
+  {
+    if(aBoneIds[i] == -1) 
+      continue;
+    
+    vec3 p0 = TransformByBone(aBoneIds[i], firstFrame + frame0, position);
+    vec3 p1 = TransformByBone(aBoneIds[i], firstFrame + frame1, position);
+    totalPosition += vec4(mix(p0, p1, factor), 1.0f) * aWeights[i];
+  }
+
+
+  mat3 normalMatrix = mat3(transpose(inverse(model)));
+  vec3 N = normalize(normalMatrix * aNormal);
+  vec3 T = normalize(mat3(model) * aTangent);
+  T = normalize(T - dot(T, N) * N);
+  vec3 B = cross(N, T);
+  TBN = transpose(mat3(T,B,N));
+
+  FragPos = vec3(model * vec4(aPos, 1.0));
+  TexCoord = aUv;
+  ViewPos = u_viewPos;
+  Normal = N;
+
+  TangentViewPos = TBN * ViewPos;
+  TangentFragPos = TBN * FragPos;
+  gl_Position = u_projection * u_view * model * totalPosition;
+}
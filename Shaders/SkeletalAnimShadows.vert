@@ -6,6 +6,7 @@ layout (location = 2) in vec2 aUv;
 layout (location = 3) in vec3 aTangent;
 layout (location = 4) in ivec4 aBoneIds; 
 layout (location = 5) in vec4 aWeights;
+layout (location = 6) in int aMorphSlot; // -1 for a vertex moved by no morph target
 
 out vec2 TexCoord;
 out vec3 Normal;
@@ -28,37 +29,57 @@ uniform vec3 u_viewPos;
 uniform mat4 u_lightView;
 uniform mat4 u_lightProjection;
 
-const int MAX_BONES = 100;
+uniform int u_boneOffset; // First matrix of the palette of the draw call in BoneBlock
+
 const int MAX_BONE_INFLUENCE = 4;
-uniform mat4 u_finalBonesMatrices[MAX_BONES];
+layout (std430, binding = 2) readonly buffer BoneBlock
+{
+  mat4 u_boneTransforms[]; // The palettes of every skinned entity of the frame
+};
+
+uniform int u_morphOffset; // First vertex of the morph targets of the draw call in MorphBlock, -1 with no active target
+
+struct MorphVertex
+{
+  vec4 position;
+  vec4 normal;
+};
+layout (std430, binding = 10) readonly buffer MorphBlock
+{
+  MorphVertex u_morphVertices[]; // The weighted morph targets of every entity of the frame, see MorphTargets.comp
+};
 
 void main()
 {
+  // The morph targets move the vertex before skinning
+  vec3 position = aPos;
+  vec3 normal = aNormal;
+  if (u_morphOffset >= 0 && aMorphSlot >= 0)
+  {
+    MorphVertex morph = u_morphVertices[u_morphOffset + aMorphSlot];
+    position += morph.position.xyz;
+    normal = normalize(normal + morph.normal.xyz);
+  }
+
 	vec4 totalPosition = vec4(0.0f);
   for(int i = 0; i < MAX_BONE_INFLUENCE; i++)
   {
     if(aBoneIds[i] == -1) 
       continue;
     
-    if(aBoneIds[i] >= MAX_BONES) 
-    {
-      totalPosition = vec4(aPos, 1.0f);
-      break;
-    }
-    
-    vec4 localPosition = u_finalBonesMatrices[aBoneIds[i]] * vec4(aPos, 1.0f);
+    vec4 localPosition = u_boneTransforms[u_boneOffset + aBoneIds[i]] * vec4(position, 1.0f);
     totalPosition += localPosition * aWeights[i];
     //vec3 localNormal = mat3(u_finalBonesMatrices[aBoneIds[i]]) * aNormal;
   }
 
   mat3 normalMatrix = mat3(transpose(inverse(u_model)));
-  vec3 N = normalize(normalMatrix * aNormal);
+  vec3 N = normalize(normalMatrix * normal);
   vec3 T = normalize(mat3(u_model) * aTangent);
   T = normalize(T - dot(T, N) * N);
   vec3 B = cross(N, T);
   TBN = transpose(mat3(T,B,N));
 
-  FragPos = vec3(u_model * vec4(aPos, 1.0));
+  FragPos = vec3(u_model * vec4(position, 1.0));
   TexCoord = aUv;
   ViewPos = u_viewPos;
   Normal = N;
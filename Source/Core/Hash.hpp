@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+/************** FNV-1a 64 bits **************/
+/* Stable across runs and platforms: the hashes can be stored in files. */
+/********************************************/
+constexpr u64 FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+constexpr u64 FNV_PRIME = 0x100000001b3ull;
+
+/** @brief Hashes a block of bytes, continued from `hash`. */
+inline u64 HashBytes(const void* data, u64 size, u64 hash = FNV_OFFSET_BASIS)
+{
+	const u8* bytes = static_cast<const u8*>(data);
+	for (u64 i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+/** @brief Hashes a string, without its terminator. */
+constexpr u64 HashString(StringView str)
+{
+	u64 hash = FNV_OFFSET_BASIS;
+	for (char c : str)
+	{
+		hash ^= static_cast<u8>(c);
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
@@ -10,7 +10,8 @@ void Logger::Initialize()
 	/* https://github.com/gabime/spdlog/wiki/3.-Custom-formatting */
 	spdlog::set_pattern("[%s::%#] [%^%l%$]: %v");
 
-	_logger = spdlog::stdout_color_st("Logger");
+	// Thread-safe sink: the worker threads of the job system log too
+	_logger = spdlog::stdout_color_mt("Logger");
 	_logger->set_level(spdlog::level::trace);
 
 	spdlog::set_default_logger(_logger);
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Core/Math/Base.hpp"
+
+#include <limits>
+
+/**
+ * @struct AABB
+ * @brief Axis-aligned bounding box. Empty until a point is added.
+ */
+struct AABB
+{
+	vec3f min{ std::numeric_limits<f32>::max() };
+	vec3f max{ std::numeric_limits<f32>::lowest() };
+
+	bool IsEmpty() const { return min.x > max.x; }
+
+	vec3f GetCenter() const { return (min + max) * 0.5f; }
+	vec3f GetExtents() const { return (max - min) * 0.5f; }
+
+	/** @brief Grows the box to contain the point */
+	void Expand(const vec3f& point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	/** @brief Grows the box to contain the other box */
+	void Merge(const AABB& other)
+	{
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+
+	/**
+	 * @brief Returns the box containing this one once transformed by an affine transformation.
+	 * The result contains the transformed box, it is larger than it when the transformation rotates.
+	 */
+	AABB Transformed(const mat4f& transform) const
+	{
+		if (IsEmpty())
+			return *this;
+
+		// Each axis of the transformation scaled by the extents, in absolute value, adds up to the new extents
+		const vec3f center = vec3f(transform * vec4f(GetCenter(), 1.0f));
+		const vec3f extents = GetExtents();
+		const vec3f newExtents =
+			glm::abs(vec3f(transform[0])) * extents.x +
+			glm::abs(vec3f(transform[1])) * extents.y +
+			glm::abs(vec3f(transform[2])) * extents.z;
+
+		return AABB{ center - newExtents, center + newExtents };
+	}
+
+	/**
+	 * @brief Tests the box against the frustum of a view projection matrix.
+	 * Conservative: a box outside the frustum but crossing two of its planes near a corner is reported intersecting.
+	 *
+	 * @return False when the box is entirely outside one of the planes of the frustum.
+	 */
+	bool IntersectsFrustum(const mat4f& viewProjection) const
+	{
+		if (IsEmpty())
+			return false;
+
+		// The planes of the frustum are the sums and differences of the rows of the matrix
+		const vec4f row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+		const vec4f row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+		const vec4f row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+		const vec4f row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+		const vec4f planes[6] = { row3 + row0, row3 - row0, row3 + row1, row3 - row1, row3 + row2, row3 - row2 };
+
+		const vec3f center = GetCenter();
+		const vec3f extents = GetExtents();
+		for (const vec4f& plane : planes)
+		{
+			// Distance of the center against the projected radius of the box on the normal of the plane
+			const f32 distance = glm::dot(vec3f(plane), center) + plane.w;
+			const f32 radius = glm::dot(glm::abs(vec3f(plane)), extents);
+			if (distance + radius < 0.0f)
+				return false;
+		}
+		return true;
+	}
+};
@@ -0,0 +1,271 @@
+#include "JobSystem.hpp"
+
+#include "Core/Log/Logger.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/** @brief The job system running the calling thread as a worker, and the deque of that worker */
+struct WorkerContext
+{
+	const JobSystem* jobSystem = nullptr;
+	u32 queueIndex = 0;
+};
+
+static thread_local WorkerContext workerContext;
+
+/** @brief Binds the calling thread to a single hardware thread */
+static bool PinCurrentThread(u32 hardwareThread)
+{
+#if defined(_WIN32)
+	const DWORD_PTR mask = static_cast<DWORD_PTR>(1) << (hardwareThread % (sizeof(DWORD_PTR) * 8));
+	return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+	cpu_set_t cpuSet;
+	CPU_ZERO(&cpuSet);
+	CPU_SET(hardwareThread, &cpuSet);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+#else
+	return false;
+#endif
+}
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+JobSystem::JobSystem(u32 nrWorkers, bool pinThreads) :
+	_workers{},
+	_queues{},
+	_nrQueuedJobs{ 0 },
+	_nrSleeping{ 0 },
+	_nrSteals{ 0 },
+	_stop{ false }
+{
+	_queues.reserve(nrWorkers + 1);
+	for (u32 i = 0; i < nrWorkers + 1; i++)
+		_queues.push_back(std::make_unique<WorkQueue>());
+
+	_workers.reserve(nrWorkers);
+	for (u32 i = 0; i < nrWorkers; i++)
+		_workers.emplace_back(&JobSystem::WorkerLoop, this, i, pinThreads);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard lock(_sleepMutex);
+		_stop = true;
+	}
+	_wakeCondition.notify_all();
+	for (auto& worker : _workers)
+		worker.join();
+}
+
+void JobSystem::Schedule(const Job& job, JobCounter* counter, JobCounter* dependency)
+{
+	if (counter)
+		counter->_pending.fetch_add(1, std::memory_order_relaxed);
+
+	if (dependency)
+	{
+		// Checked under the lock of the dependency: its last job either sees this one waiting, or was done before
+		std::lock_guard lock(dependency->_mutex);
+		if (dependency->_pending.load(std::memory_order_acquire) != 0)
+		{
+			dependency->_waitingJobs.emplace_back(job, counter);
+			return;
+		}
+	}
+
+	Push(GetQueueIndex(), QueuedJob{ job, counter });
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+	const u32 queueIndex = GetQueueIndex();
+	QueuedJob job;
+	while (!counter.IsDone())
+	{
+		if (FindJob(queueIndex, job))
+			Run(job);
+		else
+			std::this_thread::yield();
+	}
+
+	// The last job may still hold the lock after the count reached zero: the counter can be destroyed once released
+	std::lock_guard lock(counter._mutex);
+}
+
+// ----------------------------------------------------
+//										PRIVATE
+// ----------------------------------------------------
+
+void JobSystem::ParallelFor(u32 count, u32 batchSize, RangeFunction func, const void* data)
+{
+	if (count == 0)
+		return;
+
+	batchSize = std::max(batchSize, 1u);
+	if (_workers.empty() || count <= batchSize)
+	{
+		func(data, 0, count);
+		return;
+	}
+
+	RangeContext context{ this, func, data, batchSize };
+	Split(&context, 0, count);
+	Wait(context.counter);
+}
+
+void JobSystem::WorkerLoop(u32 queueIndex, bool pinThread)
+{
+	workerContext = WorkerContext{ this, queueIndex };
+	if (pinThread)
+	{
+		const u32 hardwareThread = (queueIndex + 1) % std::max(std::thread::hardware_concurrency(), 1u);
+		if (!PinCurrentThread(hardwareThread))
+			CONSOLE_WARN("Job system: could not pin worker {} to hardware thread {}", queueIndex, hardwareThread);
+	}
+
+	QueuedJob job;
+	while (true)
+	{
+		if (FindJob(queueIndex, job))
+		{
+			Run(job);
+			continue;
+		}
+
+		// Registered as sleeping before checking for jobs: a job pushed meanwhile either is seen, or wakes this worker
+		std::unique_lock lock(_sleepMutex);
+		_nrSleeping.fetch_add(1);
+		_wakeCondition.wait(lock, [this]() { return _stop || _nrQueuedJobs.load() > 0; });
+		_nrSleeping.fetch_sub(1);
+		if (_stop)
+			return;
+	}
+}
+
+u32 JobSystem::GetQueueIndex() const
+{
+	if (workerContext.jobSystem == this)
+		return workerContext.queueIndex;
+
+	return static_cast<u32>(_queues.size()) - 1;
+}
+
+void JobSystem::Push(u32 queueIndex, const QueuedJob& job)
+{
+	{
+		WorkQueue& queue = *_queues[queueIndex];
+		std::unique_lock lock(queue.mutex);
+		if (queue.size == QUEUE_CAPACITY)
+		{
+			// Full: the job would have waited behind all the others anyway
+			lock.unlock();
+			Run(job);
+			return;
+		}
+
+		queue.jobs[(queue.first + queue.size) % QUEUE_CAPACITY] = job;
+		queue.size++;
+	}
+
+	_nrQueuedJobs.fetch_add(1);
+	if (_nrSleeping.load() > 0)
+	{
+		// Taking the lock orders the notification after a worker about to sleep has checked the number of jobs
+		{
+			std::lock_guard lock(_sleepMutex);
+		}
+		_wakeCondition.notify_one();
+	}
+}
+
+bool JobSystem::FindJob(u32 queueIndex, QueuedJob& job)
+{
+	if (_nrQueuedJobs.load(std::memory_order_relaxed) == 0)
+		return false;
+
+	// Its own most recent job first: the data it touches is the most likely to be in the cache
+	{
+		WorkQueue& queue = *_queues[queueIndex];
+		std::lock_guard lock(queue.mutex);
+		if (queue.size > 0)
+		{
+			queue.size--;
+			job = queue.jobs[(queue.first + queue.size) % QUEUE_CAPACITY];
+			_nrQueuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	// Then the oldest job of another thread: the largest part of a split range
+	const u32 nrQueues = static_cast<u32>(_queues.size());
+	for (u32 i = 1; i < nrQueues; i++)
+	{
+		WorkQueue& queue = *_queues[(queueIndex + i) % nrQueues];
+		std::lock_guard lock(queue.mutex);
+		if (queue.size > 0)
+		{
+			job = queue.jobs[queue.first];
+			queue.first = (queue.first + 1) % QUEUE_CAPACITY;
+			queue.size--;
+			_nrQueuedJobs.fetch_sub(1);
+			_nrSteals.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::Run(const QueuedJob& job)
+{
+	job.job.func(job.job.data, job.job.begin, job.job.end);
+
+	if (job.counter)
+		Release(*job.counter);
+}
+
+void JobSystem::Release(JobCounter& counter)
+{
+	std::lock_guard lock(counter._mutex);
+	if (counter._pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	// Queued under the lock: the vector keeps its capacity, and the jobs waiting for the counter do not touch it
+	const u32 queueIndex = GetQueueIndex();
+	for (const auto& [job, waitingCounter] : counter._waitingJobs)
+		Push(queueIndex, QueuedJob{ job, waitingCounter });
+	counter._waitingJobs.clear();
+}
+
+void JobSystem::Split(void* context, u32 begin, u32 end)
+{
+	RangeContext& range = *static_cast<RangeContext*>(context);
+
+	// Halves on batch boundaries, the second half being left to the thieves, until a single batch is left
+	u32 nrBatches = (end - begin + range.batchSize - 1) / range.batchSize;
+	while (nrBatches > 1)
+	{
+		const u32 nrStolen = nrBatches / 2;
+		const u32 middle = begin + (nrBatches - nrStolen) * range.batchSize;
+		range.jobSystem->Schedule(Job{ &JobSystem::Split, context, middle, end }, &range.counter);
+		end = middle;
+		nrBatches -= nrStolen;
+	}
+
+	range.func(range.data, begin, end);
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/** @brief Function run by a job, with the arguments given to `JobSystem::Schedule()`. */
+using JobFunction = void (*)(void* data, u32 begin, u32 end);
+
+/** @brief A function and its arguments, e.g. a range of indices: scheduled without any allocation. */
+struct Job
+{
+	JobFunction func = nullptr;
+	void* data = nullptr;
+	u32 begin = 0;
+	u32 end = 0;
+};
+
+/**
+ * @class JobCounter
+ * @brief Number of jobs not finished yet. A job scheduled with a counter adds one to it, and removes one when done.
+ *
+ * A counter is also a dependency: the jobs scheduled after it are queued once it is back to zero.
+ * Must outlive its jobs and the jobs waiting for it: `JobSystem::Wait()` it before destroying it.
+ * The jobs waiting for a counter are kept in a vector, which allocates the first time only.
+ */
+class JobCounter
+{
+public:
+	JobCounter() = default;
+	~JobCounter() = default;
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	/** @return True once every job of the counter is done */
+	bool IsDone() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+
+	std::atomic<u32> _pending{ 0 };
+
+	/** @brief Held while the count is decreased, and the jobs waiting for it taken */
+	mutable std::mutex _mutex;
+
+	/** @brief The jobs scheduled after the counter, queued when it is back to zero, with their own counter */
+	Vector<std::pair<Job, JobCounter*>> _waitingJobs;
+};
+
+/**
+ * @class JobSystem
+ * @brief Work-stealing scheduler: the one set of worker threads of the engine.
+ *
+ * Each worker has its own deque of jobs: it pushes and pops its jobs at the back, most recent first, while
+ * the idle workers steal the oldest jobs from the front of the others. The threads that are not workers,
+ * e.g. the main thread, share one more deque. A thread waiting for a counter runs jobs in the meantime, so
+ * jobs can schedule and wait for other jobs. The workers sleep when there is no job anywhere.
+ *
+ * `ParallelFor` splits a range of indices, or the entities of an entt view, into batches run as jobs,
+ * the calling thread included, and returns once every batch has run.
+ *
+ * Nothing is allocated once the job system is started: a job is a function pointer and its arguments, the deques
+ * are ring buffers of fixed capacity, and `ParallelFor` keeps the state of the loop on the stack of the caller.
+ */
+class JobSystem
+{
+public:
+	/** @brief Capacity of the deque of each thread. A job pushed to a full deque is run right away. */
+	static constexpr u32 QUEUE_CAPACITY = 1024;
+
+	/**
+	 * @brief Starts the worker threads.
+	 *
+	 * @param nrWorkers Number of threads besides the calling one. Zero runs every job on the thread waiting for it.
+	 * @param pinThreads Binds worker i to the hardware thread i + 1, modulo their number: the first one is left to the calling thread.
+	 */
+	explicit JobSystem(u32 nrWorkers, bool pinThreads = false);
+
+	/** @brief Waits for the workers to exit. The jobs still queued are not run. */
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/** @return The job system shared by the engine, with one worker per hardware thread besides the main one. */
+	static JobSystem& Get()
+	{
+		static JobSystem jobSystem(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+		return jobSystem;
+	}
+
+	/**
+	 * @brief Queues a job on the deque of the calling thread.
+	 *
+	 * @param counter Counter of the job, nullptr for none.
+	 * @param dependency Counter to wait for before the job is queued, nullptr for none.
+	 */
+	void Schedule(const Job& job, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+	/** @brief Runs jobs until every job of the counter is done. */
+	void Wait(const JobCounter& counter);
+
+	/**
+	 * @brief Runs `func(begin, end)` over the indices [0, count), split into batches of `batchSize` indices.
+	 * Blocks until all the batches are done. The calling thread runs batches too.
+	 */
+	template<typename Func>
+	void ParallelFor(u32 count, u32 batchSize, const Func& func)
+	{
+		ParallelFor(count, batchSize, [](const void* data, u32 begin, u32 end) { (*static_cast<const Func*>(data))(begin, end); }, &func);
+	}
+
+	/**
+	 * @brief Runs `func(entity)` for every entity of an entt view, split into batches of `batchSize` entities
+	 * of the storage leading the view. Blocks until all the batches are done.
+	 * The components of other entities must not be added or removed meanwhile.
+	 */
+	template<typename View, typename Func>
+		requires requires(const View& view) { view.handle(); }
+	void ParallelFor(const View& view, u32 batchSize, Func func)
+	{
+		const auto* entities = view.handle();
+		if (!entities)
+			return;
+
+		ParallelFor(static_cast<u32>(entities->size()), batchSize, [&view, &func, entities](u32 begin, u32 end) {
+			for (u32 i = begin; i < end; i++)
+			{
+				const auto entity = entities->data()[i];
+				if (view.contains(entity))
+					func(entity);
+			}
+		});
+	}
+
+	u32 GetNumWorkers() const { return static_cast<u32>(_workers.size()); }
+
+	/** @return The number of threads running jobs: the workers plus the calling thread. */
+	u32 GetNumThreads() const { return GetNumWorkers() + 1; }
+
+	/** @return The number of jobs taken from the deque of another thread since the start */
+	u64 GetNumSteals() const { return _nrSteals.load(std::memory_order_relaxed); }
+
+private:
+	/** @brief Function of a loop, called on a range of indices with the data given to `ParallelFor` */
+	using RangeFunction = void (*)(const void* data, u32 begin, u32 end);
+
+	struct QueuedJob
+	{
+		Job job;
+		JobCounter* counter = nullptr;
+	};
+
+	/** @brief Jobs of a thread, in a ring buffer: the owner at the back, the thieves at the front */
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		QueuedJob jobs[QUEUE_CAPACITY];
+		u32 first = 0;
+		u32 size = 0;
+	};
+
+	/** @brief State of a `ParallelFor`, on the stack of the caller: the jobs only point to it */
+	struct RangeContext
+	{
+		JobSystem* jobSystem;
+		RangeFunction func;
+		const void* data;
+		u32 batchSize;
+		JobCounter counter;
+	};
+
+	void ParallelFor(u32 count, u32 batchSize, RangeFunction func, const void* data);
+
+	void WorkerLoop(u32 queueIndex, bool pinThread);
+
+	/** @return The deque of the calling thread: its own for a worker, the shared one otherwise */
+	u32 GetQueueIndex() const;
+
+	void Push(u32 queueIndex, const QueuedJob& job);
+
+	/** @brief Takes a job from the back of the deque of the thread, or from the front of another one */
+	bool FindJob(u32 queueIndex, QueuedJob& job);
+
+	void Run(const QueuedJob& job);
+
+	/** @brief Leaves the second half of the batches of [begin, end) to the thieves, again for the first half, then runs the first batch */
+	static void Split(void* context, u32 begin, u32 end);
+
+	/** @brief Counts a job of the counter as done, and queues the jobs waiting for the counter once it is back to zero */
+	void Release(JobCounter& counter);
+
+	Vector<std::thread> _workers;
+
+	/** @brief One deque per worker, then the one of the other threads */
+	Vector<UniquePtr<WorkQueue>> _queues;
+
+	std::mutex _sleepMutex;
+	std::condition_variable _wakeCondition;
+	std::atomic<u32> _nrQueuedJobs;
+	std::atomic<u32> _nrSleeping;
+	std::atomic<u64> _nrSteals;
+	bool _stop;
+};
@@ -1,9 +1,9 @@
 #include "Animation.hpp"
 
+#include "Core/Hash.hpp"
 #include "Core/Log/Logger.hpp"
 #include "Engine/Filesystem/Filesystem.hpp"
-#include "Engine/ECS/Skeleton/SkeletalMesh.hpp"
-#include "Engine/Subsystems/ModelsManager.hpp"
+#include "Engine/ECS/Animation/KeyframeSearch.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -15,22 +15,36 @@
 // 									PUBLIC														
 // ---------------------------------------------------- 
 
-Animation::Animation(const SkeletalMesh& skeleton, const fs::path& relative) :
+Animation::Animation() :
 	bonesAnimKeys{},
 	nrKeys{ 0 },
+	channelHashes{},
+	cooked{},
+	compressed{},
 	duration{ 0 },
 	ticksPerSecond{ 0 },
-	id{}
+	id{},
+	_bindings{}
+{
+}
+
+Animation::Animation(const fs::path& relative) :
+	bonesAnimKeys{},
+	nrKeys{ 0 },
+	channelHashes{},
+	cooked{},
+	compressed{},
+	duration{ 0 },
+	ticksPerSecond{ 0 },
+	id{},
+	_bindings{}
 {
 	// E.g. relative = "Mutant/Drunk_Walk/anim.gltf"
 	// E.g. absolute = "D:GameEngine/Assets/Models/Skeletal/Mutant/Drunk_Walk/anim.gltf"
 	fs::path absolute = (Filesystem::GetSkeletalModelsPath() / relative);
 
 	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(absolute.string(), 
-																					 aiProcess_Triangulate |
-																					 aiProcess_LimitBoneWeights |
-																					 aiProcess_JoinIdenticalVertices);
+	const aiScene* scene = importer.ReadFile(absolute.string(), GetImportFlags());
 	if (!scene || !scene->mRootNode)
 	{
 		CONSOLE_ERROR("Assimp importer error: {}", importer.GetErrorString());
@@ -46,21 +60,115 @@ Animation::Animation(const SkeletalMesh& skeleton, const fs::path& relative) :
 	duration = animation->mDuration;
 	ticksPerSecond = animation->mTicksPerSecond;
 
-	bonesAnimKeys = std::make_unique<BoneAnimationKeys[]>(skeleton.nrBones);
-	nrKeys = skeleton.nrBones;
-	
-	for (u32 i = 0; i < animation->mNumChannels; i++)
+	// The channels are kept in the file order: the skeletons find theirs through a remap table
+	nrKeys = animation->mNumChannels;
+	bonesAnimKeys = std::make_unique<BoneAnimationKeys[]>(nrKeys);
+	channelHashes = std::make_unique<u64[]>(nrKeys);
+	for (u32 i = 0; i < nrKeys; i++)
 	{
-		aiNodeAnim* channel = animation->mChannels[i];
-		const char* channelName = channel->mNodeName.C_Str();
+		const aiNodeAnim* channel = animation->mChannels[i];
+		channelHashes[i] = HashString(channel->mNodeName.C_Str());
+		LoadBoneKeys(bonesAnimKeys[i], channel);
+	}
+}
+
+void Animation::Cook(f32 framesPerSecond)
+{
+	if (!bonesAnimKeys)
+		return;
+
+	cooked.Create(*this, framesPerSecond);
+}
+
+ClipCompressionReport Animation::Compress(const ClipCompressionSettings& settings)
+{
+	if (!bonesAnimKeys)
+		return ClipCompressionReport{};
+
+	ClipCompressionReport report = compressed.Create(*this, settings);
+	if (compressed.IsValid())
+	{
+		bonesAnimKeys.reset();
+		cooked = CookedClip{};
+	}
+	return report;
+}
+
+u32 Animation::GetImportFlags()
+{
+	return aiProcess_Triangulate |
+				 aiProcess_LimitBoneWeights |
+				 aiProcess_JoinIdenticalVertices;
+}
+
+u64 Animation::GetLayoutHash() const
+{
+	if (!channelHashes)
+		return 0;
 
-		i32 boneIndex = skeleton.FindBone(channelName);
-		if (boneIndex == -1)
-			continue;
+	return ChannelRemap::HashLayout(channelHashes.get(), nrKeys);
+}
 
-		auto& boneKeys = bonesAnimKeys[boneIndex];
-		LoadBoneKeys(boneKeys, channel);
+void Animation::BindSkeleton(u64 rigHash, const ChannelRemap* remap)
+{
+	for (Binding& binding : _bindings)
+	{
+		if (binding.rigHash == rigHash)
+		{
+			binding.remap = remap;
+			return;
+		}
 	}
+	_bindings.push_back(Binding{ rigHash, remap });
+}
+
+const ChannelRemap* Animation::FindRemap(u64 rigHash) const
+{
+	for (const Binding& binding : _bindings)
+		if (binding.rigHash == rigHash)
+			return binding.remap;
+
+	return nullptr;
+}
+
+vec3f BoneAnimationKeys::SamplePosition(f32 time, u32* cursor) const
+{
+	if (nrPosKeys == 0)
+		return vec3f(0.0f);
+	if (nrPosKeys == 1)
+		return posKeys[0].position;
+
+	u32 i = cursor ? KeyframeSearch::FindWithCursor(posKeys.get(), nrPosKeys, time, *cursor) : KeyframeSearch::FindBinary(posKeys.get(), nrPosKeys, time);
+	const KeyPosition& k0 = posKeys[i];
+	const KeyPosition& k1 = posKeys[i + 1];
+	f32 factor = glm::clamp((time - k0.timeStamp) / (k1.timeStamp - k0.timeStamp), 0.0f, 1.0f);
+	return glm::mix(k0.position, k1.position, factor);
+}
+quat BoneAnimationKeys::SampleRotation(f32 time, u32* cursor) const
+{
+	if (nrRotKeys == 0)
+		return quat(1.0f, 0.0f, 0.0f, 0.0f);
+	if (nrRotKeys == 1)
+		return glm::normalize(rotKeys[0].orientation);
+
+	u32 i = cursor ? KeyframeSearch::FindWithCursor(rotKeys.get(), nrRotKeys, time, *cursor) : KeyframeSearch::FindBinary(rotKeys.get(), nrRotKeys, time);
+	const KeyRotation& k0 = rotKeys[i];
+	const KeyRotation& k1 = rotKeys[i + 1];
+	f32 factor = glm::clamp((time - k0.timeStamp) / (k1.timeStamp - k0.timeStamp), 0.0f, 1.0f);
+	return glm::normalize(glm::slerp(k0.orientation, k1.orientation, factor));
+}
+vec3f BoneAnimationKeys::SampleScale(f32 time, u32* cursor) const
+{
+	if (nrScaleKeys == 0)
+		return vec3f(1.0f);
+	if (nrScaleKeys == 1)
+		return scaleKeys[0].scale;
+
+	u32 i = cursor ? KeyframeSearch::FindWithCursor(scaleKeys.get(), nrScaleKeys, time, *cursor) : KeyframeSearch::FindBinary(scaleKeys.get(), nrScaleKeys, time);
+	const KeyScale& k0 = scaleKeys[i];
+	const KeyScale& k1 = scaleKeys[i + 1];
+	f32 factor = glm::clamp((time - k0.timeStamp) / (k1.timeStamp - k0.timeStamp), 0.0f, 1.0f);
+	return glm::mix(k0.scale, k1.scale, factor);
 }
 
 // ----------------------------------------------------
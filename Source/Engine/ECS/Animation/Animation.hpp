@@ -2,6 +2,9 @@
 
 #include "Core/Core.hpp"
 #include "Core/Math/Base.hpp"
+#include "Engine/ECS/Animation/CookedClip.hpp"
+#include "Engine/ECS/Animation/CompressedClip.hpp"
+#include "Engine/ECS/Animation/ChannelRemap.hpp"
 
 class SkeletalMesh;
 
@@ -26,6 +29,16 @@ struct KeyScale
 };
 struct BoneAnimationKeys
 {
+	/**
+	 * @brief Interpolates the channels at the given time. A channel with no keys returns the identity.
+	 *
+	 * @param cursor Optional key cursor of the channel (see `KeyframeSearch::FindWithCursor`).
+	 * Without it the keys are located with a binary search, as done offline to build the cooked and compressed clips.
+	 */
+	vec3f SamplePosition(f32 time, u32* cursor = nullptr) const;
+	quat SampleRotation(f32 time, u32* cursor = nullptr) const;
+	vec3f SampleScale(f32 time, u32* cursor = nullptr) const;
+
 	UniquePtr<KeyPosition[]> posKeys;
 	u32 nrPosKeys;
 
@@ -36,23 +49,38 @@ struct BoneAnimationKeys
 	u32 nrScaleKeys;
 };
 
+/**
+ * @brief Key indices found by the last lookup on each channel of a bone.
+ * Kept by the animator so that the next lookup resumes from there instead of scanning from the first key.
+ */
+struct BoneKeyCursors
+{
+	u32 pos{};
+	u32 rot{};
+	u32 scale{};
+};
 
-/** @brief Represents an animation associated with a skeleton mesh. */
+
+/**
+ * @brief Represents an animation of a rig, playable by every skeletal mesh sharing the names of its bones.
+ *
+ * The keys are stored by channel, in the order of the source file. The animators find the channel of
+ * each bone of their skeleton in a `ChannelRemap` table, bound once per skeleton (see `BindSkeleton`).
+ * An animation with no channel names (built by hand, bone by bone) is sampled with channel i driving bone i.
+ */
 class Animation
 {
 public:
+	/** @brief Constructs an empty animation, with no keys. */
+	Animation();
+
 	/**
-	 * @brief Constructs an animation for a given skeletal mesh.
+	 * @brief Constructs an animation from a file, with all its channels.
 	 *
-	 * This constructor initializes an animation by associating it with a specific skeletal mesh
-	 * and loading the animation data from the given relative path.
-	 *
-	 * @param skeleton The skeletal mesh to which this animation belongs.
-	 * 
 	 * @param relative The relative path to the animation file inside the skeletal model directory.
 	 * Example: "Mutant/Drunk_Walk/anim.gltf".
 	 */
-	Animation(const SkeletalMesh& skeleton, const fs::path& relative);
+	Animation(const fs::path& relative);
 	~Animation() = default;
 
 	/** @brief Move constructor */
@@ -62,14 +90,72 @@ public:
 	/** @brief Delete copy constructor */
 	Animation(const Animation&) = delete;
 	Animation& operator=(const Animation&) = delete;
+
+	/**
+	 * @brief Builds the cooked layout of this animation, sampled by the animator in place of the keys.
+	 * See `CookedClip`.
+	 *
+	 * @param framesPerSecond The rate at which the keys are resampled.
+	 */
+	void Cook(f32 framesPerSecond);
+
+	bool IsCooked() const { return cooked.IsValid(); }
+
+	/**
+	 * @brief Replaces the keys of this animation with their lossy compressed representation (see `CompressedClip`).
+	 * The full precision keys and the cooked layout are released, so the animation cannot be cooked afterwards.
+	 * Does nothing if the keys were already released.
+	 *
+	 * @return The memory saved and the largest error introduced.
+	 */
+	ClipCompressionReport Compress(const ClipCompressionSettings& settings);
+
+	bool IsCompressed() const { return compressed.IsValid(); }
+
+	/** @return The Assimp post-processing flags used to import the animations. Part of the key of the cooked files (see `AnimationFile`). */
+	static u32 GetImportFlags();
+
+	/** @return The hash of the channel names, in order (see `ChannelRemap::HashLayout`). Zero without channel names. */
+	u64 GetLayoutHash() const;
+
+	/**
+	 * @brief Makes the animation playable by the skeleton, with the given remap table.
+	 * Done once per skeleton when the animations are loaded, before any animator samples the animation.
+	 *
+	 * @param rigHash The rig of the skeleton (see `SkeletalMesh::rigHash`).
+	 * @param remap The table of the skeleton for the channels of this animation. Must outlive the animation.
+	 */
+	void BindSkeleton(u64 rigHash, const ChannelRemap* remap);
+
+	/** @return The remap table bound for the skeleton, or nullptr if the animation was not bound to its rig. */
+	const ChannelRemap* FindRemap(u64 rigHash) const;
 	
+	/** @brief The keys of each channel, `nrKeys` channels. */
 	UniquePtr<BoneAnimationKeys[]> bonesAnimKeys;
 	u32 nrKeys;
 
+	/** @brief The hashed name of the node animated by each channel (see `HashString`). Null for an animation built bone by bone. */
+	UniquePtr<u64[]> channelHashes;
+
+	/** @brief Optional uniformly resampled copy of the keys. Empty unless `Cook()` is called. */
+	CookedClip cooked;
+
+	/** @brief Optional compressed keys. Empty unless `Compress()` is called. */
+	CompressedClip compressed;
+
 	f32 duration;
 	f32 ticksPerSecond;
 	u32 id;
 	
 private:
+	struct Binding
+	{
+		u64 rigHash;
+		const ChannelRemap* remap;
+	};
+
+	/** @brief The skeletons the animation was bound to. A few entries: one per rig using the clip. */
+	Vector<Binding> _bindings;
+
 	void LoadBoneKeys(BoneAnimationKeys& boneKeys, const aiNodeAnim* channel);
 };
\ No newline at end of file
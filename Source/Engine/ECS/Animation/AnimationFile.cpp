@@ -0,0 +1,164 @@
+#include "AnimationFile.hpp"
+
+#include "Core/Hash.hpp"
+#include "Core/Log/Logger.hpp"
+#include "Engine/ECS/Animation/Animation.hpp"
+#include "Engine/Filesystem/MappedFile.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<KeyPosition> && std::is_trivially_copyable_v<KeyRotation> && std::is_trivially_copyable_v<KeyScale>,
+	"The keys are written and read as raw bytes");
+
+namespace AnimationFile
+{
+	u64 HashSource(const fs::path& source)
+	{
+		// The source file and its sibling files with the same name, sorted so that the hash does not depend on the directory order
+		Vector<fs::path> files{ source };
+		std::error_code error;
+		for (const auto& entry : fs::directory_iterator(source.parent_path(), error))
+		{
+			const fs::path& path = entry.path();
+			if (entry.is_regular_file() && path != source && path.stem() == source.stem() && path.extension() != ".anim")
+				files.push_back(path);
+		}
+		std::sort(files.begin() + 1, files.end());
+
+		u64 hash = FNV_OFFSET_BASIS;
+		for (const fs::path& path : files)
+		{
+			String extension = path.extension().string();
+			hash = HashBytes(extension.data(), extension.size(), hash);
+
+			MappedFile file;
+			if (file.Open(path))
+				hash = HashBytes(file.GetData(), file.GetSize(), hash);
+		}
+		return hash;
+	}
+
+	fs::path GetCookedPath(const fs::path& source)
+	{
+		fs::path path = source;
+		return path.replace_extension(".anim");
+	}
+
+	bool Write(const fs::path& path, const Animation& animation, const SourceKey& key)
+	{
+		if (!animation.bonesAnimKeys || !animation.channelHashes)
+			return false;
+
+		Header header{};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.sourceHash = key.sourceHash;
+		header.importFlags = key.importFlags;
+		header.nrChannels = animation.nrKeys;
+		header.duration = animation.duration;
+		header.ticksPerSecond = animation.ticksPerSecond;
+
+		// Written to a temporary file first, so that an interrupted write never leaves a valid header on truncated keys
+		fs::path tmpPath = path;
+		tmpPath += ".tmp";
+		{
+			OStream file(tmpPath, std::ios::binary | std::ios::trunc);
+			if (!file)
+				return false;
+
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(animation.channelHashes.get()), animation.nrKeys * sizeof(u64));
+			for (u32 channel = 0; channel < animation.nrKeys; channel++)
+			{
+				const BoneAnimationKeys& boneKeys = animation.bonesAnimKeys[channel];
+				Array<u32, 3> counts = { boneKeys.nrPosKeys, boneKeys.nrRotKeys, boneKeys.nrScaleKeys };
+				file.write(reinterpret_cast<const char*>(counts.data()), sizeof(counts));
+			}
+			for (u32 channel = 0; channel < animation.nrKeys; channel++)
+			{
+				const BoneAnimationKeys& boneKeys = animation.bonesAnimKeys[channel];
+				file.write(reinterpret_cast<const char*>(boneKeys.posKeys.get()), boneKeys.nrPosKeys * sizeof(KeyPosition));
+				file.write(reinterpret_cast<const char*>(boneKeys.rotKeys.get()), boneKeys.nrRotKeys * sizeof(KeyRotation));
+				file.write(reinterpret_cast<const char*>(boneKeys.scaleKeys.get()), boneKeys.nrScaleKeys * sizeof(KeyScale));
+			}
+			if (!file)
+				return false;
+		}
+
+		std::error_code error;
+		fs::rename(tmpPath, path, error);
+		if (error)
+		{
+			CONSOLE_WARN("Cannot write the cooked animation {}: {}", path.string(), error.message());
+			fs::remove(tmpPath, error);
+			return false;
+		}
+		return true;
+	}
+
+	bool Read(const fs::path& path, Animation& animation, const SourceKey& key)
+	{
+		MappedFile file;
+		if (!file.Open(path) || file.GetSize() < sizeof(Header))
+			return false;
+
+		Header header{};
+		std::memcpy(&header, file.GetData(), sizeof(header));
+		if (header.magic != MAGIC ||
+				header.version != VERSION ||
+				header.sourceHash != key.sourceHash ||
+				header.importFlags != key.importFlags)
+			return false;
+
+		// Validate the size announced by the key counts before touching the keys
+		const u8* data = file.GetData();
+		const u64 hashesOffset = sizeof(Header);
+		const u64 countsOffset = hashesOffset + static_cast<u64>(header.nrChannels) * sizeof(u64);
+		const u64 keysOffset = countsOffset + static_cast<u64>(header.nrChannels) * 3 * sizeof(u32);
+		if (file.GetSize() < keysOffset)
+			return false;
+
+		const u32* counts = reinterpret_cast<const u32*>(data + countsOffset);
+		u64 size = keysOffset;
+		for (u32 channel = 0; channel < header.nrChannels; channel++)
+			size += counts[channel * 3] * sizeof(KeyPosition) + counts[channel * 3 + 1] * sizeof(KeyRotation) + counts[channel * 3 + 2] * sizeof(KeyScale);
+		if (file.GetSize() != size)
+		{
+			CONSOLE_WARN("Cooked animation {} is truncated", path.string());
+			return false;
+		}
+
+		auto channelHashes = std::make_unique<u64[]>(header.nrChannels);
+		std::memcpy(channelHashes.get(), data + hashesOffset, header.nrChannels * sizeof(u64));
+
+		auto bonesAnimKeys = std::make_unique<BoneAnimationKeys[]>(header.nrChannels);
+		u64 offset = keysOffset;
+		for (u32 channel = 0; channel < header.nrChannels; channel++)
+		{
+			BoneAnimationKeys& boneKeys = bonesAnimKeys[channel];
+			boneKeys.nrPosKeys = counts[channel * 3];
+			boneKeys.nrRotKeys = counts[channel * 3 + 1];
+			boneKeys.nrScaleKeys = counts[channel * 3 + 2];
+
+			boneKeys.posKeys = std::make_unique<KeyPosition[]>(boneKeys.nrPosKeys);
+			std::memcpy(boneKeys.posKeys.get(), data + offset, boneKeys.nrPosKeys * sizeof(KeyPosition));
+			offset += boneKeys.nrPosKeys * sizeof(KeyPosition);
+
+			boneKeys.rotKeys = std::make_unique<KeyRotation[]>(boneKeys.nrRotKeys);
+			std::memcpy(boneKeys.rotKeys.get(), data + offset, boneKeys.nrRotKeys * sizeof(KeyRotation));
+			offset += boneKeys.nrRotKeys * sizeof(KeyRotation);
+
+			boneKeys.scaleKeys = std::make_unique<KeyScale[]>(boneKeys.nrScaleKeys);
+			std::memcpy(boneKeys.scaleKeys.get(), data + offset, boneKeys.nrScaleKeys * sizeof(KeyScale));
+			offset += boneKeys.nrScaleKeys * sizeof(KeyScale);
+		}
+
+		animation.bonesAnimKeys = std::move(bonesAnimKeys);
+		animation.channelHashes = std::move(channelHashes);
+		animation.nrKeys = header.nrChannels;
+		animation.duration = header.duration;
+		animation.ticksPerSecond = header.ticksPerSecond;
+		return true;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+class Animation;
+
+/**
+ * @namespace AnimationFile
+ * @brief Cooked binary format of the imported animation keys (".anim"), read back in place of the source file.
+ *
+ * The file is written next to the source the first time a clip is imported, and memory mapped by the
+ * following loads. It starts with a header identifying the import it was written from: the hash of the
+ * source files and the import flags. A file whose header does not match the current import is ignored and
+ * written again. The keys are stored by channel, so the file does not depend on the skeletons playing the clip.
+ *
+ * Layout, in native byte order:
+ * - `Header`
+ * - the hashed node name of each channel, `nrChannels` u64
+ * - the number of position, rotation and scale keys of each channel, `3 * nrChannels` u32
+ * - the keys of each channel: positions (`KeyPosition`), rotations (`KeyRotation`), scales (`KeyScale`)
+ */
+namespace AnimationFile
+{
+	constexpr Array<char, 4> MAGIC = { 'A', 'N', 'I', 'M' };
+
+	/** @brief Incremented each time the layout changes, which invalidates every file written before. */
+	constexpr u32 VERSION = 2;
+
+	/** @brief Identifies the import a file was written from. */
+	struct SourceKey
+	{
+		u64 sourceHash;
+		u32 importFlags;
+	};
+
+	struct Header
+	{
+		Array<char, 4> magic;
+		u32 version;
+		u64 sourceHash;
+		u32 importFlags;
+		u32 nrChannels;
+		f32 duration;
+		f32 ticksPerSecond;
+	};
+
+	/**
+	 * @brief Hashes the content of the source file and of the files it references: the files of the
+	 * same directory with the same name and another extension (e.g. the ".bin" buffers of a glTF file).
+	 */
+	u64 HashSource(const fs::path& source);
+
+	/** @return The path of the cooked file of a source file. E.g. "Drunk_Walk/anim.gltf" -> "Drunk_Walk/anim.anim". */
+	fs::path GetCookedPath(const fs::path& source);
+
+	/**
+	 * @brief Writes the keys of the animation.
+	 *
+	 * @return False if the animation has no keys (compressed) or no channel names, or if the file cannot be written.
+	 */
+	bool Write(const fs::path& path, const Animation& animation, const SourceKey& key);
+
+	/**
+	 * @brief Reads the keys of the animation from a memory mapping of the file.
+	 *
+	 * @return False if the file does not exist, is truncated or does not match the key.
+	 * The animation is left untouched in that case.
+	 */
+	bool Read(const fs::path& path, Animation& animation, const SourceKey& key);
+}
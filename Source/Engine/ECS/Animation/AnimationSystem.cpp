@@ -0,0 +1,204 @@
+#include "AnimationSystem.hpp"
+
+#include "Core/Thread/JobSystem.hpp"
+#include "Engine/ECS/Transform.hpp"
+#include "Engine/ECS/Animation/Animator.hpp"
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+AnimationSystem::AnimationSystem() :
+	_lodSettings{},
+	_cacheSettings{},
+	_gpuEvaluation{ false },
+	_viewPosition{ 0.0f },
+	_tanHalfFovY{ 0.0f },
+	_frameIndex{ 0 },
+	_stats{},
+	_animators{},
+	_cacheIndices{},
+	_cacheEntries{},
+	_cachedAnimators{},
+	_cachePalettes{}
+{
+}
+
+void AnimationSystem::SetViewpoint(const vec3f& position, f32 fovY)
+{
+	_viewPosition = position;
+	_tanHalfFovY = std::tan(glm::radians(fovY) * 0.5f);
+}
+
+void AnimationSystem::Update(entt::registry& registry, f32 dt, JobSystem& jobSystem)
+{
+	_frameIndex++;
+	_stats = Stats{};
+	_animators.clear();
+	_cacheIndices.clear();
+	_cacheEntries.clear();
+	_cachedAnimators.clear();
+
+	const bool useLod = _lodSettings.enabled && _tanHalfFovY > 0.0f;
+	for (auto [entity, animator] : registry.view<Animator>().each())
+	{
+		u32 lod = LOD_FULL_RATE;
+		u32 skippedLeafLevels = 0;
+		if (const Transform* transform = useLod ? registry.try_get<Transform>(entity) : nullptr)
+		{
+			f32 size = CalculateProjectedSize(*transform);
+			if (size < _lodSettings.quarterRateSize)
+				lod = LOD_QUARTER_RATE;
+			else if (size < _lodSettings.halfRateSize)
+				lod = LOD_HALF_RATE;
+			if (size < _lodSettings.skipLeafBonesSize)
+				skippedLeafLevels = _lodSettings.leafBoneLevels;
+		}
+
+		animator.lod = lod;
+		animator.skippedTime += dt;
+		animator.evaluatedOnGpu = false;
+		_stats.nrAnimators[lod]++;
+
+		// The compute shader samples the cooked frames of a single clip, over the whole skeleton
+		if (_gpuEvaluation && animator.IsPlaying() && !animator.IsBlending() && !animator.GetBoneMask())
+		{
+			const Animation* animation = animator.GetAttachedAnimation();
+			if (animation->IsCooked() || !animation->IsCompressed())
+			{
+				animator.StopSharingPalette();
+				animator.AdvanceTime(animator.skippedTime);
+				animator.skippedTime = 0.0f;
+				animator.evaluatedOnGpu = true;
+				_stats.nrUpdated[lod]++;
+				_stats.nrGpuAnimators++;
+				continue;
+			}
+		}
+
+		// A blended pose depends on two playbacks and a weight, a masked pose on the last one: they are never shared
+		if (_cacheSettings.enabled && animator.IsPlaying() && !animator.IsBlending() && !animator.GetBoneMask())
+		{
+			animator.SetSkippedLeafLevels(0);
+			animator.AdvanceTime(animator.skippedTime);
+			animator.skippedTime = 0.0f;
+			_stats.nrUpdated[lod]++;
+			LookUpCache(animator);
+			continue;
+		}
+
+		// The shared palette is overwritten by this update
+		animator.StopSharingPalette();
+		animator.SetSkippedLeafLevels(skippedLeafLevels);
+
+		// A paused animator keeps its palette, and the GPU copy of it
+		if (!animator.IsPlaying())
+		{
+			animator.skippedTime = 0.0f;
+			continue;
+		}
+
+		// Stagger the instances of a level over its interval
+		const u32 interval = 1u << lod;
+		if ((_frameIndex + entt::to_entity(entity)) % interval != 0)
+		{
+			_stats.nrSkippedFrameBones += animator.nrBoneTransforms;
+			continue;
+		}
+
+		_stats.nrUpdated[lod]++;
+		_animators.push_back(&animator);
+	}
+
+	// Palettes of the cache entries: every animator with a cached pose now points to them
+	u64 paletteSize = 0;
+	for (CacheEntry& entry : _cacheEntries)
+	{
+		entry.paletteOffset = paletteSize;
+		paletteSize += entry.animator->nrBoneTransforms;
+	}
+	_cachePalettes.resize(paletteSize);
+	for (const auto& [animator, entryIndex] : _cachedAnimators)
+		animator->SharePalette(&_cachePalettes[_cacheEntries[entryIndex].paletteOffset]);
+
+	// Animators updated on their own first, then the cache entries
+	const u32 nrAnimators = static_cast<u32>(_animators.size());
+	const u32 nrTasks = nrAnimators + static_cast<u32>(_cacheEntries.size());
+	jobSystem.ParallelFor(nrTasks, ANIMATORS_PER_BATCH, [this, nrAnimators](u32 begin, u32 end) {
+		for (u32 i = begin; i < end; i++)
+		{
+			if (i >= nrAnimators)
+			{
+				UpdateCacheEntry(_cacheEntries[i - nrAnimators]);
+				continue;
+			}
+
+			Animator& animator = *_animators[i];
+			animator.UpdateAnimation(animator.skippedTime);
+			animator.skippedTime = 0.0f;
+		}
+	});
+
+	for (const CacheEntry& entry : _cacheEntries)
+		_stats.nrSampledBones += entry.animator->GetNumSampledBones();
+
+	for (const Animator* animator : _animators)
+	{
+		u32 nrSampledBones = animator->GetNumSampledBones();
+		_stats.nrSampledBones += nrSampledBones;
+		if (nrSampledBones > 0)
+			_stats.nrSkippedLeafBones += animator->nrBoneTransforms - nrSampledBones;
+	}
+}
+
+// ----------------------------------------------------
+//										PRIVATE
+// ----------------------------------------------------
+
+u64 AnimationSystem::CacheKeyHash::operator()(const CacheKey& key) const
+{
+	u64 hash = std::hash<const void*>{}(key.skeleton);
+	hash ^= std::hash<const void*>{}(key.animation) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+	hash ^= (static_cast<u64>(key.frame) << 8 | key.lod) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+void AnimationSystem::LookUpCache(Animator& animator)
+{
+	const Animation* animation = animator.GetAttachedAnimation();
+	const f32 ticksPerSecond = animation->ticksPerSecond > 0.0f ? animation->ticksPerSecond : 1.0f;
+	const f32 ticksPerFrame = ticksPerSecond / _cacheSettings.framesPerSecond * static_cast<f32>(1u << animator.lod);
+
+	CacheKey key{};
+	key.skeleton = animator.GetTargetSkeleton()->nodes.get();
+	key.animation = animation;
+	key.frame = static_cast<u32>(animator.currentTime / ticksPerFrame + 0.5f);
+	key.lod = animator.lod;
+
+	_stats.nrCacheLookups++;
+	auto [it, inserted] = _cacheIndices.emplace(key, static_cast<u32>(_cacheEntries.size()));
+	if (inserted)
+		_cacheEntries.push_back(CacheEntry{ &animator, std::min(static_cast<f32>(key.frame) * ticksPerFrame, animation->duration), 0 });
+	else
+		_stats.nrCacheHits++;
+
+	_cachedAnimators.emplace_back(&animator, it->second);
+}
+
+void AnimationSystem::UpdateCacheEntry(const CacheEntry& entry)
+{
+	Animator& animator = *entry.animator;
+	animator.EvaluatePose(entry.time);
+	std::copy(animator.boneTransforms.get(), animator.boneTransforms.get() + animator.nrBoneTransforms, &_cachePalettes[entry.paletteOffset]);
+	animator.SharePalette(&_cachePalettes[entry.paletteOffset]);
+}
+
+f32 AnimationSystem::CalculateProjectedSize(const Transform& transform) const
+{
+	// position and scale are relative to the parent: the world ones come from the world matrix
+	const mat4f& world = transform.GetTransformation();
+	f32 scale = std::max({ glm::length(vec3f(world[0])), glm::length(vec3f(world[1])), glm::length(vec3f(world[2])) });
+	f32 radius = _lodSettings.boundingRadius * scale;
+	f32 distance = std::max(glm::distance(vec3f(world[3]), _viewPosition), 1e-3f);
+	return radius / (distance * _tanHalfFovY);
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+#include <entt/entt.hpp>
+
+class Animation;
+class Animator;
+class JobSystem;
+struct BoneNode;
+class Transform;
+
+/**
+ * @brief Level of detail policy of the animation update, driven by the size of each instance on screen.
+ *
+ * The projected size is the diameter of a sphere around the instance divided by the height of the view
+ * at its distance: 1 when the instance fills the screen vertically.
+ */
+struct AnimationLodSettings
+{
+	bool enabled{ true };
+
+	/** @brief Radius of the sphere assumed around each instance, multiplied by the largest scale of its transform. */
+	f32 boundingRadius{ 1.0f };
+
+	/** @brief Below this projected size the instance is updated every 2nd frame. */
+	f32 halfRateSize{ 0.2f };
+
+	/** @brief Below this projected size the instance is updated every 4th frame. */
+	f32 quarterRateSize{ 0.08f };
+
+	/** @brief Below this projected size the leaf bones are not sampled. Zero never skips them. */
+	f32 skipLeafBonesSize{ 0.1f };
+
+	/** @brief Number of levels from the end of each chain considered leaf bones (see `Animator::SetSkippedLeafLevels`). */
+	u32 leafBoneLevels{ 2 };
+};
+
+/**
+ * @brief Pose cache of the animation update: animators playing the same clip on the same skeleton at the
+ * same quantized time share one evaluated pose.
+ */
+struct AnimationCacheSettings
+{
+	bool enabled{ false };
+
+	/**
+	 * @brief Rate at which the playback time is quantized. Each level of detail halves it,
+	 * so that distant instances are more likely to share a pose.
+	 */
+	f32 framesPerSecond{ 30.0f };
+};
+
+/**
+ * @class AnimationSystem
+ * @brief Animation update stage, run once per frame before rendering.
+ *
+ * Advances every animator of the registry and computes its bone palette, spreading the animators
+ * across the threads of the job system. Animators only read the shared skeletons and animations and
+ * write their own pose, so they are updated independently. The render pass then only uploads
+ * `Animator::boneTransforms`.
+ *
+ * Instances far from the viewpoint are updated at a reduced rate: every 2nd or 4th frame, with the
+ * elapsed time accumulated in between. The frames are staggered by entity so that the cost of a
+ * crowd is spread evenly.
+ *
+ * With the pose cache enabled, the playing animators only advance their time. The distinct
+ * (skeleton, clip, quantized time) keys are evaluated once per frame, and every animator sharing a key
+ * uses the same palette (see `Animator::GetPalette`). The cost then depends on the number of distinct
+ * poses instead of the number of instances. Cached animators are updated every frame, on all bones.
+ * Animators blending two animations or with a bone mask are always updated on their own.
+ *
+ * With the GPU evaluation enabled, the animators playing a single clip only advance their time and are flagged
+ * `Animator::evaluatedOnGpu`: the renderer evaluates their pose in a compute shader (see `GpuAnimationEvaluator`).
+ * They are evaluated every frame, on all bones, and take precedence over the pose cache.
+ */
+class AnimationSystem
+{
+public:
+	/** @brief Number of animators updated by a thread before picking up the next batch. */
+	static constexpr u32 ANIMATORS_PER_BATCH = 4;
+
+	/** @brief Levels of detail. The update interval of a level is 2^level frames. */
+	enum Lod : u32
+	{
+		LOD_FULL_RATE = 0,
+		LOD_HALF_RATE,
+		LOD_QUARTER_RATE,
+		NUM_LODS
+	};
+
+	/** @brief Counters of the last update. */
+	struct Stats
+	{
+		/** @brief Animators in each level of detail. */
+		Array<u32, NUM_LODS> nrAnimators{};
+		/** @brief Animators of each level of detail updated this frame. */
+		Array<u32, NUM_LODS> nrUpdated{};
+		/** @brief Bones sampled this frame, over all the updated animators. */
+		u32 nrSampledBones{};
+		/** @brief Bones of the updated animators not sampled because of the leaf bones skipping. */
+		u32 nrSkippedLeafBones{};
+		/** @brief Bones not sampled because their animator skipped this frame. */
+		u32 nrSkippedFrameBones{};
+		/** @brief Animators that looked up the pose cache. */
+		u32 nrCacheLookups{};
+		/** @brief Lookups that found a pose already evaluated this frame. */
+		u32 nrCacheHits{};
+		/** @brief Animators left to the GPU evaluation. */
+		u32 nrGpuAnimators{};
+
+		f32 GetCacheHitRate() const { return nrCacheLookups ? static_cast<f32>(nrCacheHits) / static_cast<f32>(nrCacheLookups) : 0.0f; }
+	};
+
+	AnimationSystem();
+	~AnimationSystem() = default;
+
+	/**
+	 * @brief Sets the point of view used to measure the size of the instances on screen.
+	 *
+	 * @param position The camera position in world space.
+	 * @param fovY The vertical field of view, in degrees.
+	 */
+	void SetViewpoint(const vec3f& position, f32 fovY);
+
+	void SetLodSettings(const AnimationLodSettings& settings) { _lodSettings = settings; }
+	const AnimationLodSettings& GetLodSettings() const { return _lodSettings; }
+
+	void SetCacheSettings(const AnimationCacheSettings& settings) { _cacheSettings = settings; }
+	const AnimationCacheSettings& GetCacheSettings() const { return _cacheSettings; }
+
+	/** @brief Leaves the pose of the eligible animators to the GPU (see `Animator::evaluatedOnGpu`). */
+	void SetGpuEvaluation(bool enabled) { _gpuEvaluation = enabled; }
+	bool IsGpuEvaluationEnabled() const { return _gpuEvaluation; }
+
+	/**
+	 * @brief Updates all the animators of the registry.
+	 * Animators with no `Transform` are always updated at full rate.
+	 *
+	 * @param registry The registry holding the `Animator` components.
+	 * @param dt The time elapsed since the previous update, in seconds.
+	 * @param jobSystem The job system running the update.
+	 */
+	void Update(entt::registry& registry, f32 dt, JobSystem& jobSystem);
+
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	/** @brief Pose shared by the animators with the same key. */
+	struct CacheKey
+	{
+		const BoneNode* skeleton;
+		const Animation* animation;
+		u32 frame;
+		u32 lod;
+
+		bool operator==(const CacheKey&) const = default;
+	};
+	struct CacheKeyHash
+	{
+		u64 operator()(const CacheKey& key) const;
+	};
+	struct CacheEntry
+	{
+		/** @brief The animator evaluating the pose on behalf of all the others. */
+		Animator* animator;
+		f32 time;
+		u64 paletteOffset;
+	};
+
+	f32 CalculateProjectedSize(const Transform& transform) const;
+	void LookUpCache(Animator& animator);
+	void UpdateCacheEntry(const CacheEntry& entry);
+
+	AnimationLodSettings _lodSettings;
+	AnimationCacheSettings _cacheSettings;
+	bool _gpuEvaluation;
+	vec3f _viewPosition;
+	f32 _tanHalfFovY;
+	u32 _frameIndex;
+	Stats _stats;
+
+	/** @brief The animators to update this frame, gathered so that they can be split into batches. */
+	Vector<Animator*> _animators;
+
+	/** @brief Poses evaluated this frame, and the animators sharing them. */
+	std::unordered_map<CacheKey, u32, CacheKeyHash> _cacheIndices;
+	Vector<CacheEntry> _cacheEntries;
+	Vector<std::pair<Animator*, u32>> _cachedAnimators;
+
+	/** @brief The palettes of the cache entries, kept until the next update since the animators point to them. */
+	Vector<mat4f> _cachePalettes;
+};
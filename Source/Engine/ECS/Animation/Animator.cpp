@@ -1,8 +1,8 @@
 #include "Animator.hpp"
 
 #include "Core/Log/Logger.hpp"
-
-#include <stack>
+#include "Engine/ECS/Animation/KeyframeSearch.hpp"
+#include "Engine/ECS/Animation/PosePool.hpp"
 
 
 // ----------------------------------------------------
@@ -13,14 +13,35 @@ Animator::Animator() :
 	boneTransforms{},
 	nrBoneTransforms{ 0 },
 	currentTime{ 0.f },
+	lod{ 0 },
+	skippedTime{ 0.f },
+	evaluatedOnGpu{ false },
 	_targetSkeleton{ nullptr },
 	_targetAnimation{ nullptr },
-	_playAnimation{ false }
+	_playAnimation{ false },
+	_skippedLeafLevels{ 0 },
+	_nrSampledBones{ 0 },
+	_poseSampled{ false },
+	_poseUpdated{ false },
+	_boneMask{ nullptr },
+	_sharedPalette{ nullptr },
+	_paletteVersion{ 0 },
+	_bounds{},
+	_boundsVersion{ UINT32_MAX },
+	_pose{},
+	_boneChannels{ nullptr },
+	_keyCursors{},
+	_blendAnimation{ nullptr },
+	_blendBoneChannels{ nullptr },
+	_blendTime{ 0.f },
+	_blendWeight{ 0.f },
+	_blendWeightSpeed{ 0.f },
+	_blendKeyCursors{}
 {
 }
 
 
-void Animator::SetTargetSkeleton(SkeletalMesh& target)
+void Animator::SetTargetSkeleton(const SkeletalMesh& target)
 {
 	if (_targetSkeleton)
 		return;
@@ -30,12 +51,76 @@ void Animator::SetTargetSkeleton(SkeletalMesh& target)
 	nrBoneTransforms = target.nrBones;
 	for (u32 i = 0; i < nrBoneTransforms; i++)
 		boneTransforms[i] = mat4f(1.0f);
+	
+	_pose.Create(target.nrBones, target.nrNodes);
+	_paletteVersion++;
+	_keyCursors = std::make_unique<BoneKeyCursors[]>(target.nrBones);
+	_blendKeyCursors = std::make_unique<BoneKeyCursors[]>(target.nrBones);
+	_boneChannels = FindBoneChannels(_targetAnimation);
+	_blendBoneChannels = FindBoneChannels(_blendAnimation);
 }
 void Animator::SetTargetAnimation(const Animation* target)
 {
 	_targetAnimation = target;
+	_boneChannels = FindBoneChannels(target);
 	for (u32 i = 0; i < nrBoneTransforms; i++)
 		boneTransforms[i] = mat4f(1.0f);
+
+	ResetKeyCursors();
+	_poseSampled = false;
+	_poseUpdated = false;
+	_sharedPalette = nullptr;
+	_paletteVersion++;
+	_blendAnimation = nullptr;
+}
+void Animator::CrossFade(const Animation* target, f32 duration)
+{
+	if (!_targetSkeleton || !_targetAnimation || !target || duration <= 0.0f)
+	{
+		SetTargetAnimation(target);
+		return;
+	}
+
+	// The current animation becomes the one fading out, along with its playback
+	_blendAnimation = _targetAnimation;
+	_blendTime = currentTime;
+	_blendWeight = 1.0f;
+	_blendWeightSpeed = -1.0f / duration;
+	_blendBoneChannels = _boneChannels;
+	std::swap(_keyCursors, _blendKeyCursors);
+
+	_targetAnimation = target;
+	_boneChannels = FindBoneChannels(target);
+	currentTime = 0.0f;
+	ResetKeyCursors();
+	_poseSampled = false;
+}
+void Animator::SetBlendAnimation(const Animation* second, f32 weight)
+{
+	if (second != _blendAnimation && _blendKeyCursors)
+	{
+		for (u32 i = 0; i < nrBoneTransforms; i++)
+			_blendKeyCursors[i] = BoneKeyCursors{};
+	}
+
+	_blendAnimation = second;
+	_blendBoneChannels = FindBoneChannels(second);
+	_blendWeight = glm::clamp(weight, 0.0f, 1.0f);
+	_blendWeightSpeed = 0.0f;
+	if (second && _targetAnimation && _targetAnimation->duration > 0.0f)
+		_blendTime = currentTime / _targetAnimation->duration * second->duration;
+	_poseSampled = false;
+}
+void Animator::SetBlendWeight(f32 weight)
+{
+	_blendWeight = glm::clamp(weight, 0.0f, 1.0f);
+	_blendWeightSpeed = 0.0f;
+}
+
+void Animator::SetBoneMask(const BoneMask* mask)
+{
+	assert(!mask || !_targetSkeleton || mask->GetNumNodes() == _targetSkeleton->nrNodes);
+	_boneMask = mask;
 }
 
 void Animator::PlayAnimation()
@@ -49,91 +134,347 @@ void Animator::PauseAnimation()
 void Animator::RestartAnimation()
 {
 	currentTime = 0.0f;
+	ResetKeyCursors();
 }
 void Animator::UpdateAnimation(f32 dt)
 {
-	if (!_playAnimation || !_targetSkeleton || !_targetAnimation)
+	_nrSampledBones = 0;
+	if (!IsPlaying())
+		return;
+
+	AdvanceTime(dt);
+	_sharedPalette = nullptr;
+	SampleAnimation();
+	UpdateBoneTransforms();
+	_paletteVersion++;
+}
+void Animator::AdvanceTime(f32 dt)
+{
+	if (!IsPlaying())
 		return;
 
 	currentTime += _targetAnimation->ticksPerSecond * dt;
 	currentTime = fmod(currentTime, _targetAnimation->duration);
-	UpdateBoneTransform(*_targetSkeleton->rootNode, mat4f(1.0f));
+
+	if (!_blendAnimation)
+		return;
+
+	if (_blendWeightSpeed < 0.0f)
+	{
+		// Crossfade: the animation fading out keeps its own playback until its weight reaches zero
+		_blendWeight += _blendWeightSpeed * dt;
+		if (_blendWeight <= 0.0f)
+		{
+			_blendAnimation = nullptr;
+			_blendWeight = 0.0f;
+			return;
+		}
+		_blendTime = fmod(_blendTime + _blendAnimation->ticksPerSecond * dt, _blendAnimation->duration);
+	}
+	else
+	{
+		_blendTime = currentTime / _targetAnimation->duration * _blendAnimation->duration;
+	}
+}
+void Animator::EvaluatePose(f32 time)
+{
+	_nrSampledBones = 0;
+	if (!_targetSkeleton || !_targetAnimation)
+		return;
+
+	SamplePose(time);
+	UpdatePalette();
+}
+void Animator::SamplePose(f32 time)
+{
+	_nrSampledBones = 0;
+	if (!_targetSkeleton || !_targetAnimation)
+		return;
+
+	f32 playbackTime = currentTime;
+	currentTime = time;
+	SampleAnimation();
+	currentTime = playbackTime;
+}
+void Animator::UpdatePalette()
+{
+	if (!_targetSkeleton)
+		return;
+
+	_sharedPalette = nullptr;
+	UpdateBoneTransforms();
+	_paletteVersion++;
+}
+void Animator::SharePalette(const mat4f* palette)
+{
+	// The shared palette is evaluated again every frame
+	_sharedPalette = palette;
+	_paletteVersion++;
+}
+void Animator::StopSharingPalette()
+{
+	if (!_sharedPalette)
+		return;
+
+	std::copy(_sharedPalette, _sharedPalette + nrBoneTransforms, boneTransforms.get());
+	_sharedPalette = nullptr;
+	_paletteVersion++;
+}
+const AABB& Animator::GetBounds()
+{
+	if (_boundsVersion == _paletteVersion || !_targetSkeleton)
+		return _bounds;
+
+	// Each bone moves its bounds from its local space: palette * inverse offset is the bone transformation
+	const mat4f* palette = GetPalette();
+	const Bone* bones = _targetSkeleton->bones.get();
+	_bounds = AABB{};
+	for (u32 i = 0; i < nrBoneTransforms; i++)
+		if (!bones[i].bounds.IsEmpty())
+			_bounds.Merge(bones[i].bounds.Transformed(palette[i] * bones[i].inverseOffset));
+
+	_boundsVersion = _paletteVersion;
+	return _bounds;
 }
 
 // ---------------------------------------------------- 
 //										PRIVATE														
 // ---------------------------------------------------- 
 
-void Animator::UpdateBoneTransform(const BoneNode& node, const mat4f& parentTransform)
+void Animator::SampleAnimation()
 {
-	std::stack<std::pair<const BoneNode*, mat4f>> stack;
-	stack.push(std::make_pair(&node, parentTransform));
+	if (_blendAnimation)
+	{
+		SampleBlendedAnimation();
+		return;
+	}
 
-	while (!stack.empty())
+	if (_targetAnimation->IsCooked())
 	{
-		auto& [currentNode, currentTransform] = stack.top();
-		stack.pop();
+		const CookedClip& clip = _targetAnimation->cooked;
+		PosePool& pool = PosePool::Get();
+		PosePool::Scope scope(pool);
+		f32* pose = pool.Acquire(clip.GetPoseSize());
+		clip.Sample(currentTime, pose);
+		if (!_boneChannels && clip.GetNumBones() == _pose.nrBones)
+		{
+			clip.ComposeTransforms(pose, _pose.localTransforms);
+		}
+		else
+		{
+			const u32 stride = CookedClip::CalculateStride(_pose.nrBones);
+			f32* bonePose = pool.Acquire(stride * CookedClip::NUM_COMPONENTS);
+			CookedClip::RemapPose(pose, clip.GetNumBones(), clip.GetStride(), _boneChannels, _pose.nrBones, stride, bonePose);
+			CookedClip::ComposeTransforms(bonePose, _pose.nrBones, stride, _pose.localTransforms);
+		}
+		_nrSampledBones = _pose.nrBones;
+		return;
+	}
 
-		i32 boneIndex = currentNode->index;
-		mat4f globalTransformation = currentTransform * currentNode->bindPoseTransform;
-		if (boneIndex != -1)
+	if ((_skippedLeafLevels == 0 && !_boneMask) || !_poseSampled)
+	{
+		for (u32 i = 0; i < _pose.nrBones; i++)
+			InterpolateBone(i);
+		_nrSampledBones = _pose.nrBones;
+		_poseSampled = true;
+		return;
+	}
+
+	// The leaf bones and the bones out of the mask keep the local transformation of their last update
+	_nrSampledBones = 0;
+	const BoneNode* nodes = _targetSkeleton->nodes.get();
+	auto sampleNode = [&](u32 i) {
+		const BoneNode& node = nodes[i];
+		if (node.index != -1 && node.height >= _skippedLeafLevels)
 		{
-			Bone& bone = _targetSkeleton->bones[boneIndex];
-			InterpolateBone(boneIndex);
-			globalTransformation = currentTransform * bone.localTransform;
-			const mat4f& offset = bone.offset;
-			boneTransforms[boneIndex] = globalTransformation * offset;
+			InterpolateBone(node.index);
+			_nrSampledBones++;
 		}
+	};
+
+	if (_boneMask)
+	{
+		for (u32 i : _boneMask->GetSampledNodes())
+			sampleNode(i);
+	}
+	else
+	{
+		for (u32 i = 0; i < _pose.nrNodes; i++)
+			sampleNode(i);
+	}
+}
 
-		for (const auto& child : currentNode->children)
+void Animator::SampleBlendedAnimation()
+{
+	// Both animations are sampled as cooked frames, blended, then composed into the local transformations
+	const u32 stride = CookedClip::CalculateStride(_pose.nrBones);
+	const u32 poseSize = stride * CookedClip::NUM_COMPONENTS;
+	PosePool& pool = PosePool::Get();
+	PosePool::Scope scope(pool);
+	f32* pose = pool.Acquire(poseSize);
+	f32* blendPose = pool.Acquire(poseSize);
+
+	SampleLocalPose(*_targetAnimation, _boneChannels, currentTime, _keyCursors.get(), stride, pose);
+	SampleLocalPose(*_blendAnimation, _blendBoneChannels, _blendTime, _blendKeyCursors.get(), stride, blendPose);
+	CookedClip::BlendPoses(pose, blendPose, _blendWeight, stride, pose);
+	CookedClip::ComposeTransforms(pose, _pose.nrBones, stride, _pose.localTransforms);
+
+	// Every bone is sampled: the leaf bones skipping resumes from the blended pose
+	_nrSampledBones = _pose.nrBones;
+	_poseSampled = true;
+}
+
+void Animator::SampleLocalPose(const Animation& animation, const i32* boneChannels, f32 time, BoneKeyCursors* cursors, u32 stride, f32* pose) const
+{
+	if (animation.IsCooked())
+	{
+		const CookedClip& clip = animation.cooked;
+		if (!boneChannels && clip.GetNumBones() == _pose.nrBones)
 		{
-			stack.push(std::make_pair(&child, globalTransformation));
+			clip.Sample(time, pose);
+			return;
 		}
+
+		// Released with the scope of the caller
+		f32* channelPose = PosePool::Get().Acquire(clip.GetPoseSize());
+		clip.Sample(time, channelPose);
+		CookedClip::RemapPose(channelPose, clip.GetNumBones(), clip.GetStride(), boneChannels, _pose.nrBones, stride, pose);
+		return;
+	}
+
+	for (u32 bone = 0; bone < stride; bone++)
+	{
+		vec3f position(0.0f);
+		quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+		vec3f scale(1.0f);
+		i32 channel = bone < _pose.nrBones ? (boneChannels ? boneChannels[bone] : static_cast<i32>(bone)) : ChannelRemap::NO_CHANNEL;
+		if (channel != ChannelRemap::NO_CHANNEL && static_cast<u32>(channel) < animation.nrKeys)
+		{
+			if (animation.IsCompressed())
+			{
+				animation.compressed.SampleBone(channel, time, cursors[bone], position, rotation, scale);
+			}
+			else
+			{
+				const BoneAnimationKeys& boneKeys = animation.bonesAnimKeys[channel];
+				position = boneKeys.SamplePosition(time, &cursors[bone].pos);
+				rotation = boneKeys.SampleRotation(time, &cursors[bone].rot);
+				scale = boneKeys.SampleScale(time, &cursors[bone].scale);
+			}
+		}
+
+		pose[CookedClip::TX * stride + bone] = position.x;
+		pose[CookedClip::TY * stride + bone] = position.y;
+		pose[CookedClip::TZ * stride + bone] = position.z;
+		pose[CookedClip::RX * stride + bone] = rotation.x;
+		pose[CookedClip::RY * stride + bone] = rotation.y;
+		pose[CookedClip::RZ * stride + bone] = rotation.z;
+		pose[CookedClip::RW * stride + bone] = rotation.w;
+		pose[CookedClip::SX * stride + bone] = scale.x;
+		pose[CookedClip::SY * stride + bone] = scale.y;
+		pose[CookedClip::SZ * stride + bone] = scale.z;
 	}
 }
 
+void Animator::UpdateBoneTransforms()
+{
+	const BoneNode* nodes = _targetSkeleton->nodes.get();
+	const mat4f* localTransforms = _pose.localTransforms;
+	mat4f* modelTransforms = _pose.modelTransforms;
+
+	auto updateNode = [&](u32 i) {
+		const BoneNode& node = nodes[i];
+		i32 boneIndex = node.index;
+		const mat4f& localTransform = boneIndex != -1 ? localTransforms[boneIndex] : node.bindPoseTransform;
+		if (node.parent != -1)
+			modelTransforms[i] = modelTransforms[node.parent] * localTransform;
+		else
+			modelTransforms[i] = localTransform;
+
+		if (boneIndex != -1)
+			boneTransforms[boneIndex] = modelTransforms[i] * node.offset;
+	};
+
+	// Nodes are in depth-first order: the parent transformation is always computed first
+	if (_boneMask && _poseUpdated)
+	{
+		// The nodes above the mask keep their transformation, the nodes below it follow their parent
+		for (u32 i : _boneMask->GetUpdatedNodes())
+			updateNode(i);
+		return;
+	}
+
+	for (u32 i = 0; i < _pose.nrNodes; i++)
+		updateNode(i);
+	_poseUpdated = true;
+}
+
 void Animator::InterpolateBone(u32 boneIndex)
 {
-	const auto& boneKeys = _targetAnimation->bonesAnimKeys[boneIndex];
-	mat4f translation = InterpolateBonePosition(boneKeys);
-	mat4f rotation = InterpolateBoneRotation(boneKeys);
-	mat4f scale = InterpolateBoneScale(boneKeys);
-	Bone& bone = _targetSkeleton->bones[boneIndex];
-	bone.localTransform = translation * rotation * scale;
+	// A bone driven by no channel of the animation keeps the identity, as a channel with no keys
+	i32 channel = _boneChannels ? _boneChannels[boneIndex] : static_cast<i32>(boneIndex);
+	if (channel == ChannelRemap::NO_CHANNEL || static_cast<u32>(channel) >= _targetAnimation->nrKeys)
+	{
+		_pose.localTransforms[boneIndex] = mat4f(1.0f);
+		return;
+	}
+
+	if (_targetAnimation->IsCompressed())
+	{
+		vec3f position;
+		quat rotation;
+		vec3f scale;
+		_targetAnimation->compressed.SampleBone(channel, currentTime, _keyCursors[boneIndex], position, rotation, scale);
+
+		mat3f rotationScale = glm::mat3_cast(rotation);
+		_pose.localTransforms[boneIndex] = mat4f(
+			vec4f(rotationScale[0] * scale.x, 0.0f),
+			vec4f(rotationScale[1] * scale.y, 0.0f),
+			vec4f(rotationScale[2] * scale.z, 0.0f),
+			vec4f(position, 1.0f));
+		return;
+	}
+
+	const auto& boneKeys = _targetAnimation->bonesAnimKeys[channel];
+	BoneKeyCursors& cursors = _keyCursors[boneIndex];
+	mat4f translation = InterpolateBonePosition(boneKeys, cursors.pos);
+	mat4f rotation = InterpolateBoneRotation(boneKeys, cursors.rot);
+	mat4f scale = InterpolateBoneScale(boneKeys, cursors.scale);
+	_pose.localTransforms[boneIndex] = translation * rotation * scale;
 }
-mat4f Animator::InterpolateBonePosition(const BoneAnimationKeys& boneKeys)
+mat4f Animator::InterpolateBonePosition(const BoneAnimationKeys& boneKeys, u32& cursor)
 {
 	if (boneKeys.nrPosKeys == 0)
 		return mat4f(1.0f);
 	if (boneKeys.nrPosKeys == 1)
 		return glm::translate(mat4f(1.0f), boneKeys.posKeys[0].position);
 
-	const auto [currentKey, nextKey] = FindCurrentPositionKey(boneKeys);
+	const auto [currentKey, nextKey] = FindCurrentPositionKey(boneKeys, cursor);
 	f32 scaleFactor = CalculateBlendFactor(currentKey->timeStamp, nextKey->timeStamp);
 	vec3f finalPosition = glm::mix(currentKey->position, nextKey->position, scaleFactor);
 	return glm::translate(mat4f(1.0f), finalPosition);
 }
-mat4f Animator::InterpolateBoneRotation(const BoneAnimationKeys& boneKeys)
+mat4f Animator::InterpolateBoneRotation(const BoneAnimationKeys& boneKeys, u32& cursor)
 {
 	if (boneKeys.nrRotKeys == 0)
 		return mat4f(1.0f);
 	if (boneKeys.nrRotKeys == 1)
 		return glm::mat4_cast(glm::normalize(boneKeys.rotKeys[0].orientation));
 
-	const auto [currentKey, nextKey] = FindCurrentRotationKey(boneKeys);
+	const auto [currentKey, nextKey] = FindCurrentRotationKey(boneKeys, cursor);
 	f32 scaleFactor = CalculateBlendFactor(currentKey->timeStamp, nextKey->timeStamp);
 	quat finalRotation = glm::slerp(currentKey->orientation, nextKey->orientation, scaleFactor);
 	finalRotation = glm::normalize(finalRotation);
 	return glm::mat4_cast(finalRotation);
 }
-mat4f Animator::InterpolateBoneScale(const BoneAnimationKeys& boneKeys)
+mat4f Animator::InterpolateBoneScale(const BoneAnimationKeys& boneKeys, u32& cursor)
 { 
 	if (boneKeys.nrScaleKeys == 0)
 		return mat4f(1.0f);
 	if (boneKeys.nrScaleKeys == 1)
 		return glm::scale(mat4f(1.0f), boneKeys.scaleKeys[0].scale);
 
-	const auto [currentKey, nextKey] = FindCurrentScaleKey(boneKeys);
+	const auto [currentKey, nextKey] = FindCurrentScaleKey(boneKeys, cursor);
 	f32 scaleFactor = CalculateBlendFactor(currentKey->timeStamp, nextKey->timeStamp);
 	vec3f finalScale = glm::mix(currentKey->scale, nextKey->scale, scaleFactor);
 	return glm::scale(mat4f(1.0f), finalScale);
@@ -143,26 +484,42 @@ f32 Animator::CalculateBlendFactor(f32 prevTimestamp, f32 nextTimestamp) const
 {
 	f32 midWayLength = currentTime - prevTimestamp;
 	f32 framesDiff = nextTimestamp - prevTimestamp;
-	return midWayLength / framesDiff;
+	return glm::clamp(midWayLength / framesDiff, 0.0f, 1.0f);
+}
+std::pair<const KeyPosition*, const KeyPosition*> Animator::FindCurrentPositionKey(const BoneAnimationKeys& boneKeys, u32& cursor) const
+{
+	u32 i = KeyframeSearch::FindWithCursor(boneKeys.posKeys.get(), boneKeys.nrPosKeys, currentTime, cursor);
+	return { &boneKeys.posKeys[i], &boneKeys.posKeys[i + 1] };
 }
-std::pair<const KeyPosition*, const KeyPosition*> Animator::FindCurrentPositionKey(const BoneAnimationKeys& boneKeys) const
+std::pair<const KeyRotation*, const KeyRotation*> Animator::FindCurrentRotationKey(const BoneAnimationKeys& boneKeys, u32& cursor) const
 {
-	for (u32 i = 0; i < boneKeys.nrPosKeys - 1; i++)
-		if (currentTime < boneKeys.posKeys[i + 1].timeStamp)
-			return { &boneKeys.posKeys[i], &boneKeys.posKeys[i + 1] };
-	return { nullptr, nullptr };
+	u32 i = KeyframeSearch::FindWithCursor(boneKeys.rotKeys.get(), boneKeys.nrRotKeys, currentTime, cursor);
+	return { &boneKeys.rotKeys[i], &boneKeys.rotKeys[i + 1] };
 }
-std::pair<const KeyRotation*, const KeyRotation*> Animator::FindCurrentRotationKey(const BoneAnimationKeys& boneKeys) const
+std::pair<const KeyScale*, const KeyScale*>	Animator::FindCurrentScaleKey(const BoneAnimationKeys& boneKeys, u32& cursor) const
 {
-	for (u32 i = 0; i < boneKeys.nrRotKeys - 1; i++)
-		if (currentTime < boneKeys.rotKeys[i + 1].timeStamp)
-			return { &boneKeys.rotKeys[i], &boneKeys.rotKeys[i + 1] };
-	return { nullptr, nullptr };
+	u32 i = KeyframeSearch::FindWithCursor(boneKeys.scaleKeys.get(), boneKeys.nrScaleKeys, currentTime, cursor);
+	return { &boneKeys.scaleKeys[i], &boneKeys.scaleKeys[i + 1] };
 }
-std::pair<const KeyScale*, const KeyScale*>	Animator::FindCurrentScaleKey(const BoneAnimationKeys& boneKeys) const
+const i32* Animator::FindBoneChannels(const Animation* animation) const
 {
-	for (u32 i = 0; i < boneKeys.nrScaleKeys - 1; i++)
-		if (currentTime < boneKeys.scaleKeys[i + 1].timeStamp)
-			return { &boneKeys.scaleKeys[i], &boneKeys.scaleKeys[i + 1] };
-	return { nullptr, nullptr };
+	// Animations built bone by bone have no channel names
+	if (!animation || !_targetSkeleton || !animation->channelHashes)
+		return nullptr;
+
+	const ChannelRemap* remap = animation->FindRemap(_targetSkeleton->rigHash);
+	if (!remap)
+	{
+		CONSOLE_WARN("Animation {} is not bound to skeleton {}: its channels are played in bone order", animation->id, _targetSkeleton->id);
+		return nullptr;
+	}
+	return remap->identity ? nullptr : remap->boneChannels.get();
+}
+void Animator::ResetKeyCursors()
+{
+	if (!_keyCursors)
+		return;
+
+	for (u32 i = 0; i < nrBoneTransforms; i++)
+		_keyCursors[i] = BoneKeyCursors{};
 }
\ No newline at end of file
@@ -2,12 +2,23 @@
 
 #include "Core/Core.hpp"
 #include "Core/Math/Base.hpp"
+#include "Core/Math/AABB.hpp"
 #include "Engine/ECS/Skeleton/SkeletalMesh.hpp"
 #include "Engine/ECS/Animation/Animation.hpp"
+#include "Engine/ECS/Animation/Pose.hpp"
+#include "Engine/ECS/Animation/BoneMask.hpp"
 
 /**
  * @class Animator
  * @brief Manages and updates animations for a skeleton mesh.
+ * The skeleton is only read: the sampled transformations are written to the pose owned by the animator.
+ *
+ * A second animation can be blended over the target one, either fading out (`CrossFade`) or with a fixed
+ * weight (`SetBlendAnimation`). The intermediate poses of the blend are taken from the `PosePool` of the
+ * updating thread, so switching or blending clips never allocates.
+ *
+ * The animations are sampled by channel: the animator reads the channel of each bone of its skeleton from
+ * the `ChannelRemap` table bound to the animation, so one clip is shared by all the skeletons of a rig.
  */
 class Animator
 {
@@ -23,34 +34,201 @@ public:
 	Animator(const Animator&) = delete;
 	Animator& operator=(const Animator&) = delete;
 
-	void SetTargetSkeleton(SkeletalMesh& target);
+	void SetTargetSkeleton(const SkeletalMesh& target);
+
+	/** @brief Switches to the target animation immediately. Any blend in progress is stopped. */
 	void SetTargetAnimation(const Animation* target);
 
+	/**
+	 * @brief Fades from the current animation to the target animation.
+	 * The current animation keeps playing while its weight decreases to zero, the target starts from the beginning.
+	 * A crossfade started during another one fades out the current animation only.
+	 * Without a current animation, or with a null duration, equivalent to `SetTargetAnimation`.
+	 *
+	 * @param duration The duration of the transition, in seconds.
+	 */
+	void CrossFade(const Animation* target, f32 duration);
+
+	/**
+	 * @brief Blends a second animation over the target animation with a fixed weight, e.g. walk and run.
+	 * The time of the second animation follows the normalized time of the target, so that the cycles stay in sync.
+	 *
+	 * @param second The second animation, on the same skeleton. Null stops blending.
+	 * @param weight The weight of the second animation: 0 plays the target only, 1 the second animation only.
+	 */
+	void SetBlendAnimation(const Animation* second, f32 weight);
+
+	/** @brief Changes the weight of the second animation. Stops a crossfade in progress at the given weight. */
+	void SetBlendWeight(f32 weight);
+
+	const SkeletalMesh* GetTargetSkeleton() const { return _targetSkeleton; }
 	const Animation* GetAttachedAnimation() const { return _targetAnimation; }
 
+	/** @return The animation blended over the target animation: the second animation of a blend, or the one fading out. */
+	const Animation* GetBlendAnimation() const { return _blendAnimation; }
+
+	/** @return The weight of the blended animation. */
+	f32 GetBlendWeight() const { return _blendWeight; }
+
+	bool IsBlending() const { return _blendAnimation != nullptr; }
+	const Pose& GetPose() const { return _pose; }
+
+	/** @return Whether the animation is playing, with a skeleton and an animation attached. */
+	bool IsPlaying() const { return _playAnimation && _targetSkeleton && _targetAnimation; }
+
+	/** @brief Advances the playback time and evaluates the pose and the bone palette. */
 	void UpdateAnimation(f32 dt);
+
+	/** @brief Advances the playback time only. Does nothing if the animation is not playing. */
+	void AdvanceTime(f32 dt);
+
+	/**
+	 * @brief Evaluates the pose and the bone palette at the given time. The playback time is left unchanged.
+	 * Used to evaluate a pose on behalf of several animators (see `AnimationSystem`).
+	 */
+	void EvaluatePose(f32 time);
+
+	/**
+	 * @brief Samples the local transformations of the pose at the given time, without updating the bone palette.
+	 * The playback time is left unchanged. The first half of `EvaluatePose`.
+	 */
+	void SamplePose(f32 time);
+
+	/**
+	 * @brief Computes the model transformations and the bone palette from the local transformations of the pose,
+	 * e.g. once they have been edited. The second half of `EvaluatePose`.
+	 */
+	void UpdatePalette();
+
 	void PlayAnimation();
 	void PauseAnimation();
 	void RestartAnimation();
 
+	/**
+	 * @brief Stops sampling the bones close to the end of their chain (fingers, face), which keep their last sampled pose.
+	 * Used by the level of detail of the `AnimationSystem` for instances too small on screen.
+	 *
+	 * @param levels Bones whose node is less than `levels` levels above the end of its chain are skipped. Zero samples every bone.
+	 */
+	void SetSkippedLeafLevels(u32 levels) { _skippedLeafLevels = levels; }
+
+	/**
+	 * @brief Evaluates only the nodes of the mask, the others keep the transformations of their last update.
+	 * The first update after the animation is set still evaluates every node. A cooked or blended animation samples
+	 * every bone, as one pass, but still updates the masked nodes only.
+	 *
+	 * @param mask A mask built for the target skeleton, which must stay valid as long as it is set. Null evaluates every node.
+	 */
+	void SetBoneMask(const BoneMask* mask);
+
+	const BoneMask* GetBoneMask() const { return _boneMask; }
+
+	/** @return The number of bones sampled by the last update. */
+	u32 GetNumSampledBones() const { return _nrSampledBones; }
+
+	/**
+	 * @brief Uses the palette evaluated by someone else in place of `boneTransforms` until the next update.
+	 * The palette must stay valid as long as it is shared.
+	 */
+	void SharePalette(const mat4f* palette);
+
+	/** @brief Copies the shared palette, if any, into `boneTransforms` and stops sharing it. */
+	void StopSharingPalette();
+
+	bool IsSharingPalette() const { return _sharedPalette != nullptr; }
+
+	/** @return The bone palette to upload: the shared one if any, otherwise `boneTransforms`. */
+	const mat4f* GetPalette() const { return _sharedPalette ? _sharedPalette : boneTransforms.get(); }
+
+	/**
+	 * @return A number incremented each time the palette returned by `GetPalette()` changes.
+	 * A paused animator, or an animator skipping frames, keeps the same version: its last upload is still valid.
+	 */
+	u32 GetPaletteVersion() const { return _paletteVersion; }
+
+	/**
+	 * @return Conservative bounds of the skinned mesh in model space, for the current palette: the bounds of
+	 * the bones (see `Bone::bounds`) moved by their transformations. No vertex is skinned.
+	 * Computed again only when the palette changed since the last call. Empty when no bone influences a vertex.
+	 */
+	const AABB& GetBounds();
+
 	UniquePtr<mat4f[]> boneTransforms;
 	u32 nrBoneTransforms;
 	f32 currentTime;
+
+	/** @brief Level of detail chosen by the `AnimationSystem` (see `AnimationSystem::Lod`). */
+	u32 lod;
+
+	/** @brief Time elapsed since the last update, while the level of detail skips frames, in seconds. */
+	f32 skippedTime;
+
+	/**
+	 * @brief Whether the pose of this frame is evaluated by the `GpuAnimationEvaluator`, chosen by the `AnimationSystem`.
+	 * Only the playback time is advanced on the CPU: the palette and the bounds are those of the last CPU update.
+	 */
+	bool evaluatedOnGpu;
 	
 private:
-	void UpdateBoneTransform(const BoneNode& node, const mat4f& parentTransform);
+	void SampleAnimation();
+	void SampleBlendedAnimation();
+	void SampleLocalPose(const Animation& animation, const i32* boneChannels, f32 time, BoneKeyCursors* cursors, u32 stride, f32* pose) const;
+	void UpdateBoneTransforms();
 
 	void InterpolateBone(u32 boneIndex);
-	mat4f InterpolateBonePosition(const BoneAnimationKeys& boneKeys);
-	mat4f InterpolateBoneRotation(const BoneAnimationKeys& boneKeys);
-	mat4f InterpolateBoneScale(const BoneAnimationKeys& boneKeys);
+	mat4f InterpolateBonePosition(const BoneAnimationKeys& boneKeys, u32& cursor);
+	mat4f InterpolateBoneRotation(const BoneAnimationKeys& boneKeys, u32& cursor);
+	mat4f InterpolateBoneScale(const BoneAnimationKeys& boneKeys, u32& cursor);
 
 	f32 CalculateBlendFactor(f32 prevTimestamp, f32 nextTimestamp) const;
-	std::pair<const KeyPosition*, const KeyPosition*> FindCurrentPositionKey(const BoneAnimationKeys& boneKeys) const;
-	std::pair<const KeyRotation*, const KeyRotation*> FindCurrentRotationKey(const BoneAnimationKeys& boneKeys) const;
-	std::pair<const KeyScale*,		const KeyScale*>		FindCurrentScaleKey(const BoneAnimationKeys& boneKeys) const;
+	std::pair<const KeyPosition*, const KeyPosition*> FindCurrentPositionKey(const BoneAnimationKeys& boneKeys, u32& cursor) const;
+	std::pair<const KeyRotation*, const KeyRotation*> FindCurrentRotationKey(const BoneAnimationKeys& boneKeys, u32& cursor) const;
+	std::pair<const KeyScale*,		const KeyScale*>		FindCurrentScaleKey(const BoneAnimationKeys& boneKeys, u32& cursor) const;
+
+	void ResetKeyCursors();
+
+	/** @return The channel of each bone of the skeleton in the animation, or null when channel i drives bone i. */
+	const i32* FindBoneChannels(const Animation* animation) const;
 
-	SkeletalMesh* _targetSkeleton;
+	const SkeletalMesh* _targetSkeleton;
 	const Animation* _targetAnimation;
 	bool _playAnimation;
+
+	u32 _skippedLeafLevels;
+	u32 _nrSampledBones;
+
+	/** @brief Whether every bone has been sampled since the animation was set. Required before skipping leaf bones. */
+	bool _poseSampled;
+
+	/** @brief Whether every node has been updated since the animation was set. Required before applying the bone mask. */
+	bool _poseUpdated;
+
+	const BoneMask* _boneMask;
+
+	const mat4f* _sharedPalette;
+	u32 _paletteVersion;
+
+	/** @brief Bounds of the palette of version `_boundsVersion`. */
+	AABB _bounds;
+	u32 _boundsVersion;
+
+	Pose _pose;
+
+	/** @brief Channel of each bone in the target animation (see `FindBoneChannels`). */
+	const i32* _boneChannels;
+
+	/** @brief One set of key cursors per bone, valid for the attached animation only. */
+	UniquePtr<BoneKeyCursors[]> _keyCursors;
+
+	/** @brief Animation blended over the target animation, and its playback. */
+	const Animation* _blendAnimation;
+	const i32* _blendBoneChannels;
+	f32 _blendTime;
+	f32 _blendWeight;
+
+	/** @brief Change of the blend weight per second: negative during a crossfade, zero for a fixed blend. */
+	f32 _blendWeightSpeed;
+
+	/** @brief Key cursors of the blended animation. Swapped with `_keyCursors` when a crossfade starts, so it never allocates. */
+	UniquePtr<BoneKeyCursors[]> _blendKeyCursors;
 };
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+/**
+ * @brief Plays a baked animation on a skeletal mesh, in place of an `Animator`.
+ *
+ * The entities with this component are drawn in one instanced call per skeletal mesh, their palettes fetched
+ * on the GPU from the baked clips of the skeleton (see `BakedClip`). They need no animation work on the CPU,
+ * but cannot blend, nor change their animation other than by switching clips.
+ */
+struct BakedAnimator
+{
+	/** @brief Index of the clip in the animations of the skeleton (see `AnimationsManager::GetSkeletonAnimations`). */
+	u32 clip{ 0 };
+
+	/** @brief Added to the playback time, in seconds: instances playing the same clip with different offsets are out of step. */
+	f32 timeOffset{ 0.0f };
+
+	/** @brief Playback speed. */
+	f32 speed{ 1.0f };
+};
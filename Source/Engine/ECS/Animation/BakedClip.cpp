@@ -0,0 +1,69 @@
+#include "BakedClip.hpp"
+
+#include "Engine/ECS/Animation/Animation.hpp"
+#include "Engine/ECS/Animation/Animator.hpp"
+#include "Engine/ECS/Skeleton/SkeletalMesh.hpp"
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+BakedClip::BakedClip() :
+	_texels{},
+	_nrFrames{ 0 },
+	_nrBones{ 0 },
+	_duration{ 0.0f }
+{
+}
+
+void BakedClip::Create(const SkeletalMesh& skeleton, const Animation& animation, f32 framesPerSecond)
+{
+	// An animation without duration is baked as a single frame
+	const bool looping = animation.duration > 0.0f && animation.ticksPerSecond > 0.0f;
+	_duration = looping ? animation.duration / animation.ticksPerSecond : 1.0f;
+	_nrFrames = looping ? std::max(static_cast<u32>(std::ceil(_duration * framesPerSecond)), 1u) : 1;
+	_nrBones = skeleton.nrBones;
+	_texels = std::make_unique<vec4f[]>(static_cast<u64>(_nrFrames) * GetWidth());
+
+	Animator animator;
+	animator.SetTargetSkeleton(skeleton);
+	animator.SetTargetAnimation(&animation);
+	for (u32 frame = 0; frame < _nrFrames; frame++)
+	{
+		animator.EvaluatePose(static_cast<f32>(frame) / _nrFrames * animation.duration);
+
+		const mat4f* palette = animator.GetPalette();
+		vec4f* texels = _texels.get() + static_cast<u64>(frame) * GetWidth();
+		for (u32 bone = 0; bone < _nrBones; bone++)
+		{
+			const mat4f& m = palette[bone];
+			for (u32 row = 0; row < TEXELS_PER_BONE; row++)
+				texels[bone * TEXELS_PER_BONE + row] = vec4f(m[0][row], m[1][row], m[2][row], m[3][row]);
+		}
+	}
+}
+
+void BakedClip::SamplePalette(f32 seconds, mat4f* palette) const
+{
+	f32 phase = seconds / _duration;
+	phase = (phase - std::floor(phase)) * _nrFrames;
+	const u32 frame0 = std::min(static_cast<u32>(phase), _nrFrames - 1);
+	const u32 frame1 = (frame0 + 1) % _nrFrames;
+	const f32 factor = phase - static_cast<f32>(frame0);
+
+	const vec4f* texels0 = _texels.get() + static_cast<u64>(frame0) * GetWidth();
+	const vec4f* texels1 = _texels.get() + static_cast<u64>(frame1) * GetWidth();
+	for (u32 bone = 0; bone < _nrBones; bone++)
+	{
+		mat4f m(1.0f);
+		for (u32 row = 0; row < TEXELS_PER_BONE; row++)
+		{
+			vec4f r = glm::mix(texels0[bone * TEXELS_PER_BONE + row], texels1[bone * TEXELS_PER_BONE + row], factor);
+			m[0][row] = r.x;
+			m[1][row] = r.y;
+			m[2][row] = r.z;
+			m[3][row] = r.w;
+		}
+		palette[bone] = m;
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+
+class Animation;
+class SkeletalMesh;
+
+/**
+ * @brief Bone palettes of an animation evaluated for a skeleton at a fixed rate, laid out as the rows of a texture.
+ *
+ * Each frame is a row of `GetWidth()` texels: three per bone, holding the first three rows of the bone transformation
+ * (the last row of an affine transformation is always 0, 0, 0, 1). The clip loops: the frames are evenly spaced
+ * over the duration, and the last one blends into the first. The palettes are drawn from a texture on the GPU
+ * (see `BakedAnimationTexture` and "SkeletalAnimBaked.vert"), so the instances need no animator.
+ */
+class BakedClip
+{
+public:
+	/** @brief Number of RGBA texels per bone. */
+	static constexpr u32 TEXELS_PER_BONE = 3;
+
+	BakedClip();
+	~BakedClip() = default;
+
+	/** @brief Move constructor */
+	BakedClip(BakedClip&&) noexcept = default;
+	BakedClip& operator=(BakedClip&&) noexcept = default;
+
+	/** @brief Delete copy constructor */
+	BakedClip(const BakedClip&) = delete;
+	BakedClip& operator=(const BakedClip&) = delete;
+
+	/**
+	 * @brief Evaluates the palette of every frame with an animator.
+	 *
+	 * @param skeleton The skeleton the palettes are evaluated for. The animation must be bound to its rig.
+	 * @param framesPerSecond The sample rate. The frames are rounded up to fill the duration of the animation.
+	 */
+	void Create(const SkeletalMesh& skeleton, const Animation& animation, f32 framesPerSecond);
+
+	/**
+	 * @brief Interpolates the palette at the given time, as done by "SkeletalAnimBaked.vert".
+	 *
+	 * @param seconds The playback time, in seconds. The clip loops.
+	 * @param palette Destination of `GetNumBones()` matrices.
+	 */
+	void SamplePalette(f32 seconds, mat4f* palette) const;
+
+	bool IsValid() const { return _nrFrames != 0; }
+
+	/** @return The texels of all the frames, `GetWidth() * GetNumFrames()` */
+	const vec4f* GetTexels() const { return _texels.get(); }
+
+	/** @return The number of texels of a frame */
+	u32 GetWidth() const { return _nrBones * TEXELS_PER_BONE; }
+
+	u32 GetNumFrames() const { return _nrFrames; }
+	u32 GetNumBones() const { return _nrBones; }
+
+	/** @return The duration of the clip, in seconds */
+	f32 GetDuration() const { return _duration; }
+
+	/** @return The memory used by the frames, in bytes */
+	u64 GetMemorySize() const { return static_cast<u64>(_nrFrames) * GetWidth() * sizeof(vec4f); }
+
+private:
+	UniquePtr<vec4f[]> _texels;
+	u32 _nrFrames;
+	u32 _nrBones;
+	f32 _duration;
+};
@@ -0,0 +1,89 @@
+#include "BoneMask.hpp"
+
+#include "Engine/ECS/Skeleton/SkeletalMesh.hpp"
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+BoneMask::BoneMask() :
+	_enabled{},
+	_sampledNodes{},
+	_updatedNodes{}
+{
+}
+
+void BoneMask::Create(const SkeletalMesh& skeleton)
+{
+	_enabled.assign(skeleton.nrNodes, 0);
+	Update(skeleton);
+}
+
+bool BoneMask::SetSubtree(const SkeletalMesh& skeleton, StringView boneName, bool enabled)
+{
+	assert(_enabled.size() == skeleton.nrNodes);
+
+	const i32 boneIndex = skeleton.FindBone(boneName);
+	if (boneIndex == -1)
+		return false;
+
+	const BoneNode* nodes = skeleton.nodes.get();
+	u32 root = 0;
+	while (root < skeleton.nrNodes && nodes[root].index != boneIndex)
+		root++;
+	if (root == skeleton.nrNodes)
+		return false;
+
+	// Parents come first: a node is in the subtree when its parent is
+	Vector<u8> inSubtree(skeleton.nrNodes, 0);
+	inSubtree[root] = 1;
+	_enabled[root] = enabled;
+	for (u32 i = root + 1; i < skeleton.nrNodes; i++)
+	{
+		const i32 parent = nodes[i].parent;
+		if (parent != -1 && inSubtree[parent])
+		{
+			inSubtree[i] = 1;
+			_enabled[i] = enabled;
+		}
+	}
+
+	Update(skeleton);
+	return true;
+}
+
+void BoneMask::RemoveLeafLevels(const SkeletalMesh& skeleton, u32 levels)
+{
+	assert(_enabled.size() == skeleton.nrNodes);
+
+	const BoneNode* nodes = skeleton.nodes.get();
+	for (u32 i = 0; i < skeleton.nrNodes; i++)
+		if (nodes[i].height < levels)
+			_enabled[i] = 0;
+
+	Update(skeleton);
+}
+
+// ----------------------------------------------------
+//										PRIVATE
+// ----------------------------------------------------
+
+void BoneMask::Update(const SkeletalMesh& skeleton)
+{
+	const BoneNode* nodes = skeleton.nodes.get();
+	_sampledNodes.clear();
+	_updatedNodes.clear();
+
+	// A node is updated when it is masked or below an updated node: parents come first
+	Vector<u8> updated(skeleton.nrNodes, 0);
+	for (u32 i = 0; i < skeleton.nrNodes; i++)
+	{
+		const BoneNode& node = nodes[i];
+		if (_enabled[i] && node.index != -1)
+			_sampledNodes.push_back(i);
+
+		updated[i] = _enabled[i] || (node.parent != -1 && updated[node.parent]);
+		if (updated[i])
+			_updatedNodes.push_back(i);
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+class SkeletalMesh;
+
+/**
+ * @brief Subset of the nodes of a skeleton evaluated by an animator (see `Animator::SetBoneMask`).
+ *
+ * The bones of the masked nodes are sampled, then the masked nodes and every node below them follow their
+ * parent. The other nodes keep the transformations of their last update, e.g. the legs of a character whose
+ * upper body plays another layer, or the whole body of a character that only turns its head.
+ * A mask can also leave out the ends of the chains (fingers, face) for distant characters: those still follow their parent.
+ *
+ * A mask is built for one skeleton and can be shared by every animator of it.
+ */
+class BoneMask
+{
+public:
+	BoneMask();
+	~BoneMask() = default;
+
+	/** @brief Move constructor */
+	BoneMask(BoneMask&&) noexcept = default;
+	BoneMask& operator=(BoneMask&&) noexcept = default;
+
+	/** @brief Delete copy constructor */
+	BoneMask(const BoneMask&) = delete;
+	BoneMask& operator=(const BoneMask&) = delete;
+
+	/** @brief Creates an empty mask for the skeleton: no node is evaluated. */
+	void Create(const SkeletalMesh& skeleton);
+
+	/**
+	 * @brief Adds or removes the node of the bone and every node below it, e.g. "Spine" for the upper body.
+	 *
+	 * @return False if the skeleton has no bone with this name. The mask is left unchanged.
+	 */
+	bool SetSubtree(const SkeletalMesh& skeleton, StringView boneName, bool enabled);
+
+	/**
+	 * @brief Removes the nodes less than `levels` levels above the end of their chain (see `BoneNode::height`),
+	 * as the level of detail of the `AnimationSystem` does. Those still follow their parent.
+	 */
+	void RemoveLeafLevels(const SkeletalMesh& skeleton, u32 levels);
+
+	bool IsNodeEnabled(u32 node) const { return _enabled[node] != 0; }
+
+	/** @return The nodes whose bone is sampled, in hierarchy order */
+	const Vector<u32>& GetSampledNodes() const { return _sampledNodes; }
+
+	/** @return The nodes whose transformation is computed again: the masked ones and every node below them, in hierarchy order */
+	const Vector<u32>& GetUpdatedNodes() const { return _updatedNodes; }
+
+	u32 GetNumNodes() const { return static_cast<u32>(_enabled.size()); }
+
+private:
+	/** @brief Builds the node lists from the enabled flags. */
+	void Update(const SkeletalMesh& skeleton);
+
+	Vector<u8> _enabled;
+	Vector<u32> _sampledNodes;
+	Vector<u32> _updatedNodes;
+};
@@ -0,0 +1,36 @@
+#include "ChannelRemap.hpp"
+
+#include "Core/Hash.hpp"
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+ChannelRemap ChannelRemap::Create(const u64* boneHashes, u32 nrBones, const u64* channelHashes, u32 nrChannels)
+{
+	// The first channel wins if a node is animated twice, as with the former lookup by name
+	UnorderedMap<u64, i32> channels;
+	channels.reserve(nrChannels);
+	for (u32 i = 0; i < nrChannels; i++)
+		channels.emplace(channelHashes[i], static_cast<i32>(i));
+
+	ChannelRemap remap;
+	remap.boneChannels = std::make_unique<i32[]>(nrBones);
+	remap.nrBones = nrBones;
+	remap.identity = true;
+	for (u32 bone = 0; bone < nrBones; bone++)
+	{
+		auto it = channels.find(boneHashes[bone]);
+		i32 channel = it != channels.end() ? it->second : NO_CHANNEL;
+		remap.boneChannels[bone] = channel;
+		remap.nrMappedBones += channel != NO_CHANNEL;
+		remap.identity &= channel == static_cast<i32>(bone);
+	}
+	return remap;
+}
+
+u64 ChannelRemap::HashLayout(const u64* channelHashes, u32 nrChannels)
+{
+	u64 hash = HashBytes(&nrChannels, sizeof(nrChannels));
+	return HashBytes(channelHashes, nrChannels * sizeof(u64), hash);
+}
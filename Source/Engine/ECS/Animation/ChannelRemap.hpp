@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+/**
+ * @brief Channel of an animation driving each bone of a skeleton.
+ *
+ * Animations store their channels in the order of the source file, identified by the hash of the node
+ * they animate, so that one imported clip plays on every skeleton of the rig it was made for. The table
+ * of a skeleton only depends on the channels of the clip: the clips of a rig exported with the same
+ * channels share one table (see `AnimationsManager`).
+ */
+struct ChannelRemap
+{
+	/** @brief Value of the bones driven by no channel. They keep the identity local transformation. */
+	static constexpr i32 NO_CHANNEL = -1;
+
+	/**
+	 * @brief Builds the table from the hashed names of the bones and of the channels.
+	 * Each channel is found in a hash map: the cost is linear in the number of bones and channels.
+	 */
+	static ChannelRemap Create(const u64* boneHashes, u32 nrBones, const u64* channelHashes, u32 nrChannels);
+
+	/** @brief Hashes the channel names, in order. Clips with the same layout share their remap tables. */
+	static u64 HashLayout(const u64* channelHashes, u32 nrChannels);
+
+	/** @return The channel driving the bone, or NO_CHANNEL */
+	i32 GetChannel(u32 bone) const { return boneChannels[bone]; }
+
+	/** @brief `nrBones` channel indices. */
+	UniquePtr<i32[]> boneChannels;
+	u32 nrBones{};
+
+	/** @brief Number of bones driven by a channel. */
+	u32 nrMappedBones{};
+
+	/** @brief Whether channel i drives bone i, for every bone: the clip can be sampled without the table. */
+	bool identity{};
+};
@@ -0,0 +1,365 @@
+#include "CompressedClip.hpp"
+
+#include "Core/Log/Logger.hpp"
+#include "Core/Math/Ext.hpp"
+#include "Engine/ECS/Animation/Animation.hpp"
+#include "Engine/ECS/Animation/KeyframeSearch.hpp"
+
+/** @brief Largest value of the three smallest components of a unit quaternion: 1 / sqrt(2). */
+static constexpr f32 SMALLEST_THREE_RANGE = 0.70710678f;
+static constexpr u32 QUAT_COMPONENT_MAX = 0x7FFF;
+static constexpr u32 VEC3_COMPONENT_MAX = 0xFFFF;
+
+/** @brief Longest segment between two kept keys, in frames: bounds the cost of the reduction of long tracks. */
+static constexpr u32 MAX_SEGMENT_FRAMES = 256;
+
+static u16 QuantizeUnit(f32 value, u32 maxValue)
+{
+	return static_cast<u16>(std::lround(glm::clamp(value, 0.0f, 1.0f) * static_cast<f32>(maxValue)));
+}
+
+static void PackVec3(const vec3f& v, const vec3f& rangeMin, const vec3f& rangeExtent, u16 value[3])
+{
+	for (i32 i = 0; i < 3; i++)
+		value[i] = rangeExtent[i] > 0.0f ? QuantizeUnit((v[i] - rangeMin[i]) / rangeExtent[i], VEC3_COMPONENT_MAX) : 0;
+}
+static vec3f UnpackVec3(const u16 value[3], const vec3f& rangeMin, const vec3f& rangeExtent)
+{
+	constexpr f32 scale = 1.0f / static_cast<f32>(VEC3_COMPONENT_MAX);
+	return rangeMin + rangeExtent * vec3f(value[0] * scale, value[1] * scale, value[2] * scale);
+}
+
+/**
+ * @brief Smallest-three packing: the index of the largest component goes in the top bits of the
+ * first two values, the other three components are stored on 15 bits each.
+ */
+static void PackQuat(const quat& q, u16 value[3])
+{
+	const f32 components[4] = { q.x, q.y, q.z, q.w };
+	u32 largest = 0;
+	for (u32 i = 1; i < 4; i++)
+		if (std::abs(components[i]) > std::abs(components[largest]))
+			largest = i;
+
+	// q and -q are the same rotation: flip the sign so that the dropped component is positive
+	f32 sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+	u16 packed[3]{};
+	for (u32 i = 0, j = 0; i < 4; i++)
+	{
+		if (i == largest)
+			continue;
+		f32 normalized = (components[i] * sign / SMALLEST_THREE_RANGE) * 0.5f + 0.5f;
+		packed[j++] = QuantizeUnit(normalized, QUAT_COMPONENT_MAX);
+	}
+	value[0] = static_cast<u16>(packed[0] | ((largest >> 1) << 15));
+	value[1] = static_cast<u16>(packed[1] | ((largest & 1) << 15));
+	value[2] = packed[2];
+}
+static quat UnpackQuat(const u16 value[3])
+{
+	constexpr f32 scale = 1.0f / static_cast<f32>(QUAT_COMPONENT_MAX);
+	const u32 largest = ((value[0] >> 15) << 1) | (value[1] >> 15);
+	const f32 smallest[3] = {
+		((value[0] & QUAT_COMPONENT_MAX) * scale * 2.0f - 1.0f) * SMALLEST_THREE_RANGE,
+		((value[1] & QUAT_COMPONENT_MAX) * scale * 2.0f - 1.0f) * SMALLEST_THREE_RANGE,
+		((value[2] & QUAT_COMPONENT_MAX) * scale * 2.0f - 1.0f) * SMALLEST_THREE_RANGE
+	};
+
+	f32 components[4]{};
+	f32 sumSquares = 0.0f;
+	for (u32 i = 0, j = 0; i < 4; i++)
+	{
+		if (i == largest)
+			continue;
+		components[i] = smallest[j++];
+		sumSquares += components[i] * components[i];
+	}
+	components[largest] = std::sqrt(std::max(1.0f - sumSquares, 0.0f));
+	return quat(components[3], components[0], components[1], components[2]);
+}
+
+/** @brief Normalized lerp along the shortest path. */
+static quat Nlerp(const quat& q0, quat q1, f32 alpha)
+{
+	if (glm::dot(q0, q1) < 0.0f)
+		q1 = -q1;
+	return glm::normalize(q0 * (1.0f - alpha) + q1 * alpha);
+}
+
+/**
+ * @brief Greedy error-bounded key reduction.
+ *
+ * Extends the current segment as long as interpolating the decoded keys at its ends reproduces every
+ * frame in between within the tolerance, then starts a new segment from the last frame that fit.
+ * Segments are at most `MAX_SEGMENT_FRAMES` long, so that each frame is checked a bounded number of times.
+ * A track that stays within the tolerance of its first key keeps that key only.
+ *
+ * @param exact The full precision values, one per frame.
+ * @param decoded The quantized values, one per frame.
+ * @param keptFrames Destination of the frames that keep their key.
+ * @return The largest error of the reduced track over all frames.
+ */
+template<typename T, typename LerpFunc, typename ErrorFunc>
+static f32 ReduceKeys(const Vector<T>& exact,
+											const Vector<T>& decoded,
+											f32 tolerance,
+											LerpFunc&& lerp,
+											ErrorFunc&& error,
+											Vector<u32>& keptFrames)
+{
+	const u32 nrFrames = static_cast<u32>(exact.size());
+	keptFrames.clear();
+	keptFrames.push_back(0);
+
+	f32 constantError = 0.0f;
+	for (u32 frame = 0; frame < nrFrames; frame++)
+		constantError = std::max(constantError, error(decoded[0], exact[frame]));
+	if (constantError <= tolerance || nrFrames == 1)
+		return constantError;
+
+	auto SegmentError = [&](u32 start, u32 end) {
+		f32 maxError = 0.0f;
+		for (u32 frame = start; frame <= end; frame++)
+		{
+			f32 alpha = static_cast<f32>(frame - start) / static_cast<f32>(end - start);
+			maxError = std::max(maxError, error(lerp(decoded[start], decoded[end], alpha), exact[frame]));
+		}
+		return maxError;
+	};
+
+	u32 start = 0;
+	for (u32 end = 2; end < nrFrames; end++)
+	{
+		if (end - start > MAX_SEGMENT_FRAMES || SegmentError(start, end) > tolerance)
+		{
+			start = end - 1;
+			keptFrames.push_back(start);
+		}
+	}
+	keptFrames.push_back(nrFrames - 1);
+
+	f32 maxError = 0.0f;
+	for (u64 i = 0; i + 1 < keptFrames.size(); i++)
+		maxError = std::max(maxError, SegmentError(keptFrames[i], keptFrames[i + 1]));
+	return maxError;
+}
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+CompressedClip::CompressedClip() :
+	_trackIndices{},
+	_tracks{},
+	_keys{},
+	_nrTracks{ 0 },
+	_nrKeys{ 0 },
+	_nrBones{ 0 },
+	_framesPerTick{ 0.0f }
+{
+}
+
+ClipCompressionReport CompressedClip::Create(const Animation& animation, const ClipCompressionSettings& settings)
+{
+	ClipCompressionReport report{};
+
+	f32 ticksPerSecond = animation.ticksPerSecond > 0.0f ? animation.ticksPerSecond : 1.0f;
+	f32 framesPerTick = settings.framesPerSecond / ticksPerSecond;
+	u32 nrFrames = static_cast<u32>(std::ceil(animation.duration * framesPerTick)) + 1;
+	if (nrFrames > std::numeric_limits<u16>::max() + 1u)
+	{
+		CONSOLE_WARN("Animation {} is too long to be compressed at {} frames per second", animation.id, settings.framesPerSecond);
+		return report;
+	}
+
+	const u32 nrBones = animation.nrKeys;
+	if (static_cast<u64>(nrBones) * NUM_CHANNELS >= NO_TRACK)
+	{
+		CONSOLE_WARN("Animation {} has too many channels to be compressed: {}", animation.id, nrBones);
+		return report;
+	}
+
+	const f32 tolerance = settings.maxPositionError;
+	const f32 distance = settings.virtualVertexDistance;
+
+	auto PositionError = [](const vec3f& a, const vec3f& b) {
+		return glm::length(a - b);
+	};
+	// Displacement of a vertex at `distance` from the bone: the chord of the angle between the rotations, 2 * sin(angle / 2).
+	// Taken from the vector part of the rotation from b to a: through the dot product, 1 - cos(angle / 2) is below the
+	// precision of a float for the errors of interest, and the square root of the difference amplifies the rounding
+	auto RotationError = [distance](const quat& a, const quat& b) {
+		const quat delta = glm::conjugate(b) * a;
+		return 2.0f * distance * glm::length(vec3f(delta.x, delta.y, delta.z));
+	};
+	auto ScaleError = [distance](const vec3f& a, const vec3f& b) {
+		return distance * glm::length(a - b);
+	};
+	auto LerpVec3 = [](const vec3f& a, const vec3f& b, f32 alpha) {
+		return glm::mix(a, b, alpha);
+	};
+
+	auto trackIndices = std::make_unique<u16[]>(static_cast<u64>(nrBones) * NUM_CHANNELS);
+	Vector<Track> tracks;
+	Vector<PackedKey> keys;
+	Vector<PackedKey> packed(nrFrames);
+	Vector<vec3f> exactVec3(nrFrames);
+	Vector<vec3f> decodedVec3(nrFrames);
+	Vector<quat> exactQuat(nrFrames);
+	Vector<quat> decodedQuat(nrFrames);
+	Vector<u32> keptFrames;
+	keptFrames.reserve(nrFrames);
+
+	auto FrameTime = [&](u32 frame) {
+		return std::min(static_cast<f32>(frame) / framesPerTick, animation.duration);
+	};
+	static constexpr const char* CHANNEL_NAMES[NUM_CHANNELS] = { "position", "rotation", "scale" };
+
+	// A track that stays within the budget of the value sampled with no keys is not stored at all
+	auto DropTrack = [&](u32 bone, Channel channel, const auto& exact, const auto& defaultValue, auto&& errorFunc) {
+		f32 trackError = 0.0f;
+		for (u32 frame = 0; frame < nrFrames; frame++)
+		{
+			trackError = std::max(trackError, errorFunc(defaultValue, exact[frame]));
+			if (trackError > tolerance)
+				return false;
+		}
+
+		trackIndices[static_cast<u64>(bone) * NUM_CHANNELS + channel] = NO_TRACK;
+		report.maxError = std::max(report.maxError, trackError);
+		report.nrTracks++;
+		report.nrDroppedTracks++;
+		report.nrResampledKeys += nrFrames;
+		return true;
+	};
+	auto EmitTrack = [&](u32 bone, Channel channel, Track& track, f32 trackError) {
+		trackIndices[static_cast<u64>(bone) * NUM_CHANNELS + channel] = static_cast<u16>(tracks.size());
+		track.firstKey = static_cast<u32>(keys.size());
+		track.nrKeys = static_cast<u32>(keptFrames.size());
+		for (u32 frame : keptFrames)
+		{
+			PackedKey& key = keys.emplace_back(packed[frame]);
+			key.timeStamp = static_cast<u16>(frame);
+		}
+
+		// The quantization alone exceeds the budget, e.g. a position range too wide for 16 bits: every key is kept
+		if (trackError > tolerance)
+		{
+			CONSOLE_WARN("Animation {}: the {} track of bone {} exceeds the error budget after quantization ({:.6f} > {:.6f})",
+				animation.id, CHANNEL_NAMES[channel], bone, trackError, tolerance);
+			report.nrTracksOverBudget++;
+		}
+
+		report.maxError = std::max(report.maxError, trackError);
+		report.nrTracks++;
+		report.nrConstantTracks += track.nrKeys == 1;
+		report.nrResampledKeys += nrFrames;
+		tracks.push_back(track);
+	};
+	auto CompressVec3 = [&](u32 bone, Channel channel, const vec3f& defaultValue, auto&& errorFunc) {
+		if (DropTrack(bone, channel, exactVec3, defaultValue, errorFunc))
+			return;
+
+		Track track{};
+		vec3f rangeMin = exactVec3[0];
+		vec3f rangeMax = exactVec3[0];
+		for (const vec3f& v : exactVec3)
+		{
+			rangeMin = glm::min(rangeMin, v);
+			rangeMax = glm::max(rangeMax, v);
+		}
+		track.rangeMin = rangeMin;
+		track.rangeExtent = rangeMax - rangeMin;
+		for (u32 frame = 0; frame < nrFrames; frame++)
+		{
+			PackVec3(exactVec3[frame], track.rangeMin, track.rangeExtent, packed[frame].value);
+			decodedVec3[frame] = UnpackVec3(packed[frame].value, track.rangeMin, track.rangeExtent);
+		}
+		EmitTrack(bone, channel, track, ReduceKeys(exactVec3, decodedVec3, tolerance, LerpVec3, errorFunc, keptFrames));
+	};
+
+	for (u32 bone = 0; bone < nrBones; bone++)
+	{
+		const BoneAnimationKeys& boneKeys = animation.bonesAnimKeys[bone];
+		report.rawSize += sizeof(BoneAnimationKeys) +
+			boneKeys.nrPosKeys * sizeof(KeyPosition) +
+			boneKeys.nrRotKeys * sizeof(KeyRotation) +
+			boneKeys.nrScaleKeys * sizeof(KeyScale);
+
+		for (u32 frame = 0; frame < nrFrames; frame++)
+			exactVec3[frame] = boneKeys.SamplePosition(FrameTime(frame));
+		CompressVec3(bone, POSITION, DEFAULT_POSITION, PositionError);
+
+		for (u32 frame = 0; frame < nrFrames; frame++)
+			exactQuat[frame] = boneKeys.SampleRotation(FrameTime(frame));
+		if (!DropTrack(bone, ROTATION, exactQuat, DEFAULT_ROTATION, RotationError))
+		{
+			for (u32 frame = 0; frame < nrFrames; frame++)
+			{
+				PackQuat(exactQuat[frame], packed[frame].value);
+				decodedQuat[frame] = UnpackQuat(packed[frame].value);
+			}
+			Track track{};
+			EmitTrack(bone, ROTATION, track, ReduceKeys(exactQuat, decodedQuat, tolerance, Nlerp, RotationError, keptFrames));
+		}
+
+		for (u32 frame = 0; frame < nrFrames; frame++)
+			exactVec3[frame] = boneKeys.SampleScale(FrameTime(frame));
+		CompressVec3(bone, SCALE, DEFAULT_SCALE, ScaleError);
+	}
+
+	_trackIndices = std::move(trackIndices);
+	_nrTracks = static_cast<u32>(tracks.size());
+	_tracks = std::make_unique<Track[]>(_nrTracks);
+	std::copy(tracks.begin(), tracks.end(), _tracks.get());
+	_nrKeys = static_cast<u32>(keys.size());
+	_keys = std::make_unique<PackedKey[]>(_nrKeys);
+	std::copy(keys.begin(), keys.end(), _keys.get());
+	_nrBones = nrBones;
+	_framesPerTick = framesPerTick;
+
+	report.nrKeys = _nrKeys;
+	report.compressedSize = GetMemorySize();
+	return report;
+}
+
+void CompressedClip::SampleBone(u32 bone, f32 time, BoneKeyCursors& cursors, vec3f& position, quat& rotation, vec3f& scale) const
+{
+	const f32 frame = std::max(time * _framesPerTick, 0.0f);
+	const u16* boneTracks = &_trackIndices[static_cast<u64>(bone) * NUM_CHANNELS];
+	position = boneTracks[POSITION] != NO_TRACK ? SampleVec3(_tracks[boneTracks[POSITION]], frame, cursors.pos) : DEFAULT_POSITION;
+	rotation = boneTracks[ROTATION] != NO_TRACK ? SampleQuat(_tracks[boneTracks[ROTATION]], frame, cursors.rot) : DEFAULT_ROTATION;
+	scale = boneTracks[SCALE] != NO_TRACK ? SampleVec3(_tracks[boneTracks[SCALE]], frame, cursors.scale) : DEFAULT_SCALE;
+}
+
+// ----------------------------------------------------
+//										PRIVATE
+// ----------------------------------------------------
+
+vec3f CompressedClip::SampleVec3(const Track& track, f32 frame, u32& cursor) const
+{
+	const PackedKey* keys = &_keys[track.firstKey];
+	if (track.nrKeys == 1)
+		return UnpackVec3(keys[0].value, track.rangeMin, track.rangeExtent);
+
+	u32 i = KeyframeSearch::FindWithCursor(keys, track.nrKeys, frame, cursor);
+	const PackedKey& k0 = keys[i];
+	const PackedKey& k1 = keys[i + 1];
+	f32 alpha = glm::clamp((frame - k0.timeStamp) / static_cast<f32>(k1.timeStamp - k0.timeStamp), 0.0f, 1.0f);
+	return glm::mix(
+		UnpackVec3(k0.value, track.rangeMin, track.rangeExtent),
+		UnpackVec3(k1.value, track.rangeMin, track.rangeExtent),
+		alpha);
+}
+quat CompressedClip::SampleQuat(const Track& track, f32 frame, u32& cursor) const
+{
+	const PackedKey* keys = &_keys[track.firstKey];
+	if (track.nrKeys == 1)
+		return UnpackQuat(keys[0].value);
+
+	u32 i = KeyframeSearch::FindWithCursor(keys, track.nrKeys, frame, cursor);
+	const PackedKey& k0 = keys[i];
+	const PackedKey& k1 = keys[i + 1];
+	f32 alpha = glm::clamp((frame - k0.timeStamp) / static_cast<f32>(k1.timeStamp - k0.timeStamp), 0.0f, 1.0f);
+	return Nlerp(UnpackQuat(k0.value), UnpackQuat(k1.value), alpha);
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+
+class Animation;
+struct BoneKeyCursors;
+
+/** @brief Parameters of the lossy compression of an animation clip. */
+struct ClipCompressionSettings
+{
+	/** @brief Rate of the uniform grid the keys are resampled on before the reduction. */
+	f32 framesPerSecond{ 30.0f };
+
+	/** @brief Maximum error allowed on each track, measured as a position error in bone space. */
+	f32 maxPositionError{ 0.001f };
+
+	/**
+	 * @brief Distance from the bone of the virtual vertex used to turn rotation and scale errors
+	 * into position errors. Roughly the size of the skinned geometry around a bone.
+	 */
+	f32 virtualVertexDistance{ 1.0f };
+};
+
+/** @brief Result of the compression of a clip. */
+struct ClipCompressionReport
+{
+	/** @brief Memory used by the full precision keys and the channels of each bone, in bytes. */
+	u64 rawSize{};
+	/** @brief Memory used by the compressed clip: track indices, tracks and packed keys, in bytes (see `GetMemorySize`). */
+	u64 compressedSize{};
+	/** @brief Largest position error measured on the resampled frames, all tracks included. */
+	f32 maxError{};
+	u32 nrTracks{};
+	/** @brief Tracks whose error exceeds the budget because of the quantization alone: each one is logged. */
+	u32 nrTracksOverBudget{};
+	u32 nrConstantTracks{};
+	/** @brief Tracks not stored: they stay within the budget of the value sampled with no keys, e.g. a unit scale. */
+	u32 nrDroppedTracks{};
+	u32 nrResampledKeys{};
+	u32 nrKeys{};
+
+	f32 GetRatio() const { return compressedSize ? static_cast<f32>(rawSize) / static_cast<f32>(compressedSize) : 0.0f; }
+};
+
+/**
+ * @brief Lossy compressed representation of an animation clip, decompressed by the sampler.
+ *
+ * Every channel (position, rotation, scale) of every bone is a track. The keys of a track are
+ * resampled on a uniform grid, quantized, then reduced: a key is removed when interpolating its
+ * neighbours stays within the error budget.
+ * - Rotations use the smallest-three packing: the largest component is dropped and rebuilt from the
+ *   unit length, the other three are stored on 15 bits.
+ * - Positions and scales are quantized on 16 bits against the range of their own track.
+ * - Constant tracks keep a single key.
+ * - Tracks that stay at the value sampled with no keys (zero position, identity rotation, unit scale) are not
+ *   stored: their index is `NO_TRACK`.
+ *
+ * Each channel of each bone takes a 2-byte track index, each stored track 32 bytes, and each key 8 bytes:
+ * the frame index on the grid and three 16-bit values.
+ */
+class CompressedClip
+{
+public:
+	/** @brief Packed key: frame index on the resampling grid, and three quantized components. */
+	struct PackedKey
+	{
+		u16 timeStamp;
+		u16 value[3];
+	};
+
+	/** @brief Range of the keys of a track, in the shared key array. */
+	struct Track
+	{
+		/** @brief Quantization range of position and scale tracks. Unused by rotation tracks. */
+		vec3f rangeMin;
+		vec3f rangeExtent;
+		u32 firstKey;
+		u32 nrKeys;
+	};
+
+	enum Channel : u32
+	{
+		POSITION = 0,
+		ROTATION,
+		SCALE,
+		NUM_CHANNELS
+	};
+
+	/** @brief Index of a channel whose track is not stored: sampled as the default value of the channel. */
+	static constexpr u16 NO_TRACK = 0xFFFF;
+
+	/** @brief The values of a channel with no keys, as sampled by `BoneAnimationKeys`. */
+	static constexpr vec3f DEFAULT_POSITION{ 0.0f, 0.0f, 0.0f };
+	static constexpr quat DEFAULT_ROTATION{ 1.0f, 0.0f, 0.0f, 0.0f };
+	static constexpr vec3f DEFAULT_SCALE{ 1.0f, 1.0f, 1.0f };
+
+	CompressedClip();
+	~CompressedClip() = default;
+
+	/** @brief Move constructor */
+	CompressedClip(CompressedClip&&) noexcept = default;
+	CompressedClip& operator=(CompressedClip&&) noexcept = default;
+
+	/** @brief Delete copy constructor */
+	CompressedClip(const CompressedClip&) = delete;
+	CompressedClip& operator=(const CompressedClip&) = delete;
+
+	/**
+	 * @brief Compresses the keys of the animation.
+	 *
+	 * @return The sizes and the largest error measured against the full precision keys.
+	 */
+	ClipCompressionReport Create(const Animation& animation, const ClipCompressionSettings& settings);
+
+	/**
+	 * @brief Decompresses the channels of a bone at the given time.
+	 *
+	 * @param bone The bone index.
+	 * @param time The time in ticks, as `Animator::currentTime`.
+	 * @param cursors Key cursors of the bone, updated by the lookup (see `KeyframeSearch::FindWithCursor`).
+	 */
+	void SampleBone(u32 bone, f32 time, BoneKeyCursors& cursors, vec3f& position, quat& rotation, vec3f& scale) const;
+
+	bool IsValid() const { return _nrBones != 0; }
+
+	u32 GetNumBones() const { return _nrBones; }
+
+	/** @return The memory used by the track indices, the tracks and the keys, in bytes */
+	u64 GetMemorySize() const
+	{
+		return static_cast<u64>(_nrBones) * NUM_CHANNELS * sizeof(u16) + static_cast<u64>(_nrTracks) * sizeof(Track) + static_cast<u64>(_nrKeys) * sizeof(PackedKey);
+	}
+
+private:
+	vec3f SampleVec3(const Track& track, f32 frame, u32& cursor) const;
+	quat SampleQuat(const Track& track, f32 frame, u32& cursor) const;
+
+	/** @brief The index of the track of each channel of each bone in `_tracks`, or `NO_TRACK` */
+	UniquePtr<u16[]> _trackIndices;
+	UniquePtr<Track[]> _tracks;
+	UniquePtr<PackedKey[]> _keys;
+	u32 _nrTracks;
+	u32 _nrKeys;
+	u32 _nrBones;
+	f32 _framesPerTick;
+};
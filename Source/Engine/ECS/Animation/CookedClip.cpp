@@ -0,0 +1,312 @@
+#include "CookedClip.hpp"
+
+#include "Core/Math/Ext.hpp"
+#include "Engine/ECS/Animation/Animation.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+CookedClip::CookedClip() :
+	_frames{},
+	_nrFrames{ 0 },
+	_nrBones{ 0 },
+	_stride{ 0 },
+	_framesPerTick{ 0.0f }
+{
+}
+
+void CookedClip::Create(const Animation& animation, f32 framesPerSecond)
+{
+	f32 ticksPerSecond = animation.ticksPerSecond > 0.0f ? animation.ticksPerSecond : 1.0f;
+	_framesPerTick = framesPerSecond / ticksPerSecond;
+	_nrFrames = static_cast<u32>(std::ceil(animation.duration * _framesPerTick)) + 1;
+	_nrBones = animation.nrKeys;
+	_stride = CalculateStride(_nrBones);
+
+	const u32 poseSize = GetPoseSize();
+	_frames = std::make_unique<f32[]>(static_cast<u64>(_nrFrames) * poseSize);
+
+	for (u32 frame = 0; frame < _nrFrames; frame++)
+	{
+		f32 time = std::min(static_cast<f32>(frame) / _framesPerTick, animation.duration);
+		f32* dst = &_frames[static_cast<u64>(frame) * poseSize];
+		const f32* prev = frame > 0 ? dst - poseSize : nullptr;
+
+		for (u32 bone = 0; bone < _stride; bone++)
+		{
+			vec3f position(0.0f);
+			quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+			vec3f scale(1.0f);
+			if (bone < _nrBones)
+			{
+				const BoneAnimationKeys& boneKeys = animation.bonesAnimKeys[bone];
+				position = boneKeys.SamplePosition(time);
+				rotation = boneKeys.SampleRotation(time);
+				scale = boneKeys.SampleScale(time);
+			}
+
+			// Keep the rotation in the hemisphere of the previous frame so that nlerp takes the shortest path
+			if (prev)
+			{
+				f32 dot = rotation.x * prev[RX * _stride + bone] +
+									rotation.y * prev[RY * _stride + bone] +
+									rotation.z * prev[RZ * _stride + bone] +
+									rotation.w * prev[RW * _stride + bone];
+				if (dot < 0.0f)
+					rotation = -rotation;
+			}
+
+			dst[TX * _stride + bone] = position.x;
+			dst[TY * _stride + bone] = position.y;
+			dst[TZ * _stride + bone] = position.z;
+			dst[RX * _stride + bone] = rotation.x;
+			dst[RY * _stride + bone] = rotation.y;
+			dst[RZ * _stride + bone] = rotation.z;
+			dst[RW * _stride + bone] = rotation.w;
+			dst[SX * _stride + bone] = scale.x;
+			dst[SY * _stride + bone] = scale.y;
+			dst[SZ * _stride + bone] = scale.z;
+		}
+	}
+}
+
+void CookedClip::Sample(f32 time, f32* pose) const
+{
+	f32 frame = std::max(time * _framesPerTick, 0.0f);
+	u32 f0 = std::min(static_cast<u32>(frame), _nrFrames - 1);
+	u32 f1 = std::min(f0 + 1, _nrFrames - 1);
+	f32 alpha = glm::clamp(frame - static_cast<f32>(f0), 0.0f, 1.0f);
+
+	const u32 poseSize = GetPoseSize();
+	const f32* frame0 = &_frames[static_cast<u64>(f0) * poseSize];
+	const f32* frame1 = &_frames[static_cast<u64>(f1) * poseSize];
+	f32* rx = pose + RX * _stride;
+	f32* ry = pose + RY * _stride;
+	f32* rz = pose + RZ * _stride;
+	f32* rw = pose + RW * _stride;
+
+#if defined(__AVX2__)
+	// Lerp every component of every bone in one pass
+	const __m256 a = _mm256_set1_ps(alpha);
+	for (u32 i = 0; i < poseSize; i += SIMD_WIDTH)
+	{
+		__m256 v0 = _mm256_loadu_ps(frame0 + i);
+		__m256 v1 = _mm256_loadu_ps(frame1 + i);
+		_mm256_storeu_ps(pose + i, _mm256_fmadd_ps(_mm256_sub_ps(v1, v0), a, v0));
+	}
+
+	// Normalize the rotations
+	const __m256 one = _mm256_set1_ps(1.0f);
+	for (u32 i = 0; i < _stride; i += SIMD_WIDTH)
+	{
+		__m256 x = _mm256_loadu_ps(rx + i);
+		__m256 y = _mm256_loadu_ps(ry + i);
+		__m256 z = _mm256_loadu_ps(rz + i);
+		__m256 w = _mm256_loadu_ps(rw + i);
+		__m256 len2 = _mm256_mul_ps(x, x);
+		len2 = _mm256_fmadd_ps(y, y, len2);
+		len2 = _mm256_fmadd_ps(z, z, len2);
+		len2 = _mm256_fmadd_ps(w, w, len2);
+		__m256 invLen = _mm256_div_ps(one, _mm256_sqrt_ps(len2));
+		_mm256_storeu_ps(rx + i, _mm256_mul_ps(x, invLen));
+		_mm256_storeu_ps(ry + i, _mm256_mul_ps(y, invLen));
+		_mm256_storeu_ps(rz + i, _mm256_mul_ps(z, invLen));
+		_mm256_storeu_ps(rw + i, _mm256_mul_ps(w, invLen));
+	}
+#else
+	for (u32 i = 0; i < poseSize; i++)
+		pose[i] = frame0[i] + (frame1[i] - frame0[i]) * alpha;
+
+	for (u32 i = 0; i < _stride; i++)
+	{
+		f32 invLen = 1.0f / std::sqrt(rx[i] * rx[i] + ry[i] * ry[i] + rz[i] * rz[i] + rw[i] * rw[i]);
+		rx[i] *= invLen;
+		ry[i] *= invLen;
+		rz[i] *= invLen;
+		rw[i] *= invLen;
+	}
+#endif
+}
+
+void CookedClip::ComposeTransforms(const f32* pose, mat4f* transforms) const
+{
+	ComposeTransforms(pose, _nrBones, _stride, transforms);
+}
+
+void CookedClip::ComposeTransforms(const f32* pose, u32 nrBones, u32 stride, mat4f* transforms)
+{
+	const f32* tx = pose + TX * stride;
+	const f32* ty = pose + TY * stride;
+	const f32* tz = pose + TZ * stride;
+	const f32* rx = pose + RX * stride;
+	const f32* ry = pose + RY * stride;
+	const f32* rz = pose + RZ * stride;
+	const f32* rw = pose + RW * stride;
+	const f32* sx = pose + SX * stride;
+	const f32* sy = pose + SY * stride;
+	const f32* sz = pose + SZ * stride;
+
+#if defined(__AVX2__)
+	// The 9 rotation-scale entries of 8 bones, scattered into the matrices afterwards
+	alignas(32) f32 m[9][SIMD_WIDTH];
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 two = _mm256_set1_ps(2.0f);
+	for (u32 base = 0; base < nrBones; base += SIMD_WIDTH)
+	{
+		__m256 x = _mm256_loadu_ps(rx + base);
+		__m256 y = _mm256_loadu_ps(ry + base);
+		__m256 z = _mm256_loadu_ps(rz + base);
+		__m256 w = _mm256_loadu_ps(rw + base);
+		__m256 x2 = _mm256_mul_ps(x, two);
+		__m256 y2 = _mm256_mul_ps(y, two);
+		__m256 z2 = _mm256_mul_ps(z, two);
+		__m256 xx = _mm256_mul_ps(x, x2);
+		__m256 yy = _mm256_mul_ps(y, y2);
+		__m256 zz = _mm256_mul_ps(z, z2);
+		__m256 xy = _mm256_mul_ps(x, y2);
+		__m256 xz = _mm256_mul_ps(x, z2);
+		__m256 yz = _mm256_mul_ps(y, z2);
+		__m256 wx = _mm256_mul_ps(w, x2);
+		__m256 wy = _mm256_mul_ps(w, y2);
+		__m256 wz = _mm256_mul_ps(w, z2);
+		__m256 scaleX = _mm256_loadu_ps(sx + base);
+		__m256 scaleY = _mm256_loadu_ps(sy + base);
+		__m256 scaleZ = _mm256_loadu_ps(sz + base);
+
+		_mm256_store_ps(m[0], _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), scaleX));
+		_mm256_store_ps(m[1], _mm256_mul_ps(_mm256_add_ps(xy, wz), scaleX));
+		_mm256_store_ps(m[2], _mm256_mul_ps(_mm256_sub_ps(xz, wy), scaleX));
+		_mm256_store_ps(m[3], _mm256_mul_ps(_mm256_sub_ps(xy, wz), scaleY));
+		_mm256_store_ps(m[4], _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), scaleY));
+		_mm256_store_ps(m[5], _mm256_mul_ps(_mm256_add_ps(yz, wx), scaleY));
+		_mm256_store_ps(m[6], _mm256_mul_ps(_mm256_add_ps(xz, wy), scaleZ));
+		_mm256_store_ps(m[7], _mm256_mul_ps(_mm256_sub_ps(yz, wx), scaleZ));
+		_mm256_store_ps(m[8], _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), scaleZ));
+
+		u32 count = std::min(SIMD_WIDTH, nrBones - base);
+		for (u32 j = 0; j < count; j++)
+		{
+			u32 bone = base + j;
+			transforms[bone] = mat4f(
+				m[0][j], m[1][j], m[2][j], 0.0f,
+				m[3][j], m[4][j], m[5][j], 0.0f,
+				m[6][j], m[7][j], m[8][j], 0.0f,
+				tx[bone], ty[bone], tz[bone], 1.0f);
+		}
+	}
+#else
+	for (u32 bone = 0; bone < nrBones; bone++)
+	{
+		mat3f rotation = glm::mat3_cast(quat(rw[bone], rx[bone], ry[bone], rz[bone]));
+		transforms[bone] = mat4f(
+			vec4f(rotation[0] * sx[bone], 0.0f),
+			vec4f(rotation[1] * sy[bone], 0.0f),
+			vec4f(rotation[2] * sz[bone], 0.0f),
+			vec4f(tx[bone], ty[bone], tz[bone], 1.0f));
+	}
+#endif
+}
+
+void CookedClip::BlendPoses(const f32* from, const f32* to, f32 weight, u32 stride, f32* pose)
+{
+	const u32 poseSize = stride * NUM_COMPONENTS;
+	const u32 rotationBegin = RX * stride;
+	const u32 rotationEnd = SX * stride;
+
+#if defined(__AVX2__)
+	// Translations and scales
+	const __m256 w = _mm256_set1_ps(weight);
+	for (u32 i = 0; i < poseSize; i += SIMD_WIDTH)
+	{
+		if (i == rotationBegin)
+			i = rotationEnd;
+		__m256 v0 = _mm256_loadu_ps(from + i);
+		__m256 v1 = _mm256_loadu_ps(to + i);
+		_mm256_storeu_ps(pose + i, _mm256_fmadd_ps(_mm256_sub_ps(v1, v0), w, v0));
+	}
+
+	// Rotations: flip the target into the hemisphere of the source, then nlerp
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	const __m256 one = _mm256_set1_ps(1.0f);
+	for (u32 i = 0; i < stride; i += SIMD_WIDTH)
+	{
+		__m256 ax = _mm256_loadu_ps(from + RX * stride + i);
+		__m256 ay = _mm256_loadu_ps(from + RY * stride + i);
+		__m256 az = _mm256_loadu_ps(from + RZ * stride + i);
+		__m256 aw = _mm256_loadu_ps(from + RW * stride + i);
+		__m256 bx = _mm256_loadu_ps(to + RX * stride + i);
+		__m256 by = _mm256_loadu_ps(to + RY * stride + i);
+		__m256 bz = _mm256_loadu_ps(to + RZ * stride + i);
+		__m256 bw = _mm256_loadu_ps(to + RW * stride + i);
+
+		__m256 dot = _mm256_mul_ps(ax, bx);
+		dot = _mm256_fmadd_ps(ay, by, dot);
+		dot = _mm256_fmadd_ps(az, bz, dot);
+		dot = _mm256_fmadd_ps(aw, bw, dot);
+		__m256 sign = _mm256_and_ps(dot, signMask);
+		bx = _mm256_xor_ps(bx, sign);
+		by = _mm256_xor_ps(by, sign);
+		bz = _mm256_xor_ps(bz, sign);
+		bw = _mm256_xor_ps(bw, sign);
+
+		__m256 x = _mm256_fmadd_ps(_mm256_sub_ps(bx, ax), w, ax);
+		__m256 y = _mm256_fmadd_ps(_mm256_sub_ps(by, ay), w, ay);
+		__m256 z = _mm256_fmadd_ps(_mm256_sub_ps(bz, az), w, az);
+		__m256 q = _mm256_fmadd_ps(_mm256_sub_ps(bw, aw), w, aw);
+		__m256 len2 = _mm256_mul_ps(x, x);
+		len2 = _mm256_fmadd_ps(y, y, len2);
+		len2 = _mm256_fmadd_ps(z, z, len2);
+		len2 = _mm256_fmadd_ps(q, q, len2);
+		__m256 invLen = _mm256_div_ps(one, _mm256_sqrt_ps(len2));
+		_mm256_storeu_ps(pose + RX * stride + i, _mm256_mul_ps(x, invLen));
+		_mm256_storeu_ps(pose + RY * stride + i, _mm256_mul_ps(y, invLen));
+		_mm256_storeu_ps(pose + RZ * stride + i, _mm256_mul_ps(z, invLen));
+		_mm256_storeu_ps(pose + RW * stride + i, _mm256_mul_ps(q, invLen));
+	}
+#else
+	for (u32 i = 0; i < poseSize; i++)
+	{
+		if (i == rotationBegin)
+			i = rotationEnd;
+		pose[i] = from[i] + (to[i] - from[i]) * weight;
+	}
+
+	for (u32 i = 0; i < stride; i++)
+	{
+		quat a(from[RW * stride + i], from[RX * stride + i], from[RY * stride + i], from[RZ * stride + i]);
+		quat b(to[RW * stride + i], to[RX * stride + i], to[RY * stride + i], to[RZ * stride + i]);
+		if (glm::dot(a, b) < 0.0f)
+			b = -b;
+
+		quat q = glm::normalize(a + (b - a) * weight);
+		pose[RX * stride + i] = q.x;
+		pose[RY * stride + i] = q.y;
+		pose[RZ * stride + i] = q.z;
+		pose[RW * stride + i] = q.w;
+	}
+#endif
+}
+
+void CookedClip::RemapPose(const f32* channelPose, u32 nrChannels, u32 channelStride, const i32* boneChannels, u32 nrBones, u32 stride, f32* pose)
+{
+	static constexpr Array<f32, NUM_COMPONENTS> identity = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+
+	for (u32 bone = 0; bone < stride; bone++)
+	{
+		i32 channel = bone < nrBones ? (boneChannels ? boneChannels[bone] : static_cast<i32>(bone)) : -1;
+		if (channel < 0 || static_cast<u32>(channel) >= nrChannels)
+		{
+			for (u32 component = 0; component < NUM_COMPONENTS; component++)
+				pose[component * stride + bone] = identity[component];
+			continue;
+		}
+
+		for (u32 component = 0; component < NUM_COMPONENTS; component++)
+			pose[component * stride + bone] = channelPose[component * channelStride + channel];
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+
+class Animation;
+
+/**
+ * @brief Animation clip uniformly resampled and stored as structure of arrays.
+ *
+ * Each frame stores the channels of all bones contiguously, one array per component:
+ * [tx][ty][tz][rx][ry][rz][rw][sx][sy][sz], each array holding `GetStride()` values.
+ * The stride is the number of bones rounded up to the SIMD width, padding bones hold the identity transform.
+ *
+ * Sampling blends two consecutive frames for all bones in one pass (lerp for translations and scales,
+ * nlerp for rotations). Rotations are stored in the same hemisphere as the previous frame
+ * so that nlerp never takes the long path.
+ */
+class CookedClip
+{
+public:
+	/** @brief Number of float arrays per frame: translation (3), rotation (4), scale (3). */
+	static constexpr u32 NUM_COMPONENTS = 10;
+
+	/** @brief Number of bones processed per SIMD iteration. */
+	static constexpr u32 SIMD_WIDTH = 8;
+
+	/** @brief Index of the array of each component in a frame. */
+	enum Component : u32
+	{
+		TX = 0, TY, TZ,
+		RX, RY, RZ, RW,
+		SX, SY, SZ
+	};
+
+	CookedClip();
+	~CookedClip() = default;
+
+	/** @brief Move constructor */
+	CookedClip(CookedClip&&) noexcept = default;
+	CookedClip& operator=(CookedClip&&) noexcept = default;
+
+	/** @brief Delete copy constructor */
+	CookedClip(const CookedClip&) = delete;
+	CookedClip& operator=(const CookedClip&) = delete;
+
+	/**
+	 * @brief Resamples the keys of the animation at a fixed rate.
+	 *
+	 * @param animation The source animation. Its keys are left untouched.
+	 * @param framesPerSecond The sample rate of the cooked clip.
+	 */
+	void Create(const Animation& animation, f32 framesPerSecond);
+
+	/**
+	 * @brief Samples all bones at the given time.
+	 *
+	 * @param time The time in ticks, as `Animator::currentTime`.
+	 * @param pose Destination of `GetPoseSize()` floats, laid out as a single frame.
+	 */
+	void Sample(f32 time, f32* pose) const;
+
+	/**
+	 * @brief Composes the local transformation matrix (translation * rotation * scale) of each bone
+	 * from a pose returned by `Sample()`.
+	 *
+	 * @param pose The sampled pose.
+	 * @param transforms Destination of `nrBones` matrices.
+	 */
+	void ComposeTransforms(const f32* pose, mat4f* transforms) const;
+
+	/**
+	 * @brief Composes the local transformation matrices from any pose laid out as a cooked frame.
+	 *
+	 * @param pose The pose, `NUM_COMPONENTS` arrays of `stride` floats.
+	 * @param nrBones The number of bones of the pose.
+	 * @param stride The stride of the pose (see `CalculateStride`).
+	 * @param transforms Destination of `nrBones` matrices.
+	 */
+	static void ComposeTransforms(const f32* pose, u32 nrBones, u32 stride, mat4f* transforms);
+
+	/**
+	 * @brief Blends two poses laid out as a cooked frame: lerp for translations and scales,
+	 * nlerp along the shortest path for rotations.
+	 *
+	 * @param weight Weight of `to`: 0 returns `from`, 1 returns `to`.
+	 * @param pose Destination of the blended pose. Can be `from` or `to`.
+	 */
+	static void BlendPoses(const f32* from, const f32* to, f32 weight, u32 stride, f32* pose);
+
+	/**
+	 * @brief Reorders a pose sampled by channel into a pose by bone (see `ChannelRemap`).
+	 * The bones driven by no channel, and the padding bones, get the identity transform.
+	 *
+	 * @param channelPose The pose of the clip, `nrChannels` channels laid out with `channelStride`.
+	 * @param boneChannels The channel of each bone, or null when channel i drives bone i.
+	 * @param pose Destination of the pose by bone, laid out with `stride` (at least `nrBones`).
+	 */
+	static void RemapPose(const f32* channelPose, u32 nrChannels, u32 channelStride, const i32* boneChannels, u32 nrBones, u32 stride, f32* pose);
+
+	/** @return The stride of a pose of `nrBones` bones: the number of bones rounded up to the SIMD width. */
+	static constexpr u32 CalculateStride(u32 nrBones) { return (nrBones + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH; }
+
+	bool IsValid() const { return _nrFrames != 0; }
+
+	u32 GetStride() const { return _stride; }
+	u32 GetPoseSize() const { return _stride * NUM_COMPONENTS; }
+	u32 GetNumFrames() const { return _nrFrames; }
+	u32 GetNumBones() const { return _nrBones; }
+	f32 GetFramesPerTick() const { return _framesPerTick; }
+
+	/** @return The resampled frames, `GetNumFrames()` poses of `GetPoseSize()` floats */
+	const f32* GetFrames() const { return _frames.get(); }
+
+	/** @return The memory used by the resampled frames, in bytes */
+	u64 GetMemorySize() const { return static_cast<u64>(_nrFrames) * GetPoseSize() * sizeof(f32); }
+
+private:
+	UniquePtr<f32[]> _frames;
+	u32 _nrFrames;
+	u32 _nrBones;
+	u32 _stride;
+	f32 _framesPerTick;
+};
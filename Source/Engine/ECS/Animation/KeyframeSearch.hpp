@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+#include <algorithm>
+
+/**
+ * @namespace KeyframeSearch
+ * @brief Lookup of the pair of keys surrounding a given time in an array of keys sorted by timestamp.
+ *
+ * The key type must expose a `timeStamp` member and the array must hold at least two keys.
+ * Each function returns the index `i` such that keys[i] and keys[i + 1] surround the time,
+ * clamped to the range [0, nrKeys - 2].
+ */
+namespace KeyframeSearch
+{
+	/** @brief Maximum number of keys a cursor can step forward before falling back to the binary search. */
+	constexpr u32 MAX_CURSOR_STEPS = 4;
+
+	/** @brief Scans the keys starting from the first one. O(n), kept as reference. */
+	template<typename Key>
+	u32 FindLinear(const Key* keys, u32 nrKeys, f32 time)
+	{
+		for (u32 i = 0; i < nrKeys - 1; i++)
+			if (time < keys[i + 1].timeStamp)
+				return i;
+		return nrKeys - 2;
+	}
+
+	/** @brief Binary search over the key timestamps. O(log n) */
+	template<typename Key>
+	u32 FindBinary(const Key* keys, u32 nrKeys, f32 time)
+	{
+		const Key* it = std::upper_bound(keys + 1, keys + nrKeys - 1, time, [](f32 t, const Key& key) {
+			return t < key.timeStamp;
+		});
+		return static_cast<u32>(it - keys) - 1;
+	}
+
+	/**
+	 * @brief Resumes the search from the index found by the previous lookup on the same channel.
+	 *
+	 * While the playback moves forward the cursor is either still valid or a few keys behind,
+	 * so the lookup is amortized O(1). After a seek, a loop or a restart the cursor is ahead
+	 * of the time and the lookup falls back to the binary search.
+	 *
+	 * @param cursor The index returned by the previous lookup. It is updated with the new result.
+	 */
+	template<typename Key>
+	u32 FindWithCursor(const Key* keys, u32 nrKeys, f32 time, u32& cursor)
+	{
+		u32 i = cursor;
+		if (i < nrKeys - 1 && (i == 0 || keys[i].timeStamp <= time))
+		{
+			u32 last = std::min(i + MAX_CURSOR_STEPS, nrKeys - 2);
+			for (; i <= last; i++)
+				if (time < keys[i + 1].timeStamp)
+					return cursor = i;
+		}
+		return cursor = FindBinary(keys, nrKeys, time);
+	}
+}
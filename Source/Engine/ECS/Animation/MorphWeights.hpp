@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+/**
+ * @brief The weights of the morph targets of a skeletal mesh (see `SkeletalMesh::morphTargets`).
+ *
+ * Added with the `SkeletalMesh` when it has morph targets, with the default weight of each target.
+ * A zero weight leaves the target out: an entity with every weight at zero is drawn with no morph work.
+ */
+struct MorphWeights
+{
+	/** @brief The weight of each target, in the order of `MorphTargetSet::GetTarget`. */
+	Vector<f32> weights;
+};
@@ -0,0 +1,31 @@
+#include "Pose.hpp"
+
+static_assert(sizeof(mat4f) % Pose::CACHE_LINE_SIZE == 0, "A pose matrix must fill whole cache lines");
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+Pose::Pose() :
+	localTransforms{ nullptr },
+	modelTransforms{ nullptr },
+	nrBones{ 0 },
+	nrNodes{ 0 },
+	_storage{}
+{
+}
+
+void Pose::Create(u32 numBones, u32 numNodes)
+{
+	const u64 count = static_cast<u64>(numBones) + numNodes;
+	void* memory = ::operator new[](count * sizeof(mat4f), std::align_val_t{ CACHE_LINE_SIZE });
+	mat4f* transforms = static_cast<mat4f*>(memory);
+	for (u64 i = 0; i < count; i++)
+		new (&transforms[i]) mat4f(1.0f);
+
+	_storage.reset(transforms);
+	localTransforms = transforms;
+	modelTransforms = transforms + numBones;
+	nrBones = numBones;
+	nrNodes = numNodes;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+
+/**
+ * @brief Transformations of one animated instance of a skeleton.
+ *
+ * The skeleton (`SkeletalMesh::bones`, `SkeletalMesh::nodes`) is immutable and shared by every instance
+ * of the same model, while each animator owns its pose. Instances of the same model can therefore be
+ * evaluated independently, on different threads.
+ *
+ * Both arrays live in a single allocation aligned to a cache line. Since a matrix is exactly one
+ * cache line, two poses never share a cache line.
+ */
+class Pose
+{
+public:
+	static constexpr u64 CACHE_LINE_SIZE = 64;
+
+	Pose();
+	~Pose() = default;
+
+	/** @brief Move constructor */
+	Pose(Pose&&) noexcept = default;
+	Pose& operator=(Pose&&) noexcept = default;
+
+	/** @brief Delete copy constructor */
+	Pose(const Pose&) = delete;
+	Pose& operator=(const Pose&) = delete;
+
+	/** @brief Allocates the pose of a skeleton. All the transformations are initialized to identity. */
+	void Create(u32 numBones, u32 numNodes);
+
+	bool IsValid() const { return _storage != nullptr; }
+
+	/** @brief Transformation of each bone relative to its parent node, indexed as `SkeletalMesh::bones`. */
+	mat4f* localTransforms;
+
+	/** @brief Model space transformation of each node of the hierarchy, indexed as `SkeletalMesh::nodes`. */
+	mat4f* modelTransforms;
+
+	u32 nrBones;
+	u32 nrNodes;
+
+private:
+	struct AlignedDeleter
+	{
+		void operator()(mat4f* ptr) const { ::operator delete[](ptr, std::align_val_t{ CACHE_LINE_SIZE }); }
+	};
+	std::unique_ptr<mat4f[], AlignedDeleter> _storage;
+};
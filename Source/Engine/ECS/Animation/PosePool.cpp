@@ -0,0 +1,51 @@
+#include "PosePool.hpp"
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+PosePool::PosePool() :
+	_blocks{},
+	_block{ 0 },
+	_offset{ 0 }
+{
+}
+
+PosePool& PosePool::Get()
+{
+	thread_local PosePool pool;
+	return pool;
+}
+
+f32* PosePool::Acquire(u64 nrFloats)
+{
+	// Keep every buffer aligned
+	constexpr u64 floatsPerAlignment = ALIGNMENT / sizeof(f32);
+	nrFloats = (nrFloats + floatsPerAlignment - 1) / floatsPerAlignment * floatsPerAlignment;
+
+	// Move on to the next block large enough, the buffers acquired from the current one stay valid
+	while (_block < _blocks.size() && _offset + nrFloats > _blocks[_block].size)
+	{
+		_block++;
+		_offset = 0;
+	}
+
+	if (_block == _blocks.size())
+	{
+		u64 size = std::max(nrFloats, MIN_BLOCK_SIZE);
+		void* memory = ::operator new[](size * sizeof(f32), std::align_val_t{ ALIGNMENT });
+		_blocks.push_back(Block{ std::unique_ptr<f32[], AlignedDeleter>(static_cast<f32*>(memory)), size });
+	}
+
+	f32* buffer = _blocks[_block].data.get() + _offset;
+	_offset += nrFloats;
+	return buffer;
+}
+
+u64 PosePool::GetCapacity() const
+{
+	u64 capacity = 0;
+	for (const Block& block : _blocks)
+		capacity += block.size * sizeof(f32);
+	return capacity;
+}
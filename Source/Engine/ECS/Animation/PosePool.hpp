@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+/**
+ * @brief Scratch memory for the poses evaluated during an animation update: sampled cooked poses, blend inputs.
+ *
+ * There is one pool per thread (see `Get()`), so the animators updated in parallel never share one.
+ * Buffers are acquired while an animator is evaluated and all released together when the `Scope` of the
+ * evaluation ends. The pool keeps its memory in blocks that never move: after the first updates, once it has
+ * grown to the largest evaluation, acquiring a buffer never allocates.
+ */
+class PosePool
+{
+public:
+	/** @brief Alignment of every buffer, in bytes. */
+	static constexpr u64 ALIGNMENT = 64;
+
+	/** @brief Minimum size of a block, in floats. */
+	static constexpr u64 MIN_BLOCK_SIZE = 16384;
+
+	/** @brief Releases the buffers acquired from the pool during its lifetime. */
+	class Scope
+	{
+	public:
+		Scope(PosePool& pool) : _pool{ pool }, _block{ pool._block }, _offset{ pool._offset } {}
+		~Scope() { _pool._block = _block; _pool._offset = _offset; }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		PosePool& _pool;
+		u32 _block;
+		u64 _offset;
+	};
+
+	PosePool();
+	~PosePool() = default;
+
+	/** @brief Delete copy constructor */
+	PosePool(const PosePool&) = delete;
+	PosePool& operator=(const PosePool&) = delete;
+
+	/** @return The pool of the calling thread */
+	static PosePool& Get();
+
+	/** @return A buffer of `nrFloats` floats, valid until the enclosing `Scope` ends. Its content is undefined. */
+	f32* Acquire(u64 nrFloats);
+
+	/** @return The memory owned by the pool, in bytes */
+	u64 GetCapacity() const;
+
+private:
+	struct AlignedDeleter
+	{
+		void operator()(f32* ptr) const { ::operator delete[](ptr, std::align_val_t{ ALIGNMENT }); }
+	};
+	struct Block
+	{
+		std::unique_ptr<f32[], AlignedDeleter> data;
+		u64 size;
+	};
+
+	Vector<Block> _blocks;
+	u32 _block;
+	u64 _offset;
+};
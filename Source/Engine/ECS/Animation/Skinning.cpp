@@ -0,0 +1,117 @@
+#include "Skinning.hpp"
+
+#include "Core/Math/Simd.hpp"
+
+namespace Skinning
+{
+	/** @brief Skins a single vertex, the same as "SkeletalAnim.vert" */
+	static void SkinVertex(const Vertex_P_N_UV_T_B& vertex, const mat4f* palette, vec3f& position, vec3f* normal)
+	{
+		vec4f totalPosition(0.0f);
+		vec3f totalNormal(0.0f);
+		for (u32 i = 0; i < Vertex_P_N_UV_T_B::MAX_BONES_INFLUENCE; i++)
+		{
+			const i32 bone = vertex.boneIds[i];
+			if (bone < 0)
+				continue;
+
+			const mat4f& m = palette[bone];
+			totalPosition += m * vec4f(vertex.position, 1.0f) * vertex.boneWeights[i];
+			totalNormal += mat3f(m) * vertex.normal * vertex.boneWeights[i];
+		}
+
+		position = vec3f(totalPosition);
+		if (normal)
+		{
+			const f32 length2 = glm::dot(totalNormal, totalNormal);
+			*normal = length2 > 0.0f ? totalNormal / std::sqrt(length2) : totalNormal;
+		}
+	}
+
+	void SkinVerticesScalar(const Vertex_P_N_UV_T_B* vertices, u32 nrVertices, const mat4f* palette, vec3f* positions, vec3f* normals)
+	{
+		for (u32 i = 0; i < nrVertices; i++)
+			SkinVertex(vertices[i], palette, positions[i], normals ? &normals[i] : nullptr);
+	}
+
+	void SkinVertices(const Vertex_P_N_UV_T_B* vertices, u32 nrVertices, const mat4f* palette, vec3f* positions, vec3f* normals)
+	{
+		u32 i = 0;
+
+#if defined(__AVX2__)
+		const f32* paletteFloats = reinterpret_cast<const f32*>(palette);
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+
+		alignas(32) f32 blended[SIMD_WIDTH][16];
+		alignas(32) f32 out[6][SIMD_WIDTH];
+		for (; i + SIMD_WIDTH <= nrVertices; i += SIMD_WIDTH)
+		{
+			// Blend the matrices of the influences of each vertex first: one matrix per lane instead of four
+			for (u32 lane = 0; lane < SIMD_WIDTH; lane++)
+			{
+				const Vertex_P_N_UV_T_B& vertex = vertices[i + lane];
+				__m256 columns01 = zero;
+				__m256 columns23 = zero;
+				for (u32 k = 0; k < Vertex_P_N_UV_T_B::MAX_BONES_INFLUENCE; k++)
+				{
+					const i32 bone = vertex.boneIds[k];
+					if (bone < 0)
+						continue;
+
+					const f32* m = paletteFloats + static_cast<u64>(bone) * 16;
+					const __m256 w = _mm256_set1_ps(vertex.boneWeights[k]);
+					columns01 = _mm256_fmadd_ps(_mm256_loadu_ps(m), w, columns01);
+					columns23 = _mm256_fmadd_ps(_mm256_loadu_ps(m + 8), w, columns23);
+				}
+				_mm256_store_ps(blended[lane], columns01);
+				_mm256_store_ps(blended[lane] + 8, columns23);
+			}
+
+			// One register per matrix element, one lane per vertex
+			__m256 m[16];
+			for (u32 half = 0; half < 2; half++)
+			{
+				for (u32 lane = 0; lane < SIMD_WIDTH; lane++)
+					m[half * 8 + lane] = _mm256_load_ps(blended[lane] + half * 8);
+				Simd::Transpose8x8(&m[half * 8]);
+			}
+
+			const Vertex_P_N_UV_T_B* v = vertices + i;
+			const __m256 x = _mm256_setr_ps(v[0].position.x, v[1].position.x, v[2].position.x, v[3].position.x, v[4].position.x, v[5].position.x, v[6].position.x, v[7].position.x);
+			const __m256 y = _mm256_setr_ps(v[0].position.y, v[1].position.y, v[2].position.y, v[3].position.y, v[4].position.y, v[5].position.y, v[6].position.y, v[7].position.y);
+			const __m256 z = _mm256_setr_ps(v[0].position.z, v[1].position.z, v[2].position.z, v[3].position.z, v[4].position.z, v[5].position.z, v[6].position.z, v[7].position.z);
+			_mm256_store_ps(out[0], _mm256_fmadd_ps(m[0], x, _mm256_fmadd_ps(m[4], y, _mm256_fmadd_ps(m[8], z, m[12]))));
+			_mm256_store_ps(out[1], _mm256_fmadd_ps(m[1], x, _mm256_fmadd_ps(m[5], y, _mm256_fmadd_ps(m[9], z, m[13]))));
+			_mm256_store_ps(out[2], _mm256_fmadd_ps(m[2], x, _mm256_fmadd_ps(m[6], y, _mm256_fmadd_ps(m[10], z, m[14]))));
+			for (u32 lane = 0; lane < SIMD_WIDTH; lane++)
+				positions[i + lane] = vec3f(out[0][lane], out[1][lane], out[2][lane]);
+
+			if (!normals)
+				continue;
+
+			const __m256 nx = _mm256_setr_ps(v[0].normal.x, v[1].normal.x, v[2].normal.x, v[3].normal.x, v[4].normal.x, v[5].normal.x, v[6].normal.x, v[7].normal.x);
+			const __m256 ny = _mm256_setr_ps(v[0].normal.y, v[1].normal.y, v[2].normal.y, v[3].normal.y, v[4].normal.y, v[5].normal.y, v[6].normal.y, v[7].normal.y);
+			const __m256 nz = _mm256_setr_ps(v[0].normal.z, v[1].normal.z, v[2].normal.z, v[3].normal.z, v[4].normal.z, v[5].normal.z, v[6].normal.z, v[7].normal.z);
+			const __m256 qx = _mm256_fmadd_ps(m[0], nx, _mm256_fmadd_ps(m[4], ny, _mm256_mul_ps(m[8], nz)));
+			const __m256 qy = _mm256_fmadd_ps(m[1], nx, _mm256_fmadd_ps(m[5], ny, _mm256_mul_ps(m[9], nz)));
+			const __m256 qz = _mm256_fmadd_ps(m[2], nx, _mm256_fmadd_ps(m[6], ny, _mm256_mul_ps(m[10], nz)));
+
+			// Normalize the normals, a zero normal is left unchanged
+			__m256 length2 = _mm256_mul_ps(qx, qx);
+			length2 = _mm256_fmadd_ps(qy, qy, length2);
+			length2 = _mm256_fmadd_ps(qz, qz, length2);
+			const __m256 nonZero = _mm256_cmp_ps(length2, zero, _CMP_GT_OQ);
+			const __m256 invLength = _mm256_and_ps(nonZero, _mm256_div_ps(one, _mm256_sqrt_ps(length2)));
+			_mm256_store_ps(out[3], _mm256_mul_ps(qx, invLength));
+			_mm256_store_ps(out[4], _mm256_mul_ps(qy, invLength));
+			_mm256_store_ps(out[5], _mm256_mul_ps(qz, invLength));
+			for (u32 lane = 0; lane < SIMD_WIDTH; lane++)
+				normals[i + lane] = vec3f(out[3][lane], out[4][lane], out[5][lane]);
+		}
+#endif
+
+		for (; i < nrVertices; i++)
+			SkinVertex(vertices[i], palette, positions[i], normals ? &normals[i] : nullptr);
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+#include "Engine/Graphics/Vertex.hpp"
+
+/**
+ * @namespace Skinning
+ * @brief Linear blend skinning on the CPU, the same as "SkeletalAnim.vert" does on the GPU.
+ *
+ * Gives the deformed vertices of a skeletal mesh for accurate bounds, ray picking or a software render path.
+ * Each position is the sum of the vertex position transformed by its bones, scaled by their weights.
+ * Each normal is transformed by the upper 3x3 part of the same matrices and normalized: exact as long as
+ * the palette holds no non-uniform scale. Influences with bone id -1 are skipped, so a vertex with no
+ * influence ends up at the origin, as drawn by the shader.
+ */
+namespace Skinning
+{
+	/** @brief Number of vertices processed per SIMD iteration. */
+	constexpr u32 SIMD_WIDTH = 8;
+
+	/**
+	 * @brief Skins the vertices one at a time. Kept as reference.
+	 *
+	 * @param palette The bone palette of the animator (see `Animator::GetPalette()`).
+	 * @param positions Destination of `nrVertices` skinned positions.
+	 * @param normals Destination of `nrVertices` skinned normals, or nullptr to skip them.
+	 */
+	void SkinVerticesScalar(const Vertex_P_N_UV_T_B* vertices, u32 nrVertices, const mat4f* palette, vec3f* positions, vec3f* normals);
+
+	/**
+	 * @brief Skins `SIMD_WIDTH` vertices per iteration with AVX2 and FMA. The matrices of the influences
+	 * of each vertex are blended first, then transposed so that each vertex is a lane of the transformation.
+	 * The remaining vertices go through the scalar path. Falls back to `SkinVerticesScalar` when AVX2 is not available.
+	 *
+	 * @param palette The bone palette of the animator (see `Animator::GetPalette()`).
+	 * @param positions Destination of `nrVertices` skinned positions.
+	 * @param normals Destination of `nrVertices` skinned normals, or nullptr to skip them.
+	 */
+	void SkinVertices(const Vertex_P_N_UV_T_B* vertices, u32 nrVertices, const mat4f* palette, vec3f* positions, vec3f* normals);
+}
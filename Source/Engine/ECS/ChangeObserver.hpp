@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include <entt/entt.hpp>
+
+/**
+ * @brief The entities whose components of the given types changed since the system owning the observer last ran.
+ *
+ * A component changes when it is constructed, or when the registry is told so with `registry.patch()`,
+ * `registry.replace()` or `GameObject::PatchComponent()`: writing to a component through a reference is not seen.
+ * A component destroyed, alone or with its entity, moves the entity to the removed ones. An entity that lost
+ * a component and got it back is in both: the removed ones are to be processed first.
+ *
+ * Each system keeps its own observer, so that a change is seen by every system once, whatever the order
+ * and the rate at which they run. Each entity is listed once, however many times it changed.
+ */
+template<typename... Components>
+class ChangeObserver
+{
+public:
+	ChangeObserver() = default;
+
+	/** @brief Disconnects from the registry, which keeps a pointer to the observer in its signals */
+	~ChangeObserver() { Disconnect(); }
+
+	/** @brief Delete copy constructor: the registry keeps a pointer to the observer */
+	ChangeObserver(const ChangeObserver&) = delete;
+	ChangeObserver& operator=(const ChangeObserver&) = delete;
+
+	/**
+	 * @brief Starts recording the changes of the registry, which must outlive the observer or be disconnected first.
+	 * The components already there are not listed as changed.
+	 */
+	void Connect(entt::registry& registry)
+	{
+		Disconnect();
+		_registry = &registry;
+		(registry.on_construct<Components>().template connect<&ChangeObserver::OnChange>(*this), ...);
+		(registry.on_update<Components>().template connect<&ChangeObserver::OnChange>(*this), ...);
+		(registry.on_destroy<Components>().template connect<&ChangeObserver::OnRemove>(*this), ...);
+	}
+
+	/** @brief Stops recording the changes of the registry connected, if any, and forgets the ones recorded */
+	void Disconnect()
+	{
+		if (_registry)
+		{
+			(_registry->on_construct<Components>().disconnect(this), ...);
+			(_registry->on_update<Components>().disconnect(this), ...);
+			(_registry->on_destroy<Components>().disconnect(this), ...);
+			_registry = nullptr;
+		}
+		Clear();
+	}
+
+	/** @brief Forgets the changes recorded: to call once the system processed them */
+	void Clear()
+	{
+		_changed.clear();
+		_removed.clear();
+	}
+
+	/** @return True if nothing changed since the last `Clear()` */
+	bool IsEmpty() const { return _changed.empty() && _removed.empty(); }
+
+	/** @return The entities with a component constructed or patched, that still have it */
+	const entt::sparse_set& GetChanged() const { return _changed; }
+
+	/** @return The entities that lost one of the components, destroyed ones included */
+	const entt::sparse_set& GetRemoved() const { return _removed; }
+
+private:
+	void OnChange(entt::registry&, entt::entity entity)
+	{
+		if (!_changed.contains(entity))
+			_changed.push(entity);
+	}
+
+	void OnRemove(entt::registry&, entt::entity entity)
+	{
+		_changed.remove(entity);
+		if (!_removed.contains(entity))
+			_removed.push(entity);
+	}
+
+	entt::registry* _registry = nullptr;
+	entt::sparse_set _changed;
+	entt::sparse_set _removed;
+};
@@ -10,4 +10,6 @@
 #include "StaticMesh.hpp"
 #include "Skeleton/SkeletalMesh.hpp"
 #include "Animation/Animation.hpp"
-#include "Animation/Animator.hpp"
\ No newline at end of file
+#include "Animation/Animator.hpp"
+#include "Animation/BakedAnimator.hpp"
+#include "Animation/MorphWeights.hpp"
\ No newline at end of file
@@ -45,6 +45,13 @@ public:
 		reg->remove<T>(id);
 	}
 
+	/** @brief Tells the systems that the component was modified in place (see `ChangeObserver`) */
+	template<typename T>
+	void PatchComponent()
+	{
+		reg->patch<T>(id);
+	}
+
 	template<typename T>
 	bool HasComponent()
 	{
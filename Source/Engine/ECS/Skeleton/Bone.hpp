@@ -2,8 +2,13 @@
 
 #include "Core/Core.hpp"
 #include "Core/Math/Base.hpp"
+#include "Core/Math/AABB.hpp"
 
-/** @brief Represents a single node in a skeleton hierarchy. */
+/**
+ * @brief Represents a single node in a skeleton hierarchy.
+ * The hierarchy is stored as a flat array in depth-first order, so a parent always comes before
+ * its children and the whole hierarchy is visited by a single forward loop.
+ */
 struct BoneNode
 {
 	/**
@@ -14,18 +19,24 @@ struct BoneNode
 	 */
 	mat4f bindPoseTransform{};
 
-	Vector<BoneNode> children;
+	/** @brief Copy of the offset matrix of the bone, identity for nodes with no bone. */
+	mat4f offset{ 1.0f };
+
+	/** @brief Index of the parent node in the node array, -1 for the root. */
+	i32 parent{ -1 };
 
+	/** @brief Index of the bone in the bone array, -1 for nodes with no bone. */
 	i32 index{ -1 };
+
+	/** @brief Number of levels below this node in the hierarchy: 0 for the last node of a chain (e.g. a fingertip). */
+	u32 height{ 0 };
 };
 
 /**
  * @struct Bone
  * @brief Represents a single bone in the skeleton hierarchy.
- * The Bone structure stores essential transformation data for each bone in a skeletal system.
- * It contains information about the bone's offset matrix, current local transformation,
- * and its bind pose transformation. This data is crucial for skeletal animations, allowing
- * the bone to transform and animate models efficiently.
+ * The Bone structure stores the immutable data of a bone, shared by every instance of the skeleton.
+ * The animated transformations of each instance are stored in the `Pose` of its animator.
  */
 struct Bone
 {
@@ -38,11 +49,14 @@ struct Bone
 	 */
 	mat4f offset{};
 
+	/** @brief Inverse of the offset matrix: transforms from the bone's local space to model space in the bind pose. */
+	mat4f inverseOffset{ 1.0f };
+
 	/**
-	 * @brief Current local transformation of the bone.
-	 * Represents the bone's position, rotation, and scale relative to its parent bone during
-	 * an animation. This matrix is updated dynamically as the animation progresses,
-	 * reflecting the bone's current pose.
+	 * @brief Bounds of the vertices influenced by the bone, in the bone's local space.
+	 * Every skinned vertex is a weighted average of its positions moved by its bones, so the union of these bounds
+	 * moved by the current bone transformations contains the animated mesh (see `Animator::GetBounds`).
+	 * Empty for bones influencing no vertex.
 	 */
-	mat4f	localTransform{};
+	AABB bounds{};
 };
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "MorphTargets.hpp"
+
+/** @return The scale of the quantized components: the largest component maps to `QUANTIZATION_MAX`. */
+static f32 CalculateScale(const vec3f* deltas, const i32* slots, u32 nrVertices)
+{
+	f32 maxComponent = 0.0f;
+	for (u32 i = 0; i < nrVertices; i++)
+		if (slots[i] != -1)
+			maxComponent = std::max({ maxComponent, std::abs(deltas[i].x), std::abs(deltas[i].y), std::abs(deltas[i].z) });
+
+	return maxComponent / static_cast<f32>(MorphTargetSet::QUANTIZATION_MAX);
+}
+
+static i16 Quantize(f32 value, f32 scale)
+{
+	if (scale == 0.0f)
+		return 0;
+
+	const i32 quantized = static_cast<i32>(std::round(value / scale));
+	return static_cast<i16>(std::clamp(quantized, -MorphTargetSet::QUANTIZATION_MAX, MorphTargetSet::QUANTIZATION_MAX));
+}
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+MorphTargetSet::MorphTargetSet() :
+	_targets{},
+	_deltas{},
+	_nrSlots{ 0 }
+{
+}
+
+bool MorphTargetSet::IsMoved(const vec3f& positionDelta, const vec3f& normalDelta)
+{
+	constexpr f32 threshold = DELTA_THRESHOLD * DELTA_THRESHOLD;
+	return glm::dot(positionDelta, positionDelta) > threshold || glm::dot(normalDelta, normalDelta) > threshold;
+}
+
+void MorphTargetSet::AddTarget(StringView name, f32 defaultWeight, const vec3f* positionDeltas, const vec3f* normalDeltas, const i32* slots, u32 nrVertices)
+{
+	static const vec3f zero(0.0f);
+
+	Target& target = _targets.emplace_back();
+	target.name.fill(0);
+	std::strncpy(target.name.data(), name.data(), std::min<u64>(name.size(), target.name.size() - 1));
+	target.firstDelta = static_cast<u32>(_deltas.size());
+	target.positionScale = CalculateScale(positionDeltas, slots, nrVertices);
+	target.normalScale = normalDeltas ? CalculateScale(normalDeltas, slots, nrVertices) : 0.0f;
+	target.defaultWeight = defaultWeight;
+
+	for (u32 i = 0; i < nrVertices; i++)
+	{
+		const vec3f& positionDelta = positionDeltas[i];
+		const vec3f& normalDelta = normalDeltas ? normalDeltas[i] : zero;
+		if (slots[i] == -1 || !IsMoved(positionDelta, normalDelta))
+			continue;
+
+		Delta& delta = _deltas.emplace_back();
+		delta.slot = static_cast<u32>(slots[i]);
+		for (i32 k = 0; k < 3; k++)
+		{
+			delta.position[k] = Quantize(positionDelta[k], target.positionScale);
+			delta.normal[k] = Quantize(normalDelta[k], target.normalScale);
+		}
+	}
+	target.nrDeltas = static_cast<u32>(_deltas.size()) - target.firstDelta;
+}
+
+u32 MorphTargetSet::Apply(const f32* weights, vec3f* positions, vec3f* normals) const
+{
+	std::fill_n(positions, _nrSlots, vec3f(0.0f));
+	std::fill_n(normals, _nrSlots, vec3f(0.0f));
+
+	u32 nrApplied = 0;
+	for (u32 t = 0; t < _targets.size(); t++)
+	{
+		if (weights[t] == 0.0f)
+			continue;
+
+		// The weight is folded into the scales: one multiply per component
+		const Target& target = _targets[t];
+		const f32 positionScale = target.positionScale * weights[t];
+		const f32 normalScale = target.normalScale * weights[t];
+		const Delta* deltas = &_deltas[target.firstDelta];
+		for (u32 i = 0; i < target.nrDeltas; i++)
+		{
+			const Delta& delta = deltas[i];
+			positions[delta.slot] += vec3f(delta.position[0], delta.position[1], delta.position[2]) * positionScale;
+			normals[delta.slot] += vec3f(delta.normal[0], delta.normal[1], delta.normal[2]) * normalScale;
+		}
+		nrApplied++;
+	}
+	return nrApplied;
+}
+
+i32 MorphTargetSet::FindTarget(StringView name) const
+{
+	for (u32 i = 0; i < _targets.size(); i++)
+		if (name == _targets[i].name.data())
+			return static_cast<i32>(i);
+
+	return -1;
+}
+
+Vector<f32> MorphTargetSet::GetDefaultWeights() const
+{
+	Vector<f32> weights(_targets.size());
+	for (u32 i = 0; i < _targets.size(); i++)
+		weights[i] = _targets[i].defaultWeight;
+
+	return weights;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+
+/**
+ * @brief The morph targets (blend shapes) of a skeletal mesh, e.g. the expressions of a face.
+ *
+ * A target only stores the vertices it moves, as sparse deltas quantized to 16 bits with a scale per target:
+ * its memory depends on the number of vertices it moves, not on the size of the mesh.
+ *
+ * The vertices moved by at least one target get a slot (see `Vertex_P_N_UV_T_B::morphSlot`), numbered over all
+ * the meshes of the skeletal mesh. The weighted deltas of the active targets are accumulated by slot, by
+ * `Apply()` on the CPU or by the `MorphTargetBuffer` on the GPU, and added to the vertices before skinning.
+ * Targets with a zero weight cost nothing.
+ */
+class MorphTargetSet
+{
+public:
+	/** @brief Deltas below this length are not stored: the vertex is not moved by the target. */
+	static constexpr f32 DELTA_THRESHOLD = 1e-5f;
+
+	/** @brief Largest quantized value of a delta component. */
+	static constexpr i32 QUANTIZATION_MAX = 32767;
+
+	/** @brief A vertex moved by a target, 16 bytes, as "Delta" in the compute shader "MorphTargets.comp". */
+	struct Delta
+	{
+		u32 slot;
+		/** @brief Quantized deltas: multiplied by the scales of their target. */
+		i16 position[3];
+		i16 normal[3];
+	};
+	static_assert(sizeof(Delta) == 16);
+
+	struct Target
+	{
+		Array<char, 32> name;
+		u32 firstDelta;
+		u32 nrDeltas;
+		f32 positionScale;
+		f32 normalScale;
+
+		/** @brief The weight of the target when the mesh is loaded. */
+		f32 defaultWeight;
+	};
+
+	MorphTargetSet();
+	~MorphTargetSet() = default;
+
+	/** @brief Move constructor */
+	MorphTargetSet(MorphTargetSet&&) noexcept = default;
+	MorphTargetSet& operator=(MorphTargetSet&&) noexcept = default;
+
+	/** @brief Delete copy constructor */
+	MorphTargetSet(const MorphTargetSet&) = delete;
+	MorphTargetSet& operator=(const MorphTargetSet&) = delete;
+
+	/** @return Whether a target with these deltas moves the vertex, i.e. stores a delta for it. */
+	static bool IsMoved(const vec3f& positionDelta, const vec3f& normalDelta);
+
+	/** @brief Gives the next slot to a vertex moved by at least one target. */
+	u32 AddSlot() { return _nrSlots++; }
+
+	/**
+	 * @brief Adds a target from the deltas of every vertex of a mesh. Only the moved vertices are stored.
+	 *
+	 * @param positionDeltas The difference between the target and the mesh, `nrVertices` deltas.
+	 * @param normalDeltas The difference of the normals, or null if the target leaves them unchanged.
+	 * @param slots The slot of each vertex (see `AddSlot()`), -1 for the vertices moved by no target.
+	 */
+	void AddTarget(StringView name, f32 defaultWeight, const vec3f* positionDeltas, const vec3f* normalDeltas, const i32* slots, u32 nrVertices);
+
+	/**
+	 * @brief Accumulates the weighted deltas of the targets by slot: the reference of the GPU pass.
+	 *
+	 * @param weights The weight of each target. The targets with a zero weight are skipped.
+	 * @param positions Destination of `GetNumSlots()` position deltas, zero for the slots moved by no active target.
+	 * @param normals Destination of `GetNumSlots()` normal deltas.
+	 * @return The number of targets applied.
+	 */
+	u32 Apply(const f32* weights, vec3f* positions, vec3f* normals) const;
+
+	/** @return The index of the target, -1 if there is no target with this name. */
+	i32 FindTarget(StringView name) const;
+
+	/** @return The default weight of each target, e.g. the weights of a new `MorphWeights`. */
+	Vector<f32> GetDefaultWeights() const;
+
+	u32 GetNumTargets() const { return static_cast<u32>(_targets.size()); }
+	const Target& GetTarget(u32 index) const { return _targets[index]; }
+
+	/** @return The number of vertices moved by at least one target. */
+	u32 GetNumSlots() const { return _nrSlots; }
+
+	u32 GetNumDeltas() const { return static_cast<u32>(_deltas.size()); }
+	const Delta* GetDeltas() const { return _deltas.data(); }
+
+	/** @return The memory used by the targets, in bytes */
+	u64 GetMemorySize() const { return _deltas.size() * sizeof(Delta) + _targets.size() * sizeof(Target); }
+
+private:
+	Vector<Target> _targets;
+	Vector<Delta> _deltas;
+	u32 _nrSlots;
+};
@@ -55,15 +55,31 @@ void SkeletalMesh::CreateFromFile(const fs::path& absolute)
 	u32 totalBones = std::accumulate(scene->mMeshes, scene->mMeshes + scene->mNumMeshes, 0, [](u32 sum, aiMesh* mesh) {
 		return sum + mesh->mNumBones;
 	});
-	assert(totalBones <= GetMaxNumBones());
 	
 	meshes = std::make_unique<Mesh[]>(scene->mNumMeshes);
 	bones = std::make_shared<Bone[]>(totalBones);
 	boneNames = std::make_shared<Array<char, 32>[]>(totalBones);
-	rootNode = std::make_shared<BoneNode>();
+
+	const bool hasMorphTargets = std::any_of(scene->mMeshes, scene->mMeshes + scene->mNumMeshes, [](const aiMesh* mesh) {
+		return mesh->mNumAnimMeshes > 0;
+	});
+	if (hasMorphTargets)
+		morphTargets = std::make_shared<MorphTargetSet>();
 
 	ProcessNode(scene->mRootNode, scene);
-	LoadBoneHierarchy(*rootNode, scene->mRootNode);
+	HashBoneNames();
+
+	if (morphTargets)
+	{
+		CONSOLE_INFO("{} morph targets moving {} vertices: {} deltas, {} KB",
+			morphTargets->GetNumTargets(), morphTargets->GetNumSlots(), morphTargets->GetNumDeltas(), morphTargets->GetMemorySize() / 1024);
+	}
+
+	Vector<BoneNode> hierarchy;
+	LoadBoneHierarchy(hierarchy, scene->mRootNode, -1);
+	nrNodes = static_cast<u32>(hierarchy.size());
+	nodes = std::make_shared<BoneNode[]>(nrNodes);
+	std::copy(hierarchy.begin(), hierarchy.end(), nodes.get());
 }
 
 void SkeletalMesh::Clone(SkeletalMesh& other) const
@@ -75,7 +91,11 @@ void SkeletalMesh::Clone(SkeletalMesh& other) const
 
 	other.bones = bones;	
 	other.boneNames = boneNames;
-	other.rootNode = rootNode;	
+	other.boneHashes = boneHashes;
+	other.morphTargets = morphTargets;
+	other.rigHash = rigHash;
+	other.nodes = nodes;
+	other.nrNodes = nrNodes;
 	other.nrBones = nrBones;
 
 	other.id = id;
@@ -99,15 +119,16 @@ void SkeletalMesh::Draw(RenderMode mode) const
 	}
 }
 
-i32 SkeletalMesh::FindBone(StringView boneName) const
+void SkeletalMesh::DrawInstanced(RenderMode mode, i32 nInstances) const
 {
-	assert(boneName.size() <= 32);
-
-	for (i32 i = 0; i < nrBones; i++)
-		if (boneName == boneNames[i].data())
-			return i;
-
-	return -1;
+	for (u32 i = 0; i < nrMeshes; i++)
+	{
+		auto& mesh = meshes[i];
+		mesh.material.diffuse.BindTextureUnit(0);
+		mesh.material.specular.BindTextureUnit(1);
+		mesh.material.normal.BindTextureUnit(2);
+		mesh.DrawInstanced(mode, nInstances);
+	}
 }
 
 u32 SkeletalMesh::TotalVertices() const
@@ -142,6 +163,7 @@ void SkeletalMesh::ProcessNode(aiNode* node, const aiScene* scene)
 		mesh.SetupAttributeFloat(3, 0, VertexFormat(3, VertexAttribType::FLOAT, false, offsetof(Vertex_P_N_UV_T_B, tangent)));
 		mesh.SetupAttributeInteger(4, 0, VertexFormat(MAX_BONES_INFLUENCE, VertexAttribType::INT, false, offsetof(Vertex_P_N_UV_T_B, boneIds)));
 		mesh.SetupAttributeFloat(5, 0, VertexFormat(MAX_BONES_INFLUENCE, VertexAttribType::FLOAT, false, offsetof(Vertex_P_N_UV_T_B, boneWeights)));
+		mesh.SetupAttributeInteger(6, 0, VertexFormat(1, VertexAttribType::INT, false, offsetof(Vertex_P_N_UV_T_B, morphSlot)));
 
 		aiMesh* aimesh = scene->mMeshes[node->mMeshes[i]];
 
@@ -195,6 +217,7 @@ Buffer SkeletalMesh::LoadVertices(aiMesh* aimesh)
 			vertex.tangent = vec3f(tangent.x, tangent.y, tangent.z);
 	}
 	LoadBonesAndWeights(vertices, aimesh);
+	LoadMorphTargets(vertices, aimesh);
 
 	Buffer buffer(vertices.size() * sizeof(Vertex_P_N_UV_T_B), vertices.data(), BufferUsage::STATIC_DRAW);
 	return buffer;
@@ -235,6 +258,8 @@ void SkeletalMesh::LoadBonesAndWeights(Vector<Vertex_P_N_UV_T_B>& vertices, cons
 		{
 			Bone& bone = bones[nrBones];
 			bone.offset = AiMatrixToGLM(aibone->mOffsetMatrix);
+			bone.inverseOffset = glm::inverse(bone.offset);
+			bone.bounds = AABB{};
 			Array<char, 32>& boneName = boneNames[nrBones];
 			boneName.fill(0);	
 			std::strncpy(boneName.data(), aiboneName.data(), aiboneName.size());
@@ -252,19 +277,83 @@ void SkeletalMesh::LoadBonesAndWeights(Vector<Vertex_P_N_UV_T_B>& vertices, cons
 			vertex.AddBone(boneIndex, weight);
 		}
 	}
+
+	ExpandBoneBounds(vertices.data(), static_cast<u32>(vertices.size()));
+}
+
+void SkeletalMesh::LoadMorphTargets(Vector<Vertex_P_N_UV_T_B>& vertices, const aiMesh* aimesh)
+{
+	const u32 nrTargets = aimesh->mNumAnimMeshes;
+	const u32 nrVertices = aimesh->mNumVertices;
+	if (nrTargets == 0 || !morphTargets)
+		return;
+
+	// The anim meshes replace the vertices: the deltas are relative to the mesh
+	Vector<vec3f> positionDeltas(static_cast<u64>(nrTargets) * nrVertices, vec3f(0.0f));
+	Vector<vec3f> normalDeltas(static_cast<u64>(nrTargets) * nrVertices, vec3f(0.0f));
+	for (u32 t = 0; t < nrTargets; t++)
+	{
+		const aiAnimMesh* animMesh = aimesh->mAnimMeshes[t];
+		vec3f* targetPositions = &positionDeltas[static_cast<u64>(t) * nrVertices];
+		vec3f* targetNormals = &normalDeltas[static_cast<u64>(t) * nrVertices];
+		for (u32 i = 0; i < nrVertices; i++)
+		{
+			if (animMesh->HasPositions())
+			{
+				const aiVector3D delta = animMesh->mVertices[i] - aimesh->mVertices[i];
+				targetPositions[i] = vec3f(delta.x, delta.y, delta.z);
+			}
+			if (animMesh->HasNormals() && aimesh->HasNormals())
+			{
+				const aiVector3D delta = animMesh->mNormals[i] - aimesh->mNormals[i];
+				targetNormals[i] = vec3f(delta.x, delta.y, delta.z);
+			}
+		}
+	}
+
+	// Only the vertices moved by a target get a slot
+	Vector<i32> slots(nrVertices, -1);
+	for (u32 i = 0; i < nrVertices; i++)
+	{
+		for (u32 t = 0; t < nrTargets; t++)
+		{
+			const u64 index = static_cast<u64>(t) * nrVertices + i;
+			if (MorphTargetSet::IsMoved(positionDeltas[index], normalDeltas[index]))
+			{
+				slots[i] = static_cast<i32>(morphTargets->AddSlot());
+				vertices[i].morphSlot = slots[i];
+				break;
+			}
+		}
+	}
+
+	for (u32 t = 0; t < nrTargets; t++)
+	{
+		const aiAnimMesh* animMesh = aimesh->mAnimMeshes[t];
+		String name = animMesh->mName.length > 0 ? String(animMesh->mName.C_Str()) : std::format("{}_{}", aimesh->mName.C_Str(), t);
+		const vec3f* targetNormals = animMesh->HasNormals() ? &normalDeltas[static_cast<u64>(t) * nrVertices] : nullptr;
+		morphTargets->AddTarget(name, animMesh->mWeight, &positionDeltas[static_cast<u64>(t) * nrVertices], targetNormals, slots.data(), nrVertices);
+	}
 }
 
-void SkeletalMesh::LoadBoneHierarchy(BoneNode& dest, const aiNode* src)
+u32 SkeletalMesh::LoadBoneHierarchy(Vector<BoneNode>& dest, const aiNode* src, i32 parent)
 {
 	StringView aiboneName = src->mName.data;
 	i32 boneIndex = FindBone(aiboneName);
 	
-	dest.bindPoseTransform = AiMatrixToGLM(src->mTransformation);
-	dest.index = boneIndex;
-	dest.children.reserve(src->mNumChildren);
+	i32 nodeIndex = static_cast<i32>(dest.size());
+	BoneNode& node = dest.emplace_back();
+	node.bindPoseTransform = AiMatrixToGLM(src->mTransformation);
+	node.offset = boneIndex != -1 ? bones[boneIndex].offset : mat4f(1.0f);
+	node.parent = parent;
+	node.index = boneIndex;
+
+	// Pre-order: the children follow their parent
+	u32 height = 0;
 	for (u32 i = 0; i < src->mNumChildren; i++)
-	{
-		BoneNode& child = dest.children.emplace_back();
-		LoadBoneHierarchy(child, src->mChildren[i]);
-	}
+		height = std::max(height, LoadBoneHierarchy(dest, src->mChildren[i], nodeIndex) + 1);
+
+	// The vector may have grown: do not keep references across the recursion
+	dest[nodeIndex].height = height;
+	return height;
 }
@@ -2,12 +2,14 @@
 
 #include "Core/Core.hpp"
 #include "Core/Math/Base.hpp"
+#include "Core/Hash.hpp"
 #include "Engine/Graphics/Mesh.hpp"
+#include "Engine/Graphics/Vertex.hpp"
 #include "Engine/ECS/Skeleton/Bone.hpp"
+#include "Engine/ECS/Skeleton/MorphTargets.hpp"
 #include "Engine/ECS/Animation/Animator.hpp"
 
 class Texture2D;
-struct Vertex_P_N_UV_T_B;
 struct aiMesh;
 struct aiNode;
 struct aiScene;
@@ -18,12 +20,16 @@ class SkeletalMesh
 {
 public:
   SkeletalMesh() :
-    rootNode{},
-    meshes{},
+    nodes{},
+    nrNodes{ 0 },
     bones{},
     boneNames{},
-    nrBones{ 0 },
+    boneHashes{},
+    morphTargets{},
+    meshes{},
     nrMeshes{ 0 },
+    nrBones{ 0 },
+    rigHash{ 0 },
     id{ 0 }
   {}
 
@@ -47,12 +53,6 @@ public:
   SkeletalMesh(const SkeletalMesh&) = delete;
   SkeletalMesh& operator=(const SkeletalMesh&) = delete;
 
-  static constexpr u32 GetMaxNumBones()
-  {
-    constexpr u32 SKELETAL_MESH_MAX_NUM_BONES = 100;
-    return SKELETAL_MESH_MAX_NUM_BONES;
-  }
-
   /**
    * @brief Creates a SkeletalMesh from a file located at the given path and allocates GPU resources.
    * This method imports a 3D model containing skeletal information from the specified file using the Assimp library.
@@ -63,7 +63,8 @@ public:
    * - Allocates memory for the meshes (each mesh having its own VAO and buffers for vertices and indices).
    * - Allocates memory for the bones and their names.
    * - Creates GPU resources for each mesh, including vertex and element buffers.
-   * - Builds the bone hierarchy by recursively processing the nodes in the model.
+   * - Builds the bone hierarchy by recursively processing the nodes in the model, then stores it flattened in depth-first order.
+   * - Loads the morph targets of the meshes, if any, as sparse deltas (see `MorphTargetSet`).
    *
    * Additionally, if the model has associated textures (e.g., diffuse, specular, normal maps), these
    * textures are loaded and assigned to the corresponding materials.
@@ -97,6 +98,7 @@ public:
   void Destroy() const;
 
   void Draw(RenderMode mode) const;
+  void DrawInstanced(RenderMode mode, i32 nInstances) const;
   
   /**
    * @brief Finds the index of a bone given its name.
@@ -109,21 +111,70 @@ public:
    *
    * @return The index of the bone if found, otherwise -1.
    */
-  i32 FindBone(StringView boneName) const;
+  i32 FindBone(StringView boneName) const
+  {
+    assert(boneName.size() <= 32);
+
+    for (u32 i = 0; i < nrBones; i++)
+      if (boneName == boneNames[i].data())
+        return static_cast<i32>(i);
+
+    return -1;
+  }
   
+  /**
+   * @brief Hashes the bone names into `boneHashes` and `rigHash`.
+   * Called once the bones are loaded: the animations find the bones of the skeleton by these hashes (see `ChannelRemap`).
+   */
+  void HashBoneNames()
+  {
+    boneHashes = std::make_shared<u64[]>(nrBones);
+    rigHash = HashBytes(&nrBones, sizeof(nrBones));
+    for (u32 i = 0; i < nrBones; i++)
+    {
+      boneHashes[i] = HashString(boneNames[i].data());
+      rigHash = HashBytes(&boneHashes[i], sizeof(u64), rigHash);
+    }
+  }
+
+  /**
+   * @brief Grows the bounds of the bones (see `Bone::bounds`) by the vertices they influence.
+   * Called for each mesh once its bones and weights are loaded.
+   */
+  void ExpandBoneBounds(const Vertex_P_N_UV_T_B* vertices, u32 nrVertices)
+  {
+    for (u32 i = 0; i < nrVertices; i++)
+    {
+      const Vertex_P_N_UV_T_B& vertex = vertices[i];
+      for (u32 k = 0; k < Vertex_P_N_UV_T_B::MAX_BONES_INFLUENCE; k++)
+      {
+        // Every influence counts, however small: the bounds must contain the weighted average
+        const i32 boneIndex = vertex.boneIds[k];
+        if (boneIndex < 0 || vertex.boneWeights[k] <= 0.0f)
+          continue;
+
+        Bone& bone = bones[boneIndex];
+        bone.bounds.Expand(vec3f(bone.offset * vec4f(vertex.position, 1.0f)));
+      }
+    }
+  }
+
   u32 TotalVertices() const;
 
   u32 TotalIndices() const;
 
   /**
-   * @brief The root bone node of the bone hierarchy.
+   * @brief The nodes of the bone hierarchy in depth-first order, the root first.
    *
+   * Each node refers to its parent by index, so the hierarchy is traversed by a linear loop.
    * This shared pointer ensures that all instances of the same skeletal
    * mesh share the same bone hierarchy, optimizing memory usage by
    * preventing the creation of redundant bone hierarchies for the same
    * skeleton.
    */
-  SharedPtr<BoneNode> rootNode;
+  SharedPtr<BoneNode[]> nodes;
+
+  u32 nrNodes;
   
   /**
    * @brief Array of bones associated with the skeletal mesh.
@@ -146,6 +197,12 @@ public:
    */
   SharedPtr<Array<char, 32>[]> boneNames;
 
+  /** @brief The hash of each bone name (see `HashString`), parallel to `boneNames` and shared the same way. */
+  SharedPtr<u64[]> boneHashes;
+
+  /** @brief The morph targets of all the meshes, shared the same way. Null when the model has none. */
+  SharedPtr<MorphTargetSet> morphTargets;
+
   /**
    * @brief Array of meshes that compose this skeletal mesh.
    * This is a unique pointer because each mesh can have different materials and must
@@ -158,6 +215,12 @@ public:
 
   u32 nrBones;
 
+  /**
+   * @brief Hash of the bone names, in order. Skeletal meshes with the same rig hash share the remap tables
+   * of their animations (see `AnimationsManager`). Zero until `HashBoneNames()` is called.
+   */
+  u64 rigHash;
+
   /** @brief Unique identifier referencing the original SkeletalMesh stored in ModelsManager. */
   u32 id;
 
@@ -166,5 +229,6 @@ private:
   Buffer LoadVertices(aiMesh* aimesh);
   Buffer LoadIndices(aiMesh* aimesh);
   void LoadBonesAndWeights(Vector<Vertex_P_N_UV_T_B>& vertices, const aiMesh* aimesh);
-  void LoadBoneHierarchy(BoneNode& dest, const aiNode* src);
+  void LoadMorphTargets(Vector<Vertex_P_N_UV_T_B>& vertices, const aiMesh* aimesh);
+  u32 LoadBoneHierarchy(Vector<BoneNode>& dest, const aiNode* src, i32 parent);
 };
\ No newline at end of file
@@ -2,19 +2,45 @@
 
 #include "Core/Math/Ext.hpp"
 #include "Core/Log/Logger.hpp"
+#include "Engine/ECS/TransformCompose.hpp"
+#include "Engine/ECS/TransformHierarchy.hpp"
 
 Transform::Transform()
 	: position{ 0.0f, 0.0f, 0.0f },
 		scale{ 1.0f, 1.0f, 1.0f },
-		rotation{ 0.0f, 0.0f, 0.0f }
+		rotation{ 1.0f, 0.0f, 0.0f, 0.0f },
+		_hierarchy{ nullptr },
+		_node{ 0 }
 {
 	UpdateTransformation();
 }
 
 void Transform::UpdateTransformation()
 {
-	mat4f translationMatrix = glm::translate(mat4f(1.0f), position);
-	mat4f rotationMatrix = mat4f(quat(vec3f(glm::radians(rotation.x), glm::radians(rotation.y), glm::radians(rotation.z))));
-	mat4f scalingMatrix = glm::scale(mat4f(1.0f), scale);
-	_transformation = translationMatrix * rotationMatrix * scalingMatrix;
+	// In a scene, the matrix is composed with the other dirty transforms by the next update
+	const TransformCompose::TRS trs{ position, scale, rotation };
+	if (_hierarchy)
+		_hierarchy->SetLocal(_node, trs);
+	else
+		_transformation = TransformCompose::ComposeMatrix(trs);
+}
+
+mat4f Transform::GetLocalTransformation() const
+{
+	return _hierarchy ? _hierarchy->GetLocal(_node) : _transformation;
+}
+
+mat4f Transform::GetParentTransformation() const
+{
+	return _hierarchy ? _hierarchy->GetParentWorld(_node) : mat4f(1.0f);
+}
+
+vec3f Transform::GetEulerAngles() const
+{
+	return glm::degrees(glm::eulerAngles(rotation));
+}
+
+void Transform::SetEulerAngles(const vec3f& degrees)
+{
+	rotation = quat(glm::radians(degrees));
 }
\ No newline at end of file
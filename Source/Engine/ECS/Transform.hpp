@@ -3,26 +3,54 @@
 #include "Core/Core.hpp"
 #include "Core/Math/Base.hpp"
 
+class TransformHierarchy;
+
 /**
  * @brief
- * Represents the GameObject's transformation (location, rotation, scale) in world space
+ * Represents the GameObject's transformation (location, rotation, scale) relative to its parent,
+ * in world space for an object with no parent (see `TransformHierarchy`)
  */
 class Transform
 {
 public:
+	/** @brief The components keep their address when others are destroyed: `TransformHierarchy` writes to them directly */
+	static constexpr bool in_place_delete = true;
+
 	Transform();
 	~Transform() = default;
 
-	/** @brief Update the transformation matrix. Call this function after changing position, scale or rotation. */
+	/**
+	 * @brief Update the transformation matrix. Call this function after changing position, scale or rotation.
+	 * In a scene, the world matrix of the transform and of its children is updated by the next `TransformHierarchy::Update`.
+	 */
 	void UpdateTransformation();
 
-	/** @return The transformation matrix */
+	/** @return The transformation matrix in world space */
 	mat4f& GetTransformation() { return _transformation; }
+	const mat4f& GetTransformation() const { return _transformation; }
+
+	/** @return The transformation matrix relative to the parent. In a scene, computed by the last `TransformHierarchy::Update`. */
+	mat4f GetLocalTransformation() const;
+
+	/** @return The transformation matrix in world space of the parent, the identity with no parent */
+	mat4f GetParentTransformation() const;
+
+	/** @return The rotation as Euler angles in degrees, for the editor */
+	vec3f GetEulerAngles() const;
+
+	/** @brief Sets the rotation from Euler angles in degrees. Call `UpdateTransformation()` after. */
+	void SetEulerAngles(const vec3f& degrees);
 
 	vec3f position;
 	vec3f scale;
-	vec3f rotation;	/* In degrees */
-	
+	quat rotation;
+
 private:
+	friend class TransformHierarchy;
+
 	mat4f _transformation;
+
+	/** @brief The hierarchy of the scene, null for a transform out of a scene */
+	TransformHierarchy* _hierarchy;
+	u32 _node;
 };
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "TransformCompose.hpp"
+
+#include "Core/Math/Simd.hpp"
+
+namespace TransformCompose
+{
+	mat4f ComposeMatrix(const TRS& transform)
+	{
+		const quat& q = transform.rotation;
+		const f32 x2 = q.x + q.x;
+		const f32 y2 = q.y + q.y;
+		const f32 z2 = q.z + q.z;
+		const f32 xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+		const f32 xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+		const f32 wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+		const vec3f& s = transform.scale;
+		const vec3f& p = transform.position;
+		return mat4f(
+			(1.0f - (yy + zz)) * s.x, (xy + wz) * s.x, (xz - wy) * s.x, 0.0f,
+			(xy - wz) * s.y, (1.0f - (xx + zz)) * s.y, (yz + wx) * s.y, 0.0f,
+			(xz + wy) * s.z, (yz - wx) * s.z, (1.0f - (xx + yy)) * s.z, 0.0f,
+			p.x, p.y, p.z, 1.0f);
+	}
+
+	void ComposeMatricesScalar(const TRS* transforms, const u32* indices, u32 nrIndices, mat4f* matrices)
+	{
+		for (u32 i = 0; i < nrIndices; i++)
+			matrices[indices[i]] = ComposeMatrix(transforms[indices[i]]);
+	}
+
+	void ComposeMatrices(const TRS* transforms, const u32* indices, u32 nrIndices, mat4f* matrices)
+	{
+		u32 i = 0;
+
+#if defined(__AVX2__)
+		const __m256 zero = _mm256_setzero_ps();
+		const __m256 one = _mm256_set1_ps(1.0f);
+
+		for (; i + SIMD_WIDTH <= nrIndices; i += SIMD_WIDTH)
+		{
+			const TRS* t[SIMD_WIDTH];
+			for (u32 lane = 0; lane < SIMD_WIDTH; lane++)
+				t[lane] = &transforms[indices[i + lane]];
+
+			const __m256 qx = _mm256_setr_ps(t[0]->rotation.x, t[1]->rotation.x, t[2]->rotation.x, t[3]->rotation.x, t[4]->rotation.x, t[5]->rotation.x, t[6]->rotation.x, t[7]->rotation.x);
+			const __m256 qy = _mm256_setr_ps(t[0]->rotation.y, t[1]->rotation.y, t[2]->rotation.y, t[3]->rotation.y, t[4]->rotation.y, t[5]->rotation.y, t[6]->rotation.y, t[7]->rotation.y);
+			const __m256 qz = _mm256_setr_ps(t[0]->rotation.z, t[1]->rotation.z, t[2]->rotation.z, t[3]->rotation.z, t[4]->rotation.z, t[5]->rotation.z, t[6]->rotation.z, t[7]->rotation.z);
+			const __m256 qw = _mm256_setr_ps(t[0]->rotation.w, t[1]->rotation.w, t[2]->rotation.w, t[3]->rotation.w, t[4]->rotation.w, t[5]->rotation.w, t[6]->rotation.w, t[7]->rotation.w);
+			const __m256 sx = _mm256_setr_ps(t[0]->scale.x, t[1]->scale.x, t[2]->scale.x, t[3]->scale.x, t[4]->scale.x, t[5]->scale.x, t[6]->scale.x, t[7]->scale.x);
+			const __m256 sy = _mm256_setr_ps(t[0]->scale.y, t[1]->scale.y, t[2]->scale.y, t[3]->scale.y, t[4]->scale.y, t[5]->scale.y, t[6]->scale.y, t[7]->scale.y);
+			const __m256 sz = _mm256_setr_ps(t[0]->scale.z, t[1]->scale.z, t[2]->scale.z, t[3]->scale.z, t[4]->scale.z, t[5]->scale.z, t[6]->scale.z, t[7]->scale.z);
+
+			const __m256 x2 = _mm256_add_ps(qx, qx);
+			const __m256 y2 = _mm256_add_ps(qy, qy);
+			const __m256 z2 = _mm256_add_ps(qz, qz);
+			const __m256 xx = _mm256_mul_ps(qx, x2);
+			const __m256 yy = _mm256_mul_ps(qy, y2);
+			const __m256 zz = _mm256_mul_ps(qz, z2);
+			const __m256 xy = _mm256_mul_ps(qx, y2);
+			const __m256 xz = _mm256_mul_ps(qx, z2);
+			const __m256 yz = _mm256_mul_ps(qy, z2);
+			const __m256 wx = _mm256_mul_ps(qw, x2);
+			const __m256 wy = _mm256_mul_ps(qw, y2);
+			const __m256 wz = _mm256_mul_ps(qw, z2);
+
+			// One register per matrix element, column after column, one lane per transform
+			__m256 m[16];
+			m[0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx);
+			m[1] = _mm256_mul_ps(_mm256_add_ps(xy, wz), sx);
+			m[2] = _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx);
+			m[3] = zero;
+			m[4] = _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy);
+			m[5] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy);
+			m[6] = _mm256_mul_ps(_mm256_add_ps(yz, wx), sy);
+			m[7] = zero;
+			m[8] = _mm256_mul_ps(_mm256_add_ps(xz, wy), sz);
+			m[9] = _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz);
+			m[10] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz);
+			m[11] = zero;
+			m[12] = _mm256_setr_ps(t[0]->position.x, t[1]->position.x, t[2]->position.x, t[3]->position.x, t[4]->position.x, t[5]->position.x, t[6]->position.x, t[7]->position.x);
+			m[13] = _mm256_setr_ps(t[0]->position.y, t[1]->position.y, t[2]->position.y, t[3]->position.y, t[4]->position.y, t[5]->position.y, t[6]->position.y, t[7]->position.y);
+			m[14] = _mm256_setr_ps(t[0]->position.z, t[1]->position.z, t[2]->position.z, t[3]->position.z, t[4]->position.z, t[5]->position.z, t[6]->position.z, t[7]->position.z);
+			m[15] = one;
+
+			// Each lane back to a matrix: the first two columns, then the last two
+			Simd::Transpose8x8(&m[0]);
+			Simd::Transpose8x8(&m[8]);
+			for (u32 lane = 0; lane < SIMD_WIDTH; lane++)
+			{
+				f32* matrix = &matrices[indices[i + lane]][0][0];
+				_mm256_storeu_ps(matrix, m[lane]);
+				_mm256_storeu_ps(matrix + 8, m[8 + lane]);
+			}
+		}
+#endif
+
+		for (; i < nrIndices; i++)
+			matrices[indices[i]] = ComposeMatrix(transforms[indices[i]]);
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+
+/**
+ * @namespace TransformCompose
+ * @brief Builds the matrices translation * rotation * scale of transforms, in batches.
+ *
+ * The rotation is a unit quaternion: its matrix is written directly, scaled per column, with the translation
+ * as the last column. No intermediate matrix and no matrix product.
+ */
+namespace TransformCompose
+{
+	/** @brief Number of transforms composed per SIMD iteration. */
+	constexpr u32 SIMD_WIDTH = 8;
+
+	/** @brief The components of a transform, relative to its parent. */
+	struct TRS
+	{
+		vec3f position;
+		vec3f scale;
+		quat rotation;
+	};
+
+	/** @return The matrix of a single transform. Kept as reference. */
+	mat4f ComposeMatrix(const TRS& transform);
+
+	/**
+	 * @brief Composes the transforms one at a time.
+	 *
+	 * @param indices The positions of the transforms to compose, in `transforms` and in `matrices`.
+	 */
+	void ComposeMatricesScalar(const TRS* transforms, const u32* indices, u32 nrIndices, mat4f* matrices);
+
+	/**
+	 * @brief Composes `SIMD_WIDTH` transforms per iteration with AVX2 and FMA: one lane per transform,
+	 * one register per matrix element, transposed into matrices when written. The remaining transforms go through
+	 * the scalar path. Falls back to `ComposeMatricesScalar` when AVX2 is not available.
+	 *
+	 * @param indices The positions of the transforms to compose, in `transforms` and in `matrices`.
+	 */
+	void ComposeMatrices(const TRS* transforms, const u32* indices, u32 nrIndices, mat4f* matrices);
+}
@@ -0,0 +1,364 @@
+#include "TransformHierarchy.hpp"
+
+#include "Engine/ECS/Transform.hpp"
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+TransformHierarchy::TransformHierarchy() :
+	_indices{},
+	_parentIds{},
+	_freeIds{},
+	_removedIds{},
+	_entityNodes{},
+	_ids{},
+	_parents{},
+	_subtreeEnds{},
+	_entities{},
+	_components{},
+	_trs{},
+	_locals{},
+	_worlds{},
+	_dirty{},
+	_dirtyIndices{},
+	_orderValid{ true },
+	_sortedMatrices{},
+	_updated{}
+{
+}
+
+void TransformHierarchy::Connect(entt::registry& registry)
+{
+	registry.on_construct<Transform>().connect<&TransformHierarchy::OnConstruct>(*this);
+	registry.on_update<Transform>().connect<&TransformHierarchy::OnUpdate>(*this);
+	registry.on_destroy<Transform>().connect<&TransformHierarchy::OnDestroy>(*this);
+}
+
+void TransformHierarchy::Disconnect(entt::registry& registry)
+{
+	registry.on_construct<Transform>().disconnect<&TransformHierarchy::OnConstruct>(*this);
+	registry.on_update<Transform>().disconnect<&TransformHierarchy::OnUpdate>(*this);
+	registry.on_destroy<Transform>().disconnect<&TransformHierarchy::OnDestroy>(*this);
+}
+
+void TransformHierarchy::Clear()
+{
+	_indices.clear();
+	_parentIds.clear();
+	_freeIds.clear();
+	_removedIds.clear();
+	_entityNodes.clear();
+	_ids.clear();
+	_parents.clear();
+	_subtreeEnds.clear();
+	_entities.clear();
+	_components.clear();
+	_trs.clear();
+	_locals.clear();
+	_worlds.clear();
+	_dirty.clear();
+	_dirtyIndices.clear();
+	_orderValid = true;
+	_sortedMatrices.clear();
+	_updated.clear();
+}
+
+bool TransformHierarchy::SetParent(entt::entity entity, entt::entity parent)
+{
+	const u32 node = FindNode(entity);
+	if (node == INVALID_NODE)
+		return false;
+
+	u32 parentNode = INVALID_NODE;
+	if (parent != entt::null)
+	{
+		parentNode = FindNode(parent);
+		if (parentNode == INVALID_NODE)
+			return false;
+
+		// The parent cannot be the entity or one of its descendants
+		for (u32 ancestor = parentNode; ancestor != INVALID_NODE; ancestor = FindParentNode(ancestor))
+			if (ancestor == node)
+				return false;
+	}
+
+	// The node may now come before its parent: sorted again by the next update
+	_parentIds[node] = parentNode;
+	MarkDirty(_indices[node]);
+	_orderValid = false;
+	return true;
+}
+
+entt::entity TransformHierarchy::GetParent(entt::entity entity) const
+{
+	const u32 node = FindNode(entity);
+	if (node == INVALID_NODE)
+		return entt::null;
+
+	const u32 parentNode = FindParentNode(node);
+	return parentNode != INVALID_NODE ? _entities[_indices[parentNode]] : entt::null;
+}
+
+u32 TransformHierarchy::GetDepth(entt::entity entity) const
+{
+	const u32 node = FindNode(entity);
+	if (node == INVALID_NODE)
+		return 0;
+
+	u32 depth = 0;
+	for (u32 ancestor = FindParentNode(node); ancestor != INVALID_NODE; ancestor = FindParentNode(ancestor))
+		depth++;
+	return depth;
+}
+
+void TransformHierarchy::SetLocal(u32 node, const TransformCompose::TRS& local)
+{
+	const u32 index = _indices[node];
+	_trs[index] = local;
+	MarkDirty(index);
+}
+
+mat4f TransformHierarchy::GetParentWorld(u32 node) const
+{
+	const u32 parentNode = FindParentNode(node);
+	return parentNode != INVALID_NODE ? _worlds[_indices[parentNode]] : mat4f(1.0f);
+}
+
+u32 TransformHierarchy::FindNode(entt::entity entity) const
+{
+	auto it = _entityNodes.find(entity);
+	return it != _entityNodes.end() ? it->second : INVALID_NODE;
+}
+
+void TransformHierarchy::Update()
+{
+	if (!_orderValid)
+		RebuildOrder();
+
+	// In increasing order, a dirty node inside the subtree of a former one is already computed. The parent
+	// of the first node of a subtree is before the subtree: up to date.
+	_updated.clear();
+	std::sort(_dirtyIndices.begin(), _dirtyIndices.end());
+	TransformCompose::ComposeMatrices(_trs.data(), _dirtyIndices.data(), static_cast<u32>(_dirtyIndices.size()), _locals.data());
+	u32 end = 0;
+	for (u32 first : _dirtyIndices)
+	{
+		_dirty[first] = 0;
+		if (first < end)
+			continue;
+
+		end = _subtreeEnds[first];
+		for (u32 i = first; i < end; i++)
+		{
+			const u32 parent = _parents[i];
+			_worlds[i] = parent != INVALID_NODE ? _worlds[parent] * _locals[i] : _locals[i];
+			_components[i]->_transformation = _worlds[i];
+			_updated.push_back(i);
+		}
+	}
+	_dirtyIndices.clear();
+}
+
+// ----------------------------------------------------
+//										PRIVATE
+// ----------------------------------------------------
+
+void TransformHierarchy::OnConstruct(entt::registry& registry, entt::entity entity)
+{
+	Transform& transform = registry.get<Transform>(entity);
+	transform._hierarchy = this;
+	transform._node = AddNode(entity, transform);
+}
+
+void TransformHierarchy::OnUpdate(entt::registry& registry, entt::entity entity)
+{
+	// The component was replaced: the new one takes the node of the former one
+	const u32 node = FindNode(entity);
+	if (node == INVALID_NODE)
+	{
+		OnConstruct(registry, entity);
+		return;
+	}
+
+	Transform& transform = registry.get<Transform>(entity);
+	transform._hierarchy = this;
+	transform._node = node;
+	_components[_indices[node]] = &transform;
+	SetLocal(node, TransformCompose::TRS{ transform.position, transform.scale, transform.rotation });
+}
+
+void TransformHierarchy::OnDestroy(entt::registry&, entt::entity entity)
+{
+	const u32 node = FindNode(entity);
+	if (node != INVALID_NODE)
+		RemoveNode(node);
+}
+
+u32 TransformHierarchy::AddNode(entt::entity entity, Transform& transform)
+{
+	u32 node;
+	if (!_freeIds.empty())
+	{
+		node = _freeIds.back();
+		_freeIds.pop_back();
+	}
+	else
+	{
+		node = static_cast<u32>(_indices.size());
+		_indices.push_back(INVALID_NODE);
+		_parentIds.push_back(INVALID_NODE);
+	}
+
+	// A root has no parent to come after: appended, the order stays valid
+	const u32 index = static_cast<u32>(_ids.size());
+	_indices[node] = index;
+	_parentIds[node] = INVALID_NODE;
+	_entityNodes[entity] = node;
+	_ids.push_back(node);
+	_parents.push_back(INVALID_NODE);
+	_subtreeEnds.push_back(index + 1);
+	_entities.push_back(entity);
+	_components.push_back(&transform);
+	_trs.push_back(TransformCompose::TRS{ transform.position, transform.scale, transform.rotation });
+	_locals.push_back(mat4f(1.0f));
+	_worlds.push_back(mat4f(1.0f));
+	_dirty.push_back(0);
+	MarkDirty(index);
+	return node;
+}
+
+void TransformHierarchy::RemoveNode(u32 node)
+{
+	// The node stays in the arrays until the next update: its children are attached to its parent then
+	const u32 index = _indices[node];
+	_entityNodes.erase(_entities[index]);
+	_ids[index] = INVALID_NODE;
+	_dirty[index] = 0;
+	_removedIds.push_back(node);
+	_orderValid = false;
+}
+
+void TransformHierarchy::MarkDirty(u32 index)
+{
+	if (_dirty[index])
+		return;
+	_dirty[index] = 1;
+	_dirtyIndices.push_back(index);
+}
+
+u32 TransformHierarchy::FindParentNode(u32 node) const
+{
+	u32 parentNode = _parentIds[node];
+	while (parentNode != INVALID_NODE && IsRemoved(parentNode))
+		parentNode = _parentIds[parentNode];
+	return parentNode;
+}
+
+void TransformHierarchy::RebuildOrder()
+{
+	// The children of each node, by node identifier. The children of a removed node go to its parent.
+	const u32 nrIds = static_cast<u32>(_indices.size());
+	Vector<u32> firstChild(nrIds + 1, 0);
+	Vector<u32> order;
+	order.reserve(_entityNodes.size());
+	for (u32 node : _ids)
+	{
+		if (node == INVALID_NODE)
+			continue;
+
+		const u32 parentNode = FindParentNode(node);
+		if (parentNode != _parentIds[node])
+		{
+			_parentIds[node] = parentNode;
+			_dirty[_indices[node]] = 1;
+		}
+
+		if (parentNode == INVALID_NODE)
+			order.push_back(node);
+		else
+			firstChild[parentNode + 1]++;
+	}
+	for (u32 i = 0; i < nrIds; i++)
+		firstChild[i + 1] += firstChild[i];
+
+	Vector<u32> children(firstChild[nrIds]);
+	Vector<u32> nrChildren(nrIds, 0);
+	for (u32 node : _ids)
+	{
+		if (node == INVALID_NODE || _parentIds[node] == INVALID_NODE)
+			continue;
+		const u32 parentNode = _parentIds[node];
+		children[firstChild[parentNode] + nrChildren[parentNode]++] = node;
+	}
+
+	for (u32 node : _removedIds)
+	{
+		_indices[node] = INVALID_NODE;
+		_parentIds[node] = INVALID_NODE;
+		_freeIds.push_back(node);
+	}
+	_removedIds.clear();
+
+	// Depth first from the roots, the children in reverse on the stack to keep their order
+	Vector<u32> stack(order.rbegin(), order.rend());
+	order.clear();
+	while (!stack.empty())
+	{
+		const u32 node = stack.back();
+		stack.pop_back();
+		order.push_back(node);
+		stack.insert(stack.end(), std::make_reverse_iterator(children.begin() + firstChild[node] + nrChildren[node]),
+			std::make_reverse_iterator(children.begin() + firstChild[node]));
+	}
+
+	const u32 nrNodes = static_cast<u32>(order.size());
+	Vector<entt::entity> entities(nrNodes);
+	Vector<Transform*> components(nrNodes);
+	Vector<TransformCompose::TRS> trs(nrNodes);
+	Vector<u8> dirty(nrNodes);
+	for (u32 k = 0; k < nrNodes; k++)
+	{
+		const u32 index = _indices[order[k]];
+		entities[k] = _entities[index];
+		components[k] = _components[index];
+		trs[k] = _trs[index];
+		dirty[k] = _dirty[index];
+	}
+
+	_sortedMatrices.resize(nrNodes);
+	for (u32 k = 0; k < nrNodes; k++)
+		_sortedMatrices[k] = _locals[_indices[order[k]]];
+	std::swap(_locals, _sortedMatrices);
+	for (u32 k = 0; k < nrNodes; k++)
+		_sortedMatrices[k] = _worlds[_indices[order[k]]];
+	std::swap(_worlds, _sortedMatrices);
+
+	for (u32 k = 0; k < nrNodes; k++)
+		_indices[order[k]] = k;
+
+	_parents.resize(nrNodes);
+	_dirtyIndices.clear();
+	for (u32 k = 0; k < nrNodes; k++)
+	{
+		const u32 parentNode = _parentIds[order[k]];
+		_parents[k] = parentNode != INVALID_NODE ? _indices[parentNode] : INVALID_NODE;
+		if (dirty[k])
+			_dirtyIndices.push_back(k);
+	}
+
+	// A subtree ends after the last subtree of its children
+	_subtreeEnds.resize(nrNodes);
+	for (u32 k = 0; k < nrNodes; k++)
+		_subtreeEnds[k] = k + 1;
+	for (u32 k = nrNodes; k-- > 0;)
+		if (_parents[k] != INVALID_NODE)
+			_subtreeEnds[_parents[k]] = std::max(_subtreeEnds[_parents[k]], _subtreeEnds[k]);
+
+	_ids = std::move(order);
+	_entities = std::move(entities);
+	_components = std::move(components);
+	_trs = std::move(trs);
+	_dirty = std::move(dirty);
+	_orderValid = true;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+#include "Engine/ECS/TransformCompose.hpp"
+#include <entt/entt.hpp>
+
+class Transform;
+
+/**
+ * @brief The parent-child relations of the `Transform` components of a registry, with their world matrices cached.
+ *
+ * The nodes are stored as arrays in depth-first order: a parent always comes before its children, and every subtree
+ * is a contiguous range of the arrays. `Update()` first composes the local matrices of the dirty nodes in one batch
+ * (see `TransformCompose`), then walks the ranges of the dirty nodes only, in one pass over each,
+ * which covers the dirty subtrees and nothing else. The recomputed world matrices are written to their `Transform`,
+ * through its address: the components are never moved (see `Transform::in_place_delete`).
+ *
+ * Adding, removing and reparenting nodes does not move the arrays: the order is rebuilt once, in linear time,
+ * by the next `Update()`.
+ *
+ * Each node has an identifier that does not change when the arrays are sorted again, kept by its `Transform`.
+ */
+class TransformHierarchy
+{
+public:
+	static constexpr u32 INVALID_NODE = UINT32_MAX;
+
+	TransformHierarchy();
+	~TransformHierarchy() = default;
+
+	/** @brief Delete copy constructor: the transforms and the registry keep a pointer to the hierarchy */
+	TransformHierarchy(const TransformHierarchy&) = delete;
+	TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+	/**
+	 * @brief Tracks the `Transform` components of the registry: each one gets a root node when constructed,
+	 * and loses its node when destroyed. Its children are then attached to its parent.
+	 */
+	void Connect(entt::registry& registry);
+
+	/** @brief Stops tracking the registry connected */
+	void Disconnect(entt::registry& registry);
+
+	/** @brief Removes every node */
+	void Clear();
+
+	/**
+	 * @brief Attaches the transform of an entity to the one of another entity: its transformation becomes relative to its parent.
+	 *
+	 * @param parent The new parent, `entt::null` to make the entity a root.
+	 * @return False if one of the entities has no transform, or if the parent is in the subtree of the entity.
+	 */
+	bool SetParent(entt::entity entity, entt::entity parent);
+
+	/** @return The parent of the entity, `entt::null` for a root or an entity with no transform */
+	entt::entity GetParent(entt::entity entity) const;
+
+	/** @return The number of ancestors of the entity */
+	u32 GetDepth(entt::entity entity) const;
+
+	/** @brief Sets the transformation of a node relative to its parent. Its matrices are computed by the next `Update()`. */
+	void SetLocal(u32 node, const TransformCompose::TRS& local);
+
+	/** @return The matrix of the node relative to its parent. Computed by the last `Update()`. */
+	const mat4f& GetLocal(u32 node) const { return _locals[_indices[node]]; }
+
+	/** @return The world matrix of the parent of the node, the identity for a root. Computed by the last `Update()`. */
+	mat4f GetParentWorld(u32 node) const;
+
+	/** @return The node of the entity, `INVALID_NODE` if it has no transform */
+	u32 FindNode(entt::entity entity) const;
+
+	/** @brief Computes the world matrices of the dirty subtrees and writes them to the `Transform` of their entity */
+	void Update();
+
+	/** @return The number of nodes */
+	u32 GetNumNodes() const { return static_cast<u32>(_entityNodes.size()); }
+
+	/** @return The number of world matrices computed by the last `Update()` */
+	u32 GetNumUpdated() const { return static_cast<u32>(_updated.size()); }
+
+private:
+	void OnConstruct(entt::registry& registry, entt::entity entity);
+	void OnUpdate(entt::registry& registry, entt::entity entity);
+	void OnDestroy(entt::registry& registry, entt::entity entity);
+
+	u32 AddNode(entt::entity entity, Transform& transform);
+	void RemoveNode(u32 node);
+
+	/** @brief Adds the node at this position to the dirty ones, once */
+	void MarkDirty(u32 index);
+
+	/** @return Whether the node was removed since the last order rebuild */
+	bool IsRemoved(u32 node) const { return _ids[_indices[node]] != node; }
+
+	/** @return The parent of the node, skipping the parents removed since the last order rebuild */
+	u32 FindParentNode(u32 node) const;
+
+	/** @brief Sorts the arrays in depth-first order again, dropping the removed nodes. */
+	void RebuildOrder();
+
+	// By node identifier
+	/** @brief The position of the node in the arrays, `INVALID_NODE` for a free identifier */
+	Vector<u32> _indices;
+	Vector<u32> _parentIds;
+	Vector<u32> _freeIds;
+	/** @brief Removed since the last order rebuild: freed by the rebuild */
+	Vector<u32> _removedIds;
+	UnorderedMap<entt::entity, u32> _entityNodes;
+
+	// In depth-first order
+	Vector<u32> _ids;
+	/** @brief The position of the parent in the arrays, `INVALID_NODE` for a root */
+	Vector<u32> _parents;
+	/** @brief The position after the last node of the subtree */
+	Vector<u32> _subtreeEnds;
+	Vector<entt::entity> _entities;
+	Vector<Transform*> _components;
+	Vector<TransformCompose::TRS> _trs;
+	Vector<mat4f> _locals;
+	Vector<mat4f> _worlds;
+	Vector<u8> _dirty;
+
+	/** @brief The positions of the dirty nodes, each one once */
+	Vector<u32> _dirtyIndices;
+	bool _orderValid;
+
+	/** @brief Kept between order rebuilds, so that the arrays are not allocated again */
+	Vector<mat4f> _sortedMatrices;
+
+	/** @brief Positions computed by the last `Update()` */
+	Vector<u32> _updated;
+};
@@ -3,12 +3,15 @@
 #include "Core/GL.hpp"
 #include "Core/Math/Ext.hpp"
 #include "Core/Log/Logger.hpp"
+#include "Core/Thread/JobSystem.hpp"
 
 #include "Engine/Globals.hpp"
 #include "Engine/Camera.hpp"
 #include "Engine/Scene.hpp"
 
 #include "Engine/ECS/ECS.hpp"
+#include "Engine/ECS/ChangeObserver.hpp"
+#include "Engine/ECS/Animation/AnimationSystem.hpp"
 #include "Engine/Graphics/Vertex.hpp"
 #include "Engine/Graphics/DepthTest.hpp"
 #include "Engine/Graphics/StencilTest.hpp"
@@ -16,12 +19,14 @@
 #include "Engine/Graphics/Objects/RenderBuffer.hpp"
 #include "Engine/Graphics/Objects/TextureCubemap.hpp"
 #include "Engine/Graphics/Renderer.hpp"
+#include "Engine/ECS/Animation/BakedClip.hpp"
 #include "Engine/Subsystems/WindowManager.hpp"
 #include "Engine/Subsystems/ShadersManager.hpp"
 #include "Engine/Subsystems/TexturesManager.hpp"
 #include "Engine/Subsystems/ModelsManager.hpp"
 #include "Engine/Subsystems/AnimationsManager.hpp"
 #include "Engine/Filesystem/Filesystem.hpp"
+#include "Engine/IniFileHandler.hpp"
 
 #include "GUI/ImGuiLayer.hpp"
 
@@ -41,6 +46,25 @@ static i32 frameRate = 0; // How many frames generated per seconds
 static f64 totalDeltasPerSecond = 0.0f;
 static f64 avgTime = 0.0f; // The average rendering time per seconds
 
+static constexpr f32 BAKED_FRAMES_PER_SECOND = 30.0f; // Sample rate of the baked clips
+static constexpr f32 GPU_VALIDATION_TOLERANCE = 1e-3f; // Largest difference between the GPU and CPU palettes
+
+/** @brief A skinned entity to draw once the palettes of the frame are uploaded */
+struct SkinnedDraw
+{
+  const SkeletalMesh* skeleton;
+  mat4f model;
+  u32 boneOffset;
+  i32 morphOffset;
+};
+
+/** @brief The crowd instances of a skeletal mesh, drawn in one instanced call */
+struct BakedBatch
+{
+  const SkeletalMesh* skeleton;
+  Vector<BakedInstance> instances;
+};
+
 static void GLAPIENTRY MessageCallback(GLenum source, 
                                        GLenum type, 
                                        GLuint id, 
@@ -262,6 +286,14 @@ static VertexArray CreateGridPlane()
   grid.numIndices = 0;
 	return grid;  
 }
+/** @return The first component of the type in the registry, the fallback when there is none */
+template<typename T>
+static const T& GetFirstComponent(entt::registry& registry, const T& fallback)
+{
+  auto view = registry.view<T>();
+  return view.empty() ? fallback : view.template get<T>(view.front());
+}
+
 static FrameBuffer CreateDepthMapFbo(i32 width, i32 height)
 {
   // Create a 2D texture that we'll use as the framebuffer's depth buffer
@@ -331,6 +363,22 @@ void Engine::Initialize()
   CONSOLE_INFO("Initializing ShadersManager...");
   ShadersManager::Get().Initialize();
 
+  // Read the animation settings
+  // ----------------------------
+  {
+    IniFileHandler config(Filesystem::GetRootPath() / "Configuration.ini");
+    config.ReadData();
+    _gpuAnimationEvaluation = std::atoi(config.GetValue("Animation", "gpu-evaluation").c_str()) != 0;
+    _gpuAnimationValidation = std::atoi(config.GetValue("Animation", "gpu-validation").c_str()) != 0;
+
+    // The compute shader samples cooked clips: cooked once when loaded rather than for the GPU only
+    if (_gpuAnimationEvaluation)
+    {
+      CONSOLE_INFO("Animations evaluated on the GPU{}", _gpuAnimationValidation ? ", validated on the CPU" : "");
+      AnimationsManager::Get().SetCookedSampleRate(GpuAnimationEvaluator::COOKED_FRAMES_PER_SECOND);
+    }
+  }
+
   // Initialize texture manager
   // --------------------------
   CONSOLE_INFO("Initializing TexturesManager...");
@@ -373,17 +421,22 @@ void Engine::Initialize()
     _uboLightBlock.UpdateStorage(sizeof(dl) + sizeof(pl), sizeof(sl), reinterpret_cast<void*>(&sl));
     _uboLightBlock.BindBase(BufferTarget::UNIFORM, 1); // "LightBlock" to binding point 1
   }
-  // Init UBO BoneBlock
+  // Init SSBO BoneBlock
   {
-    Array<mat4f, SkeletalMesh::GetMaxNumBones()> bones{};
-    std::fill(bones.begin(), bones.end(), mat4f(1.0f));
-
-    _uboBoneBlock = Buffer(
-      SkeletalMesh::GetMaxNumBones() * sizeof(mat4f), // Reserve memory for 100 mat4f
-      bones.data(),                                   // Fill with mat4f(1.0f)
-      BufferUsage::STREAM_DRAW                        // Data store content will be modified repeatedly and used many times.
-    );
-    _uboBoneBlock.BindBase(BufferTarget::UNIFORM, 2); // "BoneBlock" to binding point 2
+    // Each skinned entity keeps its palette in its own range, the draw calls pass the offset of their range
+    _bonePalettes.Create(64 * 64);
+    if (_gpuAnimationEvaluation)
+      _gpuAnimations.Create(ShadersManager::Get().GetProgram("AnimationEval"));
+  }
+  // Init SSBO MorphBlock
+  {
+    _morphTargets.Create(ShadersManager::Get().GetProgram("MorphTargets"));
+  }
+  // Init SSBO InstanceBlock
+  {
+    // Grows to the largest crowd drawn, the instances of each skeletal mesh are uploaded before its draw call
+    _bakedInstancesSize = 64 * sizeof(BakedInstance);
+    _ssboBakedInstances = Buffer(_bakedInstancesSize, nullptr, BufferUsage::STREAM_DRAW);
   }
 
 
@@ -416,6 +469,17 @@ void Engine::Run()
   // Create scene
   Scene scene((Filesystem::GetRootPath() / "Scene.ini"));
 
+  // The light block is uploaded again only when a light of the scene changed
+  ChangeObserver<DirectionalLight, PointLight, SpotLight> lightChanges;
+  lightChanges.Connect(scene.Reg());
+  bool lightsUploaded = false;
+
+  // Animations are updated on the worker threads before rendering
+  AnimationSystem animationSystem;
+  animationSystem.SetGpuEvaluation(_gpuAnimationEvaluation);
+  JobSystem& jobSystem = JobSystem::Get();
+  CONSOLE_INFO("Animation update running on {} threads", jobSystem.GetNumThreads());
+
   // ----------------------------------------------------------------------
   // -------------------------- Pre-loop section --------------------------
   // ----------------------------------------------------------------------
@@ -431,6 +495,14 @@ void Engine::Run()
   Program sceneShadowsProgram = shadersManager.GetProgram("SceneShadows");
   Program skeletalAnimProgram = shadersManager.GetProgram("SkeletalAnim");
   Program skeletalAnimShadowsProgram = shadersManager.GetProgram("SkeletalAnimShadows");
+  Program skeletalAnimBakedProgram = shadersManager.GetProgram("SkeletalAnimBaked");
+
+  // The visible skinned entities of the frame, kept from one frame to the next
+  Vector<SkinnedDraw> skinnedDraws;
+
+  // The crowds are grouped by skeletal mesh id, the instance arrays are kept from one frame to the next
+  Map<u32, BakedBatch> bakedBatches;
+  f64 bakedTime = 0.0;
 
   constexpr bool renderTerrain = false;
   constexpr bool renderInfiniteGrid = true;
@@ -440,11 +512,16 @@ void Engine::Run()
   bool shadowMode = false;
   bool wireframeMode = false;
 
+  // The lights of a scene with no light of their type
   DirectionalLight directionalLight;
   directionalLight.intensity = 1.0f;
   PointLight pointLight;
   SpotLight spotLight;
 
+  // The camera block is uploaded again only when the view or the projection changed
+  mat4f uploadedCameraView(0.0f);
+  mat4f uploadedCameraProj(0.0f);
+
   // ------------------------------------------------------------------
   // -------------------------- loop section --------------------------
   // ------------------------------------------------------------------
@@ -493,15 +570,37 @@ void Engine::Run()
     primaryCamera.UpdateOrientation();
     mat4f cameraView = primaryCamera.CalculateView(primaryCamera.position + primaryCamera.GetFrontVector());
     mat4f cameraProj = primaryCamera.CalculatePerspective(static_cast<f32>(_viewportSize.x) / static_cast<f32>(_viewportSize.y));
-    _uboCameraBlock.UpdateStorage(0, sizeof(cameraView), reinterpret_cast<void*>(&cameraView[0]));
-    _uboCameraBlock.UpdateStorage(sizeof(cameraView), sizeof(cameraProj), reinterpret_cast<void*>(&cameraProj[0]));
+    if (cameraView != uploadedCameraView || cameraProj != uploadedCameraProj)
+    {
+      _uboCameraBlock.UpdateStorage(0, sizeof(cameraView), reinterpret_cast<void*>(&cameraView[0]));
+      _uboCameraBlock.UpdateStorage(sizeof(cameraView), sizeof(cameraProj), reinterpret_cast<void*>(&cameraProj[0]));
+      uploadedCameraView = cameraView;
+      uploadedCameraProj = cameraProj;
+    }
 
+    // The first light of each type in the scene (see ChangeObserver: the inspector patches the lights it edits)
+    // The shadows are cast by the directional light used for the shading
+    const DirectionalLight& sceneDirectionalLight = GetFirstComponent(scene.Reg(), directionalLight);
     directLightCamera.UpdateOrientation();
     mat4f directLightProjection = directLightCamera.CalculateOrtho();
-    mat4f directLightView = directLightCamera.CalculateView(directionalLight.direction);
-    _uboLightBlock.UpdateStorage(0, sizeof(DirectionalLight), reinterpret_cast<void*>(&directionalLight));
-    _uboLightBlock.UpdateStorage(sizeof(DirectionalLight), sizeof(PointLight), reinterpret_cast<void*>(&pointLight));
-    _uboLightBlock.UpdateStorage(sizeof(DirectionalLight) + sizeof(PointLight), sizeof(SpotLight), reinterpret_cast<void*>(&spotLight));
+    mat4f directLightView = directLightCamera.CalculateView(sceneDirectionalLight.direction);
+
+    if (!lightsUploaded || !lightChanges.IsEmpty())
+    {
+      const PointLight& scenePointLight = GetFirstComponent(scene.Reg(), pointLight);
+      const SpotLight& sceneSpotLight = GetFirstComponent(scene.Reg(), spotLight);
+      _uboLightBlock.UpdateStorage(0, sizeof(DirectionalLight), &sceneDirectionalLight);
+      _uboLightBlock.UpdateStorage(sizeof(DirectionalLight), sizeof(PointLight), &scenePointLight);
+      _uboLightBlock.UpdateStorage(sizeof(DirectionalLight) + sizeof(PointLight), sizeof(SpotLight), &sceneSpotLight);
+      lightChanges.Clear();
+      lightsUploaded = true;
+    }
+
+    // The world matrices of the transforms moved since the last frame, and of their children
+    scene.UpdateTransforms();
+
+    animationSystem.SetViewpoint(primaryCamera.position, primaryCamera.fov);
+    animationSystem.Update(scene.Reg(), static_cast<f32>(delta), jobSystem);
 
     // -----------------------------------------------------------------------
     // -------------------------- Rendering section --------------------------
@@ -604,18 +703,115 @@ void Engine::Run()
         skeletalAnimProgram.Use();
         skeletalAnimProgram.SetUniform3f("u_viewPos", primaryCamera.position);
         skeletalAnimProgram.SetUniform1i("u_useNormalMap", normalMapMode);
-        scene.Reg().view<SkeletalMesh, Animator, Transform>().each([&](auto& skeletalMesh, auto& animator, auto& transform) 
+        _bonePalettes.BeginFrame();
+        _gpuAnimations.BeginFrame();
+        _morphTargets.BeginFrame();
+        skinnedDraws.clear();
+        const mat4f cameraViewProj = cameraProj * cameraView;
+        scene.Reg().view<SkeletalMesh, Animator, Transform>().each([&](entt::entity entity, auto& skeletalMesh, auto& animator, auto& transform) 
         {
-          animator.UpdateAnimation(delta);
-          const auto& boneTransforms = animator.boneTransforms;
-
-          _uboBoneBlock.UpdateStorage(0,
-                                      animator.nrBoneTransforms * sizeof(mat4f),
-                                      boneTransforms.get());
+          // Only the targets with a non-zero weight are dispatched
+          const auto GetMorphOffset = [&]() -> i32 {
+            const MorphWeights* morphWeights = scene.Reg().try_get<MorphWeights>(entity);
+            if (!morphWeights || !skeletalMesh.morphTargets || morphWeights->weights.size() < skeletalMesh.morphTargets->GetNumTargets())
+              return MorphTargetBuffer::NO_MORPH;
+            return _morphTargets.Update(*skeletalMesh.morphTargets, morphWeights->weights.data());
+          };
+
+          // The palette is written by the compute shader. Not culled: the bounds on the CPU are those of the last CPU update
+          if (animator.evaluatedOnGpu)
+          {
+            u32 boneOffset = _bonePalettes.Reserve(static_cast<u64>(entity), animator.nrBoneTransforms);
+            _gpuAnimations.AddInstance(animator, boneOffset);
+            skinnedDraws.push_back(SkinnedDraw{ &skeletalMesh, transform.GetTransformation(), boneOffset, GetMorphOffset() });
+            return;
+          }
+
+          // Skip the characters out of the view: their bounds follow the animation
+          const AABB& bounds = animator.GetBounds();
+          if (!bounds.IsEmpty() && !bounds.Transformed(transform.GetTransformation()).IntersectsFrustum(cameraViewProj))
+            return;
+
+          // Copy the palette only if it changed since the last one, otherwise draw from the GPU copy
+          u32 boneOffset = _bonePalettes.Update(static_cast<u64>(entity),
+                                                animator.GetPaletteVersion(),
+                                                animator.GetPalette(),
+                                                animator.nrBoneTransforms);
+          skinnedDraws.push_back(SkinnedDraw{ &skeletalMesh, transform.GetTransformation(), boneOffset, GetMorphOffset() });
+        });
 
-          skeletalAnimProgram.SetUniformMat4f("u_model", transform.GetTransformation());
-          skeletalMesh.Draw(RenderMode::TRIANGLES);
+        // One upload for every palette of the frame, then the draw calls only change the offset
+        _bonePalettes.EndFrame();
+        if (_gpuAnimations.GetNumInstances() > 0)
+        {
+          // The compute shader writes its palettes over the upload, then the program of the draw calls is restored
+          _gpuAnimations.Dispatch(_bonePalettes);
+          if (_gpuAnimationValidation)
+          {
+            GpuAnimationEvaluator::ValidationResult result = _gpuAnimations.Validate(_bonePalettes, GPU_VALIDATION_TOLERANCE);
+            if (result.nrMismatches > 0)
+              CONSOLE_ERROR("GPU animation: {}/{} palettes differ from the CPU (max error {})", result.nrMismatches, result.nrInstances, result.maxError);
+          }
+          skeletalAnimProgram.Use();
+        }
+        if (_morphTargets.GetNumVertices() > 0)
+        {
+          _morphTargets.Dispatch();
+          skeletalAnimProgram.Use();
+        }
+        _bonePalettes.Bind(2); // "BoneBlock" to binding point 2
+        _morphTargets.Bind(MorphTargetBuffer::MORPH_BLOCK_BINDING); // "MorphBlock" to binding point 10
+        for (const SkinnedDraw& draw : skinnedDraws)
+        {
+          skeletalAnimProgram.SetUniformMat4f("u_model", draw.model);
+          skeletalAnimProgram.SetUniform1i("u_boneOffset", static_cast<i32>(draw.boneOffset));
+          skeletalAnimProgram.SetUniform1i("u_morphOffset", draw.morphOffset);
+          draw.skeleton->Draw(RenderMode::TRIANGLES);
+        }
+
+        // Baked crowds: no animation work on the CPU, the palettes are fetched from the baked clips
+        for (auto& [id, batch] : bakedBatches)
+          batch.instances.clear();
+        scene.Reg().view<SkeletalMesh, BakedAnimator, Transform>().each([&](auto& skeletalMesh, auto& bakedAnimator, auto& transform)
+        {
+          const BakedAnimationTexture& bakedAnimations = GetBakedAnimations(skeletalMesh);
+          if (!bakedAnimations.IsValid())
+            return;
+
+          BakedBatch& batch = bakedBatches[skeletalMesh.id];
+          batch.skeleton = &skeletalMesh;
+          batch.instances.push_back(BakedInstance{
+            transform.GetTransformation(),
+            bakedAnimations.GetClipData(bakedAnimator.clip),
+            vec4f(bakedAnimator.timeOffset, bakedAnimator.speed, 0.0f, 0.0f)
+          });
         });
+
+        bakedTime += delta;
+        skeletalAnimBakedProgram.Use();
+        skeletalAnimBakedProgram.SetUniform3f("u_viewPos", primaryCamera.position);
+        skeletalAnimBakedProgram.SetUniform1i("u_useNormalMap", normalMapMode);
+        skeletalAnimBakedProgram.SetUniform1f("u_time", static_cast<f32>(bakedTime));
+        for (auto& [id, batch] : bakedBatches)
+        {
+          if (batch.instances.empty())
+            continue;
+
+          u64 size = batch.instances.size() * sizeof(BakedInstance);
+          if (size > _bakedInstancesSize)
+          {
+            _bakedInstancesSize = size;
+            _ssboBakedInstances.CreateStorage(size, batch.instances.data(), BufferUsage::STREAM_DRAW);
+          }
+          else
+          {
+            _ssboBakedInstances.UpdateStorage(0, static_cast<u32>(size), batch.instances.data());
+          }
+          _ssboBakedInstances.BindBase(BufferTarget::SHADER_STORAGE, 3); // "InstanceBlock" to binding point 3
+          _bakedAnimations.at(id).BindTextureUnit(3);
+
+          batch.skeleton->DrawInstanced(RenderMode::TRIANGLES, static_cast<i32>(batch.instances.size()));
+        }
       }
 
       /// Render the infinite grid
@@ -656,6 +852,7 @@ void Engine::Run()
     //gui.RenderContentBrowser();
     //gui.RenderGizmoToolBar(objSelected);
     gui.RenderTimeInfo(delta, avgTime, frameRate);
+    gui.RenderAnimationInfo(animationSystem, _bonePalettes, _morphTargets);
     //gui.RenderGraphicsInfo();
     //gui.RenderDemo();
     //gui.RenderDebug(shadowMode, normalMapMode, wireframeMode);
@@ -677,6 +874,7 @@ void Engine::Run()
   }
 
   scene.Clear();
+  lightChanges.Disconnect();
  
   gridPlane.Delete();
   skybox.Delete();
@@ -690,7 +888,13 @@ void Engine::CleanUp()
   _screenSquare.Delete();
   _uboCameraBlock.Delete();
   _uboLightBlock.Delete();
-  _uboBoneBlock.Delete();
+  _bonePalettes.Delete();
+  _gpuAnimations.Delete();
+  _morphTargets.Delete();
+  _ssboBakedInstances.Delete();
+  for (auto& [id, bakedAnimations] : _bakedAnimations)
+    bakedAnimations.Delete();
+  _bakedAnimations.clear();
 
   ImGuiLayer::Get().CleanUp();
   ShadersManager::Get().CleanUp();
@@ -762,3 +966,30 @@ void Engine::CreateScreenSquare()
   _screenSquare.numVertices = 6;
   _screenSquare.numIndices = 0;
 }
+
+const BakedAnimationTexture& Engine::GetBakedAnimations(const SkeletalMesh& skeleton)
+{
+  auto it = _bakedAnimations.find(skeleton.id);
+  if (it != _bakedAnimations.end())
+    return it->second;
+
+  // Bake every clip of the skeleton once: the instances switch clips without baking again
+  BakedAnimationTexture& bakedAnimations = _bakedAnimations[skeleton.id];
+  const Vector<const Animation*>* animations = AnimationsManager::Get().GetSkeletonAnimations(skeleton.id);
+  if (!animations || animations->empty())
+  {
+    CONSOLE_WARN("Skeletal mesh {} has no animation to bake", skeleton.id);
+    return bakedAnimations;
+  }
+
+  auto t0 = chrono::steady_clock::now();
+  Vector<BakedClip> clips(animations->size());
+  for (u32 i = 0; i < clips.size(); i++)
+    clips[i].Create(skeleton, *animations->at(i), BAKED_FRAMES_PER_SECOND);
+  bakedAnimations.Create(clips.data(), static_cast<u32>(clips.size()));
+
+  auto t1 = chrono::steady_clock::now();
+  CONSOLE_INFO("Baked {} animations for skeleton {} in {:.2f} ms", clips.size(), skeleton.id, chrono::duration<f64, std::milli>(t1 - t0).count());
+
+  return bakedAnimations;
+}
\ No newline at end of file
@@ -4,9 +4,15 @@
 #include "Core/Math/Base.hpp"
 
 #include "Engine/Graphics/Objects/Buffer.hpp"
+#include "Engine/Graphics/BonePaletteBuffer.hpp"
+#include "Engine/Graphics/GpuAnimationEvaluator.hpp"
+#include "Engine/Graphics/MorphTargetBuffer.hpp"
+#include "Engine/Graphics/BakedAnimationTexture.hpp"
 #include "Engine/Graphics/Containers/VertexArray.hpp"
 #include "Engine/Graphics/Containers/FrameBuffer.hpp"
 
+class SkeletalMesh;
+
 class Engine
 {
 public:
@@ -21,12 +27,23 @@ private:
 	void CreateFramebuffer(i32 samples, i32 width, i32 height);
 	void CreateScreenSquare();
 
+	/** @brief Returns the baked clips of the skeletal mesh, baking them the first time it is drawn as a crowd */
+	const BakedAnimationTexture& GetBakedAnimations(const SkeletalMesh& skeleton);
+
 	FrameBuffer _fboMultisampled;
 	FrameBuffer _fboIntermediate;
 
 	Buffer _uboCameraBlock;	// UBO "CameraBlock"
 	Buffer _uboLightBlock;	// UBO "LightBlock"
-	Buffer _uboBoneBlock;		// UBO "BoneBlock"
+	BonePaletteBuffer _bonePalettes; // SSBO "BoneBlock", the palettes of every skinned entity of the frame
+	GpuAnimationEvaluator _gpuAnimations; // Writes the palettes of the animators evaluated on the GPU to "BoneBlock"
+	MorphTargetBuffer _morphTargets; // SSBO "MorphBlock", the weighted morph targets of every entity of the frame
+	bool _gpuAnimationEvaluation{ false }; // Configuration.ini [Animation] gpu-evaluation
+	bool _gpuAnimationValidation{ false }; // Configuration.ini [Animation] gpu-validation: compares with the CPU every frame
+	Buffer _ssboBakedInstances; // SSBO "InstanceBlock", the instances of a baked crowd
+	u64 _bakedInstancesSize{ 0 };
+
+	Map<u32, BakedAnimationTexture> _bakedAnimations; // Baked clips of each skeletal mesh, by id
 
 	VertexArray _screenSquare;
 	vec2i _viewportSize;
@@ -0,0 +1,166 @@
+#include "MappedFile.hpp"
+
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+#if defined(_WIN32)
+MappedFile::MappedFile() :
+	_data{ nullptr },
+	_size{ 0 },
+	_file{ INVALID_HANDLE_VALUE },
+	_mapping{ nullptr }
+{
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+	_data{ std::exchange(other._data, nullptr) },
+	_size{ std::exchange(other._size, 0) },
+	_file{ std::exchange(other._file, INVALID_HANDLE_VALUE) },
+	_mapping{ std::exchange(other._mapping, nullptr) }
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		_data = std::exchange(other._data, nullptr);
+		_size = std::exchange(other._size, 0);
+		_file = std::exchange(other._file, INVALID_HANDLE_VALUE);
+		_mapping = std::exchange(other._mapping, nullptr);
+	}
+	return *this;
+}
+
+bool MappedFile::Open(const fs::path& path)
+{
+	Close();
+
+	_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	_mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!_mapping)
+	{
+		Close();
+		return false;
+	}
+
+	_data = static_cast<const u8*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!_data)
+	{
+		Close();
+		return false;
+	}
+
+	_size = static_cast<u64>(size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_file != INVALID_HANDLE_VALUE)
+		CloseHandle(_file);
+
+	_data = nullptr;
+	_size = 0;
+	_mapping = nullptr;
+	_file = INVALID_HANDLE_VALUE;
+}
+#else
+MappedFile::MappedFile() :
+	_data{ nullptr },
+	_size{ 0 },
+	_file{ -1 }
+{
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+	_data{ std::exchange(other._data, nullptr) },
+	_size{ std::exchange(other._size, 0) },
+	_file{ std::exchange(other._file, -1) }
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		_data = std::exchange(other._data, nullptr);
+		_size = std::exchange(other._size, 0);
+		_file = std::exchange(other._file, -1);
+	}
+	return *this;
+}
+
+bool MappedFile::Open(const fs::path& path)
+{
+	Close();
+
+	_file = open(path.c_str(), O_RDONLY);
+	if (_file == -1)
+		return false;
+
+	struct stat info {};
+	if (fstat(_file, &info) != 0 || info.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+
+	void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, _file, 0);
+	if (data == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	_data = static_cast<const u8*>(data);
+	_size = static_cast<u64>(info.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (_data)
+		munmap(const_cast<u8*>(_data), static_cast<size_t>(_size));
+	if (_file != -1)
+		close(_file);
+
+	_data = nullptr;
+	_size = 0;
+	_file = -1;
+}
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Core/Core.hpp"
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ * The content is paged in by the operating system on access instead of being read into a buffer.
+ */
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile() { Close(); }
+
+	/** @brief Move constructor */
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	/** @brief Delete copy constructor */
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/**
+	 * @brief Maps the file in memory. Any previous mapping is closed.
+	 *
+	 * @return False if the file does not exist, is empty or cannot be mapped.
+	 */
+	bool Open(const fs::path& path);
+
+	/** @brief Unmaps the file */
+	void Close();
+
+	bool IsOpen() const { return _data != nullptr; }
+
+	const u8* GetData() const { return _data; }
+	u64 GetSize() const { return _size; }
+
+private:
+	const u8* _data;
+	u64 _size;
+
+#if defined(_WIN32)
+	void* _file;
+	void* _mapping;
+#else
+	i32 _file;
+#endif
+};
@@ -0,0 +1,72 @@
+#include "BakedAnimationTexture.hpp"
+
+#include "Core/GL.hpp"
+#include "Core/Log/Logger.hpp"
+#include "Engine/ECS/Animation/BakedClip.hpp"
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+BakedAnimationTexture::BakedAnimationTexture() :
+	_texture{},
+	_clips{},
+	_memorySize{ 0 }
+{
+}
+
+void BakedAnimationTexture::Create(const BakedClip* clips, u32 nrClips)
+{
+	i32 maxSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+	// The clips are stacked: each one starts on the row following the previous one
+	u32 width = 0;
+	u32 height = 0;
+	_clips.clear();
+	for (u32 i = 0; i < nrClips; i++)
+	{
+		const BakedClip& clip = clips[i];
+		assert(clip.IsValid());
+		if (height + clip.GetNumFrames() > static_cast<u32>(maxSize) || clip.GetWidth() > static_cast<u32>(maxSize))
+		{
+			CONSOLE_WARN("Baked animation texture full: {} of {} clips baked", i, nrClips);
+			break;
+		}
+
+		width = std::max(width, clip.GetWidth());
+		_clips.push_back(Clip{ height, clip.GetNumFrames(), clip.GetDuration() });
+		height += clip.GetNumFrames();
+	}
+	if (_clips.empty())
+		return;
+
+	_texture.Create(Texture2DTarget::TEXTURE_2D);
+	_texture.SetParameteri(TextureParameteriName::MIN_FILTER, TextureParameteriParam::NEAREST);
+	_texture.SetParameteri(TextureParameteriName::MAG_FILTER, TextureParameteriParam::NEAREST);
+	_texture.SetParameteri(TextureParameteriName::WRAP_S, TextureParameteriParam::CLAMP_TO_EDGE);
+	_texture.SetParameteri(TextureParameteriName::WRAP_T, TextureParameteriParam::CLAMP_TO_EDGE);
+	_texture.CreateStorage(Texture2DInternalFormat::RGBA32F, width, height, 1);
+	for (u32 i = 0; i < _clips.size(); i++)
+	{
+		const BakedClip& clip = clips[i];
+		_texture.UpdateStorage(0, clip.GetWidth(), clip.GetNumFrames(), Texture2DFormat::RGBA, Texture2DSubImageType::FLOAT, clip.GetTexels(), 0, _clips[i].firstFrame);
+	}
+
+	_memorySize = static_cast<u64>(width) * height * sizeof(vec4f);
+	CONSOLE_INFO("Baked {} clips in a {}x{} animation texture ({} KB)", _clips.size(), width, height, _memorySize / 1024);
+}
+
+void BakedAnimationTexture::Delete()
+{
+	if (_texture.id != 0)
+		_texture.Delete();
+	_clips.clear();
+	_memorySize = 0;
+}
+
+vec4f BakedAnimationTexture::GetClipData(u32 clip) const
+{
+	const Clip& range = clip < _clips.size() ? _clips[clip] : _clips.front();
+	return vec4f(static_cast<f32>(range.firstFrame), static_cast<f32>(range.nrFrames), range.duration, 0.0f);
+}
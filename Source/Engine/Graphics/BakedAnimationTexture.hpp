@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+#include "Engine/Graphics/Objects/Texture2D.hpp"
+
+class BakedClip;
+
+/**
+ * @brief Per-instance data of the "InstanceBlock" storage block of "SkeletalAnimBaked.vert", std430 layout.
+ */
+struct BakedInstance
+{
+	mat4f model;
+
+	/** @brief The clip played: first frame in the texture, number of frames, duration in seconds. */
+	vec4f clip;
+
+	/** @brief The playback: time offset in seconds, speed. */
+	vec4f playback;
+};
+
+/**
+ * @brief Texture holding the baked clips of a skeleton, one under the other, sampled by "SkeletalAnimBaked.vert".
+ *
+ * Each row holds the palette of one frame (see `BakedClip`), as RGBA32F texels fetched without filtering:
+ * the vertex shader interpolates the two frames around the playback time of each instance.
+ */
+class BakedAnimationTexture
+{
+public:
+	/** @brief The frames of a clip in the texture. */
+	struct Clip
+	{
+		u32 firstFrame;
+		u32 nrFrames;
+		f32 duration;
+	};
+
+	BakedAnimationTexture();
+	~BakedAnimationTexture() = default;
+
+	/**
+	 * @brief Creates the texture and uploads the clips.
+	 * Clips beyond the maximum texture height are left out, with a warning.
+	 *
+	 * @param clips The clips, all baked for the same skeleton.
+	 */
+	void Create(const BakedClip* clips, u32 nrClips);
+
+	/** @brief Deletes the texture */
+	void Delete();
+
+	void BindTextureUnit(i32 unit) const { _texture.BindTextureUnit(unit); }
+
+	/** @return The per-instance clip data of the clip (see `BakedInstance::clip`). A clip left out plays the first one. */
+	vec4f GetClipData(u32 clip) const;
+
+	u32 GetNumClips() const { return static_cast<u32>(_clips.size()); }
+	const Clip& GetClip(u32 clip) const { return _clips.at(clip); }
+
+	bool IsValid() const { return !_clips.empty(); }
+
+	/** @return The memory used by the texture, in bytes */
+	u64 GetMemorySize() const { return _memorySize; }
+
+private:
+	Texture2D _texture;
+	Vector<Clip> _clips;
+	u64 _memorySize;
+};
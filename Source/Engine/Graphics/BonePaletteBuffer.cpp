@@ -0,0 +1,181 @@
+#include "BonePaletteBuffer.hpp"
+
+#include "Core/GL.hpp"
+#include "Core/Log/Logger.hpp"
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+BonePaletteBuffer::BonePaletteBuffer() :
+	_buffer{},
+	_capacity{ 0 },
+	_palettes{},
+	_dirtyBegin{ 0 },
+	_dirtyEnd{ 0 },
+	_ranges{},
+	_ownerRanges{},
+	_freeOffsets{},
+	_frameIndex{ 0 },
+	_nrUploads{ 0 },
+	_nrSkippedUploads{ 0 }
+{
+}
+
+void BonePaletteBuffer::Create(u32 nrMatrices)
+{
+	_capacity = std::max(nrMatrices, 1u);
+	_palettes.clear();
+	_palettes.reserve(_capacity);
+	_dirtyBegin = _dirtyEnd = 0;
+	_ranges.clear();
+	_ownerRanges.clear();
+	_freeOffsets.clear();
+
+	_buffer.Create();
+	_buffer.CreateStorage(static_cast<u64>(_capacity) * sizeof(mat4f), nullptr, BufferUsage::DYNAMIC_DRAW);
+}
+
+void BonePaletteBuffer::Delete()
+{
+	_buffer.Delete();
+	_capacity = 0;
+	_palettes.clear();
+	_ranges.clear();
+	_ownerRanges.clear();
+	_freeOffsets.clear();
+}
+
+void BonePaletteBuffer::BeginFrame()
+{
+	_frameIndex++;
+	_nrUploads = 0;
+	_nrSkippedUploads = 0;
+}
+
+u32 BonePaletteBuffer::Update(u64 owner, u32 version, const mat4f* palette, u32 nrBones)
+{
+	u32 rangeIndex = AcquireRange(owner, nrBones);
+	Range& range = _ranges[rangeIndex];
+	range.lastFrame = _frameIndex;
+
+	if (range.version == version && version != INVALID_VERSION)
+	{
+		_nrSkippedUploads++;
+		return range.offset;
+	}
+
+	std::copy_n(palette, nrBones, _palettes.begin() + range.offset);
+	if (_dirtyBegin == _dirtyEnd)
+	{
+		_dirtyBegin = range.offset;
+		_dirtyEnd = range.offset + nrBones;
+	}
+	else
+	{
+		_dirtyBegin = std::min(_dirtyBegin, range.offset);
+		_dirtyEnd = std::max(_dirtyEnd, range.offset + nrBones);
+	}
+	range.version = version;
+	_nrUploads++;
+	return range.offset;
+}
+
+u32 BonePaletteBuffer::Reserve(u64 owner, u32 nrBones)
+{
+	u32 rangeIndex = AcquireRange(owner, nrBones);
+	Range& range = _ranges[rangeIndex];
+	range.lastFrame = _frameIndex;
+	range.version = INVALID_VERSION;
+	return range.offset;
+}
+
+void BonePaletteBuffer::EndFrame()
+{
+	const u32 size = static_cast<u32>(_palettes.size());
+	if (size > _capacity)
+	{
+		// The new storage is filled from the copy on the CPU: nothing to copy on the GPU
+		_capacity = std::max(size, _capacity * 2);
+		CONSOLE_INFO("Growing the bone palette buffer to {} matrices", _capacity);
+		_buffer.CreateStorage(static_cast<u64>(_capacity) * sizeof(mat4f), nullptr, BufferUsage::DYNAMIC_DRAW);
+		_dirtyBegin = 0;
+		_dirtyEnd = size;
+	}
+
+	// A single update for the frame: the unchanged palettes between two written ones are uploaded too
+	if (_dirtyBegin != _dirtyEnd)
+	{
+		_buffer.UpdateStorage(static_cast<i32>(_dirtyBegin * sizeof(mat4f)), static_cast<u32>((_dirtyEnd - _dirtyBegin) * sizeof(mat4f)), _palettes.data() + _dirtyBegin);
+		_dirtyBegin = _dirtyEnd = 0;
+	}
+
+	for (u32 i = 0; i < _ranges.size();)
+	{
+		if (_ranges[i].lastFrame != _frameIndex)
+			ReleaseRange(i);
+		else
+			i++;
+	}
+}
+
+void BonePaletteBuffer::Bind(i32 bindingpoint) const
+{
+	_buffer.BindBase(BufferTarget::SHADER_STORAGE, bindingpoint);
+}
+
+void BonePaletteBuffer::Read(u32 offset, u32 nrMatrices, mat4f* palette) const
+{
+	_buffer.GetStorage(static_cast<i32>(offset * sizeof(mat4f)), static_cast<u32>(nrMatrices * sizeof(mat4f)), palette);
+}
+
+// ----------------------------------------------------
+//										PRIVATE
+// ----------------------------------------------------
+
+u32 BonePaletteBuffer::AcquireRange(u64 owner, u32 nrBones)
+{
+	auto it = _ownerRanges.find(owner);
+	if (it != _ownerRanges.end())
+	{
+		if (_ranges[it->second].nrBones == nrBones)
+			return it->second;
+
+		// The owner changed of skeleton
+		ReleaseRange(it->second);
+	}
+
+	// Skeletons of the same model have the same number of bones: their released ranges are reused as they are
+	u32 offset;
+	Vector<u32>& freeOffsets = _freeOffsets[nrBones];
+	if (!freeOffsets.empty())
+	{
+		offset = freeOffsets.back();
+		freeOffsets.pop_back();
+	}
+	else
+	{
+		offset = static_cast<u32>(_palettes.size());
+		_palettes.resize(_palettes.size() + nrBones, mat4f(1.0f));
+	}
+
+	u32 rangeIndex = static_cast<u32>(_ranges.size());
+	_ranges.push_back(Range{ owner, offset, nrBones, INVALID_VERSION, _frameIndex });
+	_ownerRanges[owner] = rangeIndex;
+	return rangeIndex;
+}
+
+void BonePaletteBuffer::ReleaseRange(u32 rangeIndex)
+{
+	const Range& range = _ranges[rangeIndex];
+	_ownerRanges.erase(range.owner);
+	_freeOffsets[range.nrBones].push_back(range.offset);
+
+	// The last range takes the place of the released one
+	if (rangeIndex != _ranges.size() - 1)
+	{
+		_ranges[rangeIndex] = _ranges.back();
+		_ownerRanges[_ranges[rangeIndex].owner] = rangeIndex;
+	}
+	_ranges.pop_back();
+}
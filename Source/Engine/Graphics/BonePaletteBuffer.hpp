@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+#include "Engine/Graphics/Objects/Buffer.hpp"
+
+/**
+ * @brief Shader storage buffer holding the bone palettes of every skinned entity drawn in the frame.
+ *
+ * Each owner gets its own range of matrices, sized to its skeleton: there is no limit on the number
+ * of bones. The palettes are first copied to a copy of the buffer kept on the CPU, then the ranges written
+ * during the frame are uploaded at once by `EndFrame()`. The buffer is bound once as "BoneBlock", each draw
+ * call only passes the offset of its palette.
+ *
+ * A palette is copied only when its version differs from the one of the last copy, so paused or
+ * unchanged animators are drawn with the copy already on the GPU.
+ *
+ * Ranges of owners not drawn during a frame are released by `EndFrame()`.
+ */
+class BonePaletteBuffer
+{
+public:
+	/** @brief Version never returned by `Animator::GetPaletteVersion()`: forces the next upload. */
+	static constexpr u32 INVALID_VERSION = UINT32_MAX;
+
+	BonePaletteBuffer();
+	~BonePaletteBuffer() = default;
+
+	/**
+	 * @brief Creates the buffer.
+	 *
+	 * @param nrMatrices Initial size of the buffer, in matrices. The buffer grows when more palettes are drawn.
+	 */
+	void Create(u32 nrMatrices);
+
+	/** @brief Deletes the buffer and releases every range */
+	void Delete();
+
+	/** @brief Resets the upload counters. Must be called before the first `Update()` of the frame. */
+	void BeginFrame();
+
+	/**
+	 * @brief Copies the palette of the owner if its version changed since the last copy.
+	 * The palette reaches the GPU with the next `EndFrame()`.
+	 *
+	 * @param owner Identifier of the skinned entity.
+	 * @param version Version of the palette (see `Animator::GetPaletteVersion()`).
+	 * @param palette The palette, `nrBones` matrices.
+	 * @return The offset of the palette in the buffer, in matrices: the "u_boneOffset" of the draw call.
+	 */
+	u32 Update(u64 owner, u32 version, const mat4f* palette, u32 nrBones);
+
+	/**
+	 * @brief Keeps the range of the owner for a palette written on the GPU (see `GpuAnimationEvaluator`).
+	 * Nothing is uploaded for it, and the next `Update()` of the owner uploads its palette again.
+	 *
+	 * @return The offset of the palette in the buffer, in matrices.
+	 */
+	u32 Reserve(u64 owner, u32 nrBones);
+
+	/**
+	 * @brief Uploads the palettes copied since `BeginFrame()` with a single buffer update, then releases
+	 * the ranges of the owners not updated. Must be called before the draw calls using the palettes.
+	 */
+	void EndFrame();
+
+	/** @brief Binds the buffer to the indexed shader storage buffer target */
+	void Bind(i32 bindingpoint) const;
+
+	/** @brief Reads `nrMatrices` matrices back from the GPU, e.g. the palettes written by a compute shader. Waits for the GPU. */
+	void Read(u32 offset, u32 nrMatrices, mat4f* palette) const;
+
+	/** @return The number of palettes uploaded during the frame */
+	u32 GetNumUploads() const { return _nrUploads; }
+
+	/** @return The number of palettes drawn from their last upload during the frame */
+	u32 GetNumSkippedUploads() const { return _nrSkippedUploads; }
+
+	/** @return The number of matrices in use, released ranges included */
+	u32 GetNumMatrices() const { return static_cast<u32>(_palettes.size()); }
+
+private:
+	struct Range
+	{
+		u64 owner;
+		u32 offset;
+		u32 nrBones;
+		u32 version;
+		u64 lastFrame;
+	};
+
+	u32 AcquireRange(u64 owner, u32 nrBones);
+	void ReleaseRange(u32 rangeIndex);
+
+	Buffer _buffer;
+	u32 _capacity;
+
+	/** @brief Copy of the buffer on the CPU */
+	Vector<mat4f> _palettes;
+	u32 _dirtyBegin;
+	u32 _dirtyEnd;
+
+	Vector<Range> _ranges;
+	UnorderedMap<u64, u32> _ownerRanges;
+
+	/** @brief Offsets of the released ranges, by number of bones */
+	UnorderedMap<u32, Vector<u32>> _freeOffsets;
+
+	u64 _frameIndex;
+	u32 _nrUploads;
+	u32 _nrSkippedUploads;
+};
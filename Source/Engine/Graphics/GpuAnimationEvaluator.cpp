@@ -0,0 +1,259 @@
+#include "GpuAnimationEvaluator.hpp"
+
+#include "Core/GL.hpp"
+#include "Core/Log/Logger.hpp"
+#include "Engine/ECS/Animation/Animator.hpp"
+#include "Engine/Graphics/BonePaletteBuffer.hpp"
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+GpuAnimationEvaluator::GpuAnimationEvaluator() :
+	_program{},
+	_nodeBuffer{},
+	_frameBuffer{},
+	_instanceBuffer{},
+	_modelBuffer{},
+	_skeletons{},
+	_clips{},
+	_instances{},
+	_animators{},
+	_nrModelTransforms{ 0 }
+{
+}
+
+void GpuAnimationEvaluator::Create(const Program& program)
+{
+	_program = program;
+	_nodeBuffer.Create(256 * sizeof(GpuNode));
+	_frameBuffer.Create(1024 * 1024);
+	_instanceBuffer.Create(1024 * sizeof(GpuInstance));
+	_modelBuffer.Create(64 * 64 * sizeof(mat4f));
+}
+
+void GpuAnimationEvaluator::Delete()
+{
+	_nodeBuffer.Delete();
+	_frameBuffer.Delete();
+	_instanceBuffer.Delete();
+	_modelBuffer.Delete();
+	_skeletons.clear();
+	_clips.clear();
+	_instances.clear();
+	_animators.clear();
+	_nrModelTransforms = 0;
+}
+
+void GpuAnimationEvaluator::BeginFrame()
+{
+	_instances.clear();
+	_animators.clear();
+	_nrModelTransforms = 0;
+}
+
+void GpuAnimationEvaluator::AddInstance(Animator& animator, u32 paletteOffset)
+{
+	const SkeletalMesh& skeleton = *animator.GetTargetSkeleton();
+	const Animation& animation = *animator.GetAttachedAnimation();
+	const ClipEntry& clip = FindClip(skeleton, animation);
+
+	GpuInstance& instance = _instances.emplace_back();
+	instance.nodeOffset = FindSkeleton(skeleton);
+	instance.nrNodes = skeleton.nrNodes;
+	instance.frameOffset = clip.frameOffset;
+	instance.nrFrames = clip.nrFrames;
+	instance.nrBones = skeleton.nrBones;
+	instance.framesPerTick = clip.framesPerTick;
+	instance.time = animator.currentTime;
+	instance.paletteOffset = paletteOffset;
+	instance.modelOffset = _nrModelTransforms;
+
+	_nrModelTransforms += skeleton.nrNodes;
+	_animators.push_back(&animator);
+}
+
+void GpuAnimationEvaluator::Dispatch(const BonePaletteBuffer& palettes)
+{
+	if (_instances.empty())
+		return;
+
+	// The instances change every frame: the buffer is filled again, not appended to
+	const u64 instancesSize = _instances.size() * sizeof(GpuInstance);
+	if (instancesSize > _instanceBuffer.capacity)
+	{
+		_instanceBuffer.capacity = std::max(instancesSize, _instanceBuffer.capacity * 2);
+		_instanceBuffer.buffer.CreateStorage(_instanceBuffer.capacity, nullptr, BufferUsage::DYNAMIC_DRAW);
+	}
+	_instanceBuffer.buffer.UpdateStorage(0, static_cast<u32>(instancesSize), _instances.data());
+	_instanceBuffer.size = instancesSize;
+
+	// Scratch memory of the compute shader, nothing to keep
+	const u64 modelSize = static_cast<u64>(_nrModelTransforms) * sizeof(mat4f);
+	if (modelSize > _modelBuffer.capacity)
+	{
+		_modelBuffer.capacity = std::max(modelSize, _modelBuffer.capacity * 2);
+		_modelBuffer.buffer.CreateStorage(_modelBuffer.capacity, nullptr, BufferUsage::DYNAMIC_COPY);
+	}
+
+	_program.Use();
+	_program.SetUniform1i("u_nrInstances", static_cast<i32>(_instances.size()));
+	palettes.Bind(BONE_BLOCK_BINDING);
+	_nodeBuffer.buffer.BindBase(BufferTarget::SHADER_STORAGE, NODE_BLOCK_BINDING);
+	_frameBuffer.buffer.BindBase(BufferTarget::SHADER_STORAGE, CLIP_BLOCK_BINDING);
+	_instanceBuffer.buffer.BindBase(BufferTarget::SHADER_STORAGE, EVAL_INSTANCE_BLOCK_BINDING);
+	_modelBuffer.buffer.BindBase(BufferTarget::SHADER_STORAGE, MODEL_BLOCK_BINDING);
+
+	const u32 nrGroups = (static_cast<u32>(_instances.size()) + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+	glDispatchCompute(nrGroups, 1, 1);
+
+	// The vertex shaders read the palettes from the same storage buffer
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+GpuAnimationEvaluator::ValidationResult GpuAnimationEvaluator::Validate(const BonePaletteBuffer& palettes, f32 tolerance)
+{
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	ValidationResult result{};
+	Vector<mat4f> gpuPalette;
+	for (u32 i = 0; i < _animators.size(); i++)
+	{
+		Animator& animator = *_animators[i];
+		animator.EvaluatePose(animator.currentTime);
+
+		const u32 nrBones = animator.nrBoneTransforms;
+		gpuPalette.resize(nrBones);
+		palettes.Read(_instances[i].paletteOffset, nrBones, gpuPalette.data());
+
+		const mat4f* cpuPalette = animator.GetPalette();
+		f32 instanceError = 0.0f;
+		for (u32 bone = 0; bone < nrBones; bone++)
+		{
+			for (i32 column = 0; column < 4; column++)
+			{
+				for (i32 row = 0; row < 4; row++)
+				{
+					const f32 cpu = cpuPalette[bone][column][row];
+					const f32 gpu = gpuPalette[bone][column][row];
+					instanceError = std::max(instanceError, std::abs(gpu - cpu) / std::max(1.0f, std::abs(cpu)));
+				}
+			}
+		}
+
+		result.nrInstances++;
+		result.maxError = std::max(result.maxError, instanceError);
+		if (instanceError > tolerance)
+			result.nrMismatches++;
+	}
+	return result;
+}
+
+// ----------------------------------------------------
+//										PRIVATE
+// ----------------------------------------------------
+
+void GpuAnimationEvaluator::GrowingBuffer::Create(u64 initialCapacity)
+{
+	size = 0;
+	capacity = initialCapacity;
+	buffer.Create();
+	buffer.CreateStorage(capacity, nullptr, BufferUsage::STATIC_DRAW);
+}
+
+void GpuAnimationEvaluator::GrowingBuffer::Delete()
+{
+	buffer.Delete();
+	size = capacity = 0;
+}
+
+void GpuAnimationEvaluator::GrowingBuffer::Reserve(u64 newCapacity)
+{
+	if (newCapacity <= capacity)
+		return;
+
+	// The content is copied on the GPU: the CPU keeps no copy of the uploaded data
+	Buffer newBuffer;
+	newBuffer.Create();
+	newBuffer.CreateStorage(newCapacity, nullptr, BufferUsage::STATIC_DRAW);
+	if (size > 0)
+		buffer.CopyStorage(newBuffer, 0, 0, size);
+	buffer.Delete();
+	buffer = newBuffer;
+	capacity = newCapacity;
+}
+
+u64 GpuAnimationEvaluator::GrowingBuffer::Append(const void* data, u64 dataSize)
+{
+	if (size + dataSize > capacity)
+		Reserve(std::max(size + dataSize, capacity * 2));
+	const u64 offset = size;
+	buffer.UpdateStorage(static_cast<i32>(offset), static_cast<u32>(dataSize), data);
+	size += dataSize;
+	return offset;
+}
+
+u32 GpuAnimationEvaluator::FindSkeleton(const SkeletalMesh& skeleton)
+{
+	// The skeletons of the same model share their nodes: uploaded once
+	const BoneNode* nodes = skeleton.nodes.get();
+	auto it = _skeletons.find(nodes);
+	if (it != _skeletons.end())
+		return it->second;
+
+	Vector<GpuNode> gpuNodes(skeleton.nrNodes);
+	for (u32 i = 0; i < skeleton.nrNodes; i++)
+	{
+		gpuNodes[i].bindPose = nodes[i].bindPoseTransform;
+		gpuNodes[i].offset = nodes[i].offset;
+		gpuNodes[i].parent = nodes[i].parent;
+		gpuNodes[i].bone = nodes[i].index;
+		gpuNodes[i].pad[0] = gpuNodes[i].pad[1] = 0;
+	}
+
+	const u32 nodeOffset = static_cast<u32>(_nodeBuffer.Append(gpuNodes.data(), gpuNodes.size() * sizeof(GpuNode)) / sizeof(GpuNode));
+	_skeletons.emplace(nodes, nodeOffset);
+	return nodeOffset;
+}
+
+const GpuAnimationEvaluator::ClipEntry& GpuAnimationEvaluator::FindClip(const SkeletalMesh& skeleton, const Animation& animation)
+{
+	auto key = std::make_pair(skeleton.nodes.get(), &animation);
+	auto it = _clips.find(key);
+	if (it != _clips.end())
+		return it->second;
+
+	// Without a cooked clip on the CPU, the clip is cooked for the GPU only
+	CookedClip gpuCooked;
+	const CookedClip* clip = &animation.cooked;
+	if (!animation.IsCooked())
+	{
+		CONSOLE_INFO("Cooking animation {} at {} frames per second for the GPU", animation.id, COOKED_FRAMES_PER_SECOND);
+		gpuCooked.Create(animation, COOKED_FRAMES_PER_SECOND);
+		clip = &gpuCooked;
+	}
+
+	// The frames are reordered by bone of the skeleton, as `Animator` does when sampling, with no padding
+	const i32* boneChannels = nullptr;
+	if (animation.channelHashes)
+	{
+		const ChannelRemap* remap = animation.FindRemap(skeleton.rigHash);
+		if (remap && !remap->identity)
+			boneChannels = remap->boneChannels.get();
+	}
+
+	const u32 nrBones = skeleton.nrBones;
+	const u32 poseSize = nrBones * CookedClip::NUM_COMPONENTS;
+	Vector<f32> frames(static_cast<u64>(clip->GetNumFrames()) * poseSize);
+	for (u32 frame = 0; frame < clip->GetNumFrames(); frame++)
+	{
+		const f32* channelPose = clip->GetFrames() + static_cast<u64>(frame) * clip->GetPoseSize();
+		CookedClip::RemapPose(channelPose, clip->GetNumBones(), clip->GetStride(), boneChannels, nrBones, nrBones, &frames[static_cast<u64>(frame) * poseSize]);
+	}
+
+	ClipEntry entry{};
+	entry.frameOffset = static_cast<u32>(_frameBuffer.Append(frames.data(), frames.size() * sizeof(f32)) / sizeof(f32));
+	entry.nrFrames = clip->GetNumFrames();
+	entry.framesPerTick = clip->GetFramesPerTick();
+	return _clips.emplace(key, entry).first->second;
+}
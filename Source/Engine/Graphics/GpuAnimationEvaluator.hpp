@@ -0,0 +1,165 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+#include "Engine/Graphics/Objects/Buffer.hpp"
+#include "Engine/Graphics/Shader.hpp"
+
+class Animation;
+class Animator;
+class BonePaletteBuffer;
+class SkeletalMesh;
+struct BoneNode;
+
+/**
+ * @brief Evaluates animators in the compute shader "AnimationEval.comp": keyframe sampling and hierarchy
+ * propagation, with the palettes written straight into the `BonePaletteBuffer` read by "SkeletalAnim.vert".
+ *
+ * The clips are sampled from their cooked frames (see `CookedClip`), reordered by bone for each skeleton and
+ * uploaded once. A clip not cooked is cooked at `COOKED_FRAMES_PER_SECOND` for the GPU only. The node hierarchy
+ * of each skeleton is uploaded once too. Each frame, only the instances are uploaded: one invocation evaluates
+ * one instance, the same as `Animator::EvaluatePose` on a cooked clip.
+ *
+ * The `Animator` stays the reference implementation: `Validate()` evaluates the same instances on the CPU and
+ * compares the palettes read back from the GPU.
+ */
+class GpuAnimationEvaluator
+{
+public:
+	/** @brief Must match the "local_size_x" of the compute shader. */
+	static constexpr u32 WORKGROUP_SIZE = 64;
+
+	/** @brief Sample rate of the clips cooked for the GPU only. */
+	static constexpr f32 COOKED_FRAMES_PER_SECOND = 30.0f;
+
+	/** @brief Binding points of the storage buffers of the compute shader. "BoneBlock" is the one of "SkeletalAnim.vert". */
+	static constexpr i32 BONE_BLOCK_BINDING = 2;
+	static constexpr i32 NODE_BLOCK_BINDING = 4;
+	static constexpr i32 CLIP_BLOCK_BINDING = 5;
+	static constexpr i32 EVAL_INSTANCE_BLOCK_BINDING = 6;
+	static constexpr i32 MODEL_BLOCK_BINDING = 7;
+
+	/** @brief Result of `Validate()`. */
+	struct ValidationResult
+	{
+		u32 nrInstances{};
+		/** @brief Instances with a palette element further than the tolerance from the CPU palette. */
+		u32 nrMismatches{};
+		/** @brief Largest difference over all the palette elements, relative to the element when larger than 1. */
+		f32 maxError{};
+	};
+
+	GpuAnimationEvaluator();
+	~GpuAnimationEvaluator() = default;
+
+	/** @brief Delete copy constructor */
+	GpuAnimationEvaluator(const GpuAnimationEvaluator&) = delete;
+	GpuAnimationEvaluator& operator=(const GpuAnimationEvaluator&) = delete;
+
+	/** @brief Creates the buffers. The program is the linked "AnimationEval.comp". */
+	void Create(const Program& program);
+
+	/** @brief Deletes the buffers and forgets every uploaded skeleton and clip */
+	void Delete();
+
+	/** @brief Clears the instances of the previous frame. */
+	void BeginFrame();
+
+	/**
+	 * @brief Adds the animator to the next dispatch, at its current time. Uploads its skeleton and its clip the first time.
+	 * The animator must play a single clip that is not compressed, with no bone mask (see `AnimationSystem::SetGpuEvaluation`).
+	 *
+	 * @param paletteOffset The range of the palette in the palette buffer (see `BonePaletteBuffer::Reserve`).
+	 */
+	void AddInstance(Animator& animator, u32 paletteOffset);
+
+	/**
+	 * @brief Evaluates the instances added since `BeginFrame()` into the palette buffer, then makes the palettes
+	 * visible to the vertex shaders. The palette buffer must be uploaded first (see `BonePaletteBuffer::EndFrame`).
+	 */
+	void Dispatch(const BonePaletteBuffer& palettes);
+
+	/**
+	 * @brief Evaluates the instances of the last dispatch with their animator and compares the palettes with the ones
+	 * read back from the GPU. Waits for the GPU: for the validation mode only.
+	 *
+	 * @param tolerance The largest difference allowed on a palette element, relative to the element when larger than 1.
+	 */
+	ValidationResult Validate(const BonePaletteBuffer& palettes, f32 tolerance);
+
+	u32 GetNumInstances() const { return static_cast<u32>(_instances.size()); }
+	u32 GetNumClips() const { return static_cast<u32>(_clips.size()); }
+
+	/** @return The memory used by the uploaded clips, in bytes */
+	u64 GetClipMemorySize() const { return _frameBuffer.size; }
+
+private:
+	/** @brief A node of the hierarchy, as "Node" in the compute shader (std430). */
+	struct GpuNode
+	{
+		mat4f bindPose;
+		mat4f offset;
+		i32 parent;
+		i32 bone;
+		i32 pad[2];
+	};
+	static_assert(sizeof(GpuNode) == 144);
+
+	/** @brief An instance to evaluate, as "Instance" in the compute shader (std430). */
+	struct GpuInstance
+	{
+		u32 nodeOffset;
+		u32 nrNodes;
+		u32 frameOffset;
+		u32 nrFrames;
+		u32 nrBones;
+		f32 framesPerTick;
+		f32 time;
+		u32 paletteOffset;
+		u32 modelOffset;
+		u32 pad[3];
+	};
+	static_assert(sizeof(GpuInstance) == 48);
+
+	struct ClipEntry
+	{
+		u32 frameOffset;
+		u32 nrFrames;
+		f32 framesPerTick;
+	};
+
+	/** @brief Storage buffer written by appending, growing on the GPU. */
+	struct GrowingBuffer
+	{
+		Buffer buffer;
+		u64 size{};
+		u64 capacity{};
+
+		void Create(u64 initialCapacity);
+		void Delete();
+
+		/** @brief Makes room for `capacity` bytes, keeping the content. */
+		void Reserve(u64 newCapacity);
+
+		/** @return The offset of the data, in bytes. */
+		u64 Append(const void* data, u64 dataSize);
+	};
+
+	/** @return The first node of the skeleton in the node buffer. */
+	u32 FindSkeleton(const SkeletalMesh& skeleton);
+
+	const ClipEntry& FindClip(const SkeletalMesh& skeleton, const Animation& animation);
+
+	Program _program;
+	GrowingBuffer _nodeBuffer;
+	GrowingBuffer _frameBuffer;
+	GrowingBuffer _instanceBuffer;
+	GrowingBuffer _modelBuffer;
+
+	Map<const BoneNode*, u32> _skeletons;
+	Map<std::pair<const BoneNode*, const Animation*>, ClipEntry> _clips;
+
+	Vector<GpuInstance> _instances;
+	Vector<Animator*> _animators;
+	u32 _nrModelTransforms;
+};
@@ -50,4 +50,11 @@ void Mesh::Draw(RenderMode mode) const
 		Renderer::DrawArrays(mode, *vao);
 	else
 		Renderer::DrawElements(mode, *vao);
+}
+void Mesh::DrawInstanced(RenderMode mode, i32 nInstances) const
+{
+	if (vao->numIndices == 0)
+		Renderer::DrawArraysInstanced(mode, *vao, nInstances);
+	else
+		Renderer::DrawElementsInstanced(mode, *vao, nInstances);
 }
\ No newline at end of file
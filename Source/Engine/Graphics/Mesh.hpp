@@ -39,6 +39,7 @@ public:
 	void Destroy() const;
 	
 	void Draw(RenderMode mode) const;
+	void DrawInstanced(RenderMode mode, i32 nInstances) const;
 
 	void SetupAttributeFloat(i32 attribindex, i32 bindingindex, VertexFormat format) const;
 	void SetupAttributeInteger(i32 attribindex, i32 bindingindex, VertexFormat format) const;
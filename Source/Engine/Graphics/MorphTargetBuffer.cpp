@@ -0,0 +1,211 @@
+#include "MorphTargetBuffer.hpp"
+
+#include "Core/GL.hpp"
+#include "Core/Log/Logger.hpp"
+
+/** @brief Largest number of work groups along y guaranteed by OpenGL: the jobs of a pass are dispatched in chunks. */
+static constexpr u32 MAX_WORKGROUPS_Y = 65535;
+
+// ----------------------------------------------------
+//										PUBLIC
+// ----------------------------------------------------
+
+MorphTargetBuffer::MorphTargetBuffer() :
+	_program{},
+	_deltaBuffer{},
+	_jobBuffer{},
+	_morphBuffer{},
+	_deltaCapacity{ 0 },
+	_jobCapacity{ 0 },
+	_morphCapacity{ 0 },
+	_deltas{},
+	_nrUploadedDeltas{ 0 },
+	_targetSets{},
+	_passes{},
+	_nrPasses{ 0 },
+	_jobs{},
+	_nrVertices{ 0 },
+	_nrActiveTargets{ 0 },
+	_nrSkippedTargets{ 0 }
+{
+}
+
+void MorphTargetBuffer::Create(const Program& program)
+{
+	_program = program;
+	_deltaCapacity = 4096 * sizeof(MorphTargetSet::Delta);
+	_jobCapacity = 256 * sizeof(GpuJob);
+	_morphCapacity = 4096 * sizeof(GpuMorphVertex);
+
+	_deltaBuffer.Create();
+	_deltaBuffer.CreateStorage(_deltaCapacity, nullptr, BufferUsage::STATIC_DRAW);
+	_jobBuffer.Create();
+	_jobBuffer.CreateStorage(_jobCapacity, nullptr, BufferUsage::DYNAMIC_DRAW);
+	_morphBuffer.Create();
+	_morphBuffer.CreateStorage(_morphCapacity, nullptr, BufferUsage::DYNAMIC_COPY);
+}
+
+void MorphTargetBuffer::Delete()
+{
+	_deltaBuffer.Delete();
+	_jobBuffer.Delete();
+	_morphBuffer.Delete();
+	_deltaCapacity = _jobCapacity = _morphCapacity = 0;
+	_deltas.clear();
+	_nrUploadedDeltas = 0;
+	_targetSets.clear();
+	_passes.clear();
+	_nrPasses = 0;
+	_jobs.clear();
+}
+
+void MorphTargetBuffer::BeginFrame()
+{
+	for (u32 i = 0; i < _nrPasses; i++)
+	{
+		_passes[i].jobs.clear();
+		_passes[i].maxDeltas = 0;
+	}
+	_nrPasses = 0;
+	_nrVertices = 0;
+	_nrActiveTargets = 0;
+	_nrSkippedTargets = 0;
+}
+
+i32 MorphTargetBuffer::Update(const MorphTargetSet& targets, const f32* weights)
+{
+	const u32 nrTargets = targets.GetNumTargets();
+	u32 nrActive = 0;
+	for (u32 t = 0; t < nrTargets; t++)
+		if (weights[t] != 0.0f && targets.GetTarget(t).nrDeltas > 0)
+			nrActive++;
+
+	_nrSkippedTargets += nrTargets - nrActive;
+	if (nrActive == 0)
+		return NO_MORPH;
+
+	const u32 firstDelta = FindDeltas(targets);
+	const u32 outputOffset = _nrVertices;
+	_nrVertices += targets.GetNumSlots();
+
+	// One active target of the entity per pass: the targets of a pass never write the same vertex
+	if (_passes.size() < nrActive)
+		_passes.resize(nrActive);
+	_nrPasses = std::max(_nrPasses, nrActive);
+
+	u32 pass = 0;
+	for (u32 t = 0; t < nrTargets; t++)
+	{
+		const MorphTargetSet::Target& target = targets.GetTarget(t);
+		if (weights[t] == 0.0f || target.nrDeltas == 0)
+			continue;
+
+		_passes[pass].jobs.push_back(GpuJob{ firstDelta + target.firstDelta, target.nrDeltas, outputOffset, weights[t], target.positionScale, target.normalScale, { 0, 0 } });
+		_passes[pass].maxDeltas = std::max(_passes[pass].maxDeltas, target.nrDeltas);
+		pass++;
+	}
+	_nrActiveTargets += nrActive;
+	return static_cast<i32>(outputOffset);
+}
+
+void MorphTargetBuffer::Dispatch()
+{
+	if (_nrVertices == 0)
+		return;
+
+	// The deltas of the sets seen for the first time, the whole copy when the buffer grows
+	const u64 deltasSize = _deltas.size() * sizeof(MorphTargetSet::Delta);
+	if (deltasSize > _deltaCapacity)
+	{
+		_deltaCapacity = std::max(deltasSize, _deltaCapacity * 2);
+		_deltaBuffer.CreateStorage(_deltaCapacity, nullptr, BufferUsage::STATIC_DRAW);
+		_nrUploadedDeltas = 0;
+	}
+	if (_nrUploadedDeltas < _deltas.size())
+	{
+		const u32 nrNewDeltas = static_cast<u32>(_deltas.size()) - _nrUploadedDeltas;
+		_deltaBuffer.UpdateStorage(static_cast<i32>(_nrUploadedDeltas * sizeof(MorphTargetSet::Delta)),
+			static_cast<u32>(nrNewDeltas * sizeof(MorphTargetSet::Delta)), _deltas.data() + _nrUploadedDeltas);
+		_nrUploadedDeltas = static_cast<u32>(_deltas.size());
+	}
+
+	// The passes accumulate into zeroed vertices: nothing to keep from the previous frame
+	const u64 morphSize = static_cast<u64>(_nrVertices) * sizeof(GpuMorphVertex);
+	if (morphSize > _morphCapacity)
+	{
+		_morphCapacity = std::max(morphSize, _morphCapacity * 2);
+		_morphBuffer.CreateStorage(_morphCapacity, nullptr, BufferUsage::DYNAMIC_COPY);
+	}
+	_morphBuffer.ClearStorage(0, static_cast<u32>(morphSize));
+
+	// The jobs of every pass in one upload, pass after pass
+	_jobs.clear();
+	for (u32 i = 0; i < _nrPasses; i++)
+		_jobs.insert(_jobs.end(), _passes[i].jobs.begin(), _passes[i].jobs.end());
+
+	const u64 jobsSize = _jobs.size() * sizeof(GpuJob);
+	if (jobsSize > _jobCapacity)
+	{
+		_jobCapacity = std::max(jobsSize, _jobCapacity * 2);
+		_jobBuffer.CreateStorage(_jobCapacity, nullptr, BufferUsage::DYNAMIC_DRAW);
+	}
+	_jobBuffer.UpdateStorage(0, static_cast<u32>(jobsSize), _jobs.data());
+
+	_program.Use();
+	_deltaBuffer.BindBase(BufferTarget::SHADER_STORAGE, DELTA_BLOCK_BINDING);
+	_jobBuffer.BindBase(BufferTarget::SHADER_STORAGE, JOB_BLOCK_BINDING);
+	_morphBuffer.BindBase(BufferTarget::SHADER_STORAGE, MORPH_BLOCK_BINDING);
+
+	// One work group row per job, one invocation per delta
+	u32 firstJob = 0;
+	for (u32 i = 0; i < _nrPasses; i++)
+	{
+		const Pass& pass = _passes[i];
+		const u32 nrGroupsX = (pass.maxDeltas + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
+		for (u32 chunk = 0; chunk < pass.jobs.size(); chunk += MAX_WORKGROUPS_Y)
+		{
+			const u32 nrJobs = std::min(static_cast<u32>(pass.jobs.size()) - chunk, MAX_WORKGROUPS_Y);
+			_program.SetUniform1i("u_firstJob", static_cast<i32>(firstJob + chunk));
+			glDispatchCompute(nrGroupsX, nrJobs, 1);
+		}
+		firstJob += static_cast<u32>(pass.jobs.size());
+
+		// The next pass adds to the same vertices, the last one is read by the vertex shaders
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+}
+
+void MorphTargetBuffer::Bind(i32 bindingpoint) const
+{
+	_morphBuffer.BindBase(BufferTarget::SHADER_STORAGE, bindingpoint);
+}
+
+void MorphTargetBuffer::Read(u32 offset, u32 nrVertices, vec3f* positions, vec3f* normals) const
+{
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	Vector<GpuMorphVertex> vertices(nrVertices);
+	_morphBuffer.GetStorage(static_cast<i32>(offset * sizeof(GpuMorphVertex)), static_cast<u32>(nrVertices * sizeof(GpuMorphVertex)), vertices.data());
+	for (u32 i = 0; i < nrVertices; i++)
+	{
+		positions[i] = vec3f(vertices[i].position);
+		normals[i] = vec3f(vertices[i].normal);
+	}
+}
+
+// ----------------------------------------------------
+//										PRIVATE
+// ----------------------------------------------------
+
+u32 MorphTargetBuffer::FindDeltas(const MorphTargetSet& targets)
+{
+	// The skeletal meshes of the same model share their targets: uploaded once
+	auto it = _targetSets.find(&targets);
+	if (it != _targetSets.end())
+		return it->second;
+
+	const u32 firstDelta = static_cast<u32>(_deltas.size());
+	_deltas.insert(_deltas.end(), targets.GetDeltas(), targets.GetDeltas() + targets.GetNumDeltas());
+	_targetSets.emplace(&targets, firstDelta);
+	return firstDelta;
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "Core/Core.hpp"
+#include "Core/Math/Base.hpp"
+#include "Engine/Graphics/Objects/Buffer.hpp"
+#include "Engine/Graphics/Shader.hpp"
+#include "Engine/ECS/Skeleton/MorphTargets.hpp"
+
+/**
+ * @brief Accumulates the active morph targets of every entity drawn in the frame in the compute shader
+ * "MorphTargets.comp", into the storage buffer "MorphBlock" read by "SkeletalAnim.vert" before skinning.
+ *
+ * The sparse deltas of each `MorphTargetSet` are uploaded once. Each frame, every entity with an active
+ * target gets one output vertex per slot of its set, and only its targets with a non-zero weight are dispatched:
+ * one invocation per stored delta. The k-th active target of every entity is accumulated by the k-th pass,
+ * so that no two invocations of a pass write the same vertex.
+ *
+ * `MorphTargetSet::Apply` stays the reference implementation: `Read()` gives back the output of the GPU.
+ */
+class MorphTargetBuffer
+{
+public:
+	/** @brief Must match the "local_size_x" of the compute shader. */
+	static constexpr u32 WORKGROUP_SIZE = 64;
+
+	/** @brief Binding points of the storage buffers of the compute shader. "MorphBlock" is the one of "SkeletalAnim.vert". */
+	static constexpr i32 DELTA_BLOCK_BINDING = 8;
+	static constexpr i32 JOB_BLOCK_BINDING = 9;
+	static constexpr i32 MORPH_BLOCK_BINDING = 10;
+
+	/** @brief Offset returned by `Update()` for an entity with no active target: the "u_morphOffset" of a draw call with no morph. */
+	static constexpr i32 NO_MORPH = -1;
+
+	MorphTargetBuffer();
+	~MorphTargetBuffer() = default;
+
+	/** @brief Delete copy constructor */
+	MorphTargetBuffer(const MorphTargetBuffer&) = delete;
+	MorphTargetBuffer& operator=(const MorphTargetBuffer&) = delete;
+
+	/** @brief Creates the buffers. The program is the linked "MorphTargets.comp". */
+	void Create(const Program& program);
+
+	/** @brief Deletes the buffers and forgets every uploaded target set */
+	void Delete();
+
+	/** @brief Clears the entities of the previous frame. */
+	void BeginFrame();
+
+	/**
+	 * @brief Adds the active targets of an entity to the next dispatch. Uploads the deltas of the set the first time.
+	 *
+	 * @param weights The weight of each target of the set (see `MorphWeights`).
+	 * @return The first output vertex of the entity in "MorphBlock", or `NO_MORPH` when every weight is zero.
+	 */
+	i32 Update(const MorphTargetSet& targets, const f32* weights);
+
+	/**
+	 * @brief Accumulates the targets added since `BeginFrame()`, then makes the output visible to the vertex shaders.
+	 * Changes the current program.
+	 */
+	void Dispatch();
+
+	/** @brief Binds the output to the indexed shader storage buffer target */
+	void Bind(i32 bindingpoint) const;
+
+	/** @brief Reads `nrVertices` output vertices back from the GPU. Waits for the GPU. */
+	void Read(u32 offset, u32 nrVertices, vec3f* positions, vec3f* normals) const;
+
+	/** @return The number of targets dispatched during the frame */
+	u32 GetNumActiveTargets() const { return _nrActiveTargets; }
+
+	/** @return The number of targets left out during the frame, with a zero weight */
+	u32 GetNumSkippedTargets() const { return _nrSkippedTargets; }
+
+	/** @return The number of output vertices of the frame */
+	u32 GetNumVertices() const { return _nrVertices; }
+
+	/** @return The memory used by the uploaded deltas, in bytes */
+	u64 GetDeltaMemorySize() const { return _deltas.size() * sizeof(MorphTargetSet::Delta); }
+
+private:
+	/** @brief A target of an entity to accumulate, as "Job" in the compute shader (std430). */
+	struct GpuJob
+	{
+		u32 firstDelta;
+		u32 nrDeltas;
+		u32 outputOffset;
+		f32 weight;
+		f32 positionScale;
+		f32 normalScale;
+		u32 pad[2];
+	};
+	static_assert(sizeof(GpuJob) == 32);
+
+	/** @brief An output vertex, as "MorphVertex" in the shaders (std430). */
+	struct GpuMorphVertex
+	{
+		vec4f position;
+		vec4f normal;
+	};
+	static_assert(sizeof(GpuMorphVertex) == 32);
+
+	struct Pass
+	{
+		Vector<GpuJob> jobs;
+		u32 maxDeltas{};
+	};
+
+	/** @return The first delta of the set in the delta buffer. */
+	u32 FindDeltas(const MorphTargetSet& targets);
+
+	Program _program;
+	Buffer _deltaBuffer;
+	Buffer _jobBuffer;
+	Buffer _morphBuffer;
+	u64 _deltaCapacity;
+	u64 _jobCapacity;
+	u64 _morphCapacity;
+
+	/** @brief Copy of the delta buffer on the CPU, uploaded up to `_nrUploadedDeltas` */
+	Vector<MorphTargetSet::Delta> _deltas;
+	u32 _nrUploadedDeltas;
+	Map<const MorphTargetSet*, u32> _targetSets;
+
+	Vector<Pass> _passes;
+	u32 _nrPasses;
+	Vector<GpuJob> _jobs;
+
+	u32 _nrVertices;
+	u32 _nrActiveTargets;
+	u32 _nrSkippedTargets;
+};
@@ -44,6 +44,16 @@ void Buffer::UpdateStorage(i32 offset, u32 size, const void* data) const
 	glNamedBufferSubData(id, offset, size, data);
 }
 
+void Buffer::GetStorage(i32 offset, u32 size, void* data) const
+{
+	glGetNamedBufferSubData(id, offset, size, data);
+}
+
+void Buffer::ClearStorage(i32 offset, u32 size) const
+{
+	glClearNamedBufferSubData(id, GL_R32UI, offset, size, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+}
+
 void* Buffer::MapStorage(BufferAccess access) const
 {
 	return glMapNamedBuffer(id, static_cast<u32>(access));
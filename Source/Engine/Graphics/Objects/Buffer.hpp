@@ -66,6 +66,22 @@ public:
 	 */
 	void UpdateStorage(i32 offset, u32 size, const void* data) const;
 
+	/**
+	 * @brief Returns a subset of the buffer object's data store.
+	 *
+	 * @param offset: specifies the offset (in bytes) into the buffer object's data store where data will be read
+	 * @param size:		specifies the size in bytes of the data store region being returned
+	 */
+	void GetStorage(i32 offset, u32 size, void* data) const;
+
+	/**
+	 * @brief Fills a subset of the buffer object's data store with zeros.
+	 *
+	 * @param offset: specifies the offset (in bytes) into the buffer object's data store where the fill will begin
+	 * @param size:		specifies the size in bytes of the data store region being cleared, a multiple of 4
+	 */
+	void ClearStorage(i32 offset, u32 size) const;
+
 	/**
 	 * @brief Copy all or part of the data store of the buffer object to the data store of another buffer object
 	 *
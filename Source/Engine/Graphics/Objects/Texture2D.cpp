@@ -39,9 +39,10 @@ void Texture2D::GenerateMipmap() const
 
 void Texture2D::CreateStorage(Texture2DInternalFormat internalFormat, 
                               i32 width, 
-                              i32 height) const
+                              i32 height,
+                              i32 levels) const
 {
-  u32 mipmapLevels = 1 + std::floor(std::log2(std::max(width, height)));
+  u32 mipmapLevels = levels > 0 ? levels : 1 + std::floor(std::log2(std::max(width, height)));
   glTextureStorage2D(
     id, 
     mipmapLevels, 
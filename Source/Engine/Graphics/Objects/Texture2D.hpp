@@ -176,10 +176,14 @@ public:
   /** @brief Generate mipmaps for the texture object */
   void GenerateMipmap() const;
 
-  /** @brief The storage is created here, but the contents of that storage is undefined. */
+  /**
+   * @brief The storage is created here, but the contents of that storage is undefined.
+   * @param levels The number of mipmap levels. Zero creates the full mipmap chain.
+   */
   void CreateStorage(Texture2DInternalFormat internalFormat, 
                      i32 width, 
-                     i32 height) const;
+                     i32 height,
+                     i32 levels = 0) const;
 
   /** @brief Specify storage for multisample texture. */
   void CreateStorageMultisampled(Texture2DInternalFormat internalFormat, 
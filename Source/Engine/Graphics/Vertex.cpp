@@ -4,6 +4,7 @@ Vertex_P_N_UV_T_B::Vertex_P_N_UV_T_B()
 {
   std::fill_n(boneIds, MAX_BONES_INFLUENCE, -1);
   std::fill_n(boneWeights, MAX_BONES_INFLUENCE, 0.f);
+  morphSlot = -1;
 }
 
 void Vertex_P_N_UV_T_B::AddBone(i32 id, f32 weight)
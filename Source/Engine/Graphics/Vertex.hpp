@@ -73,4 +73,7 @@ struct Vertex_P_N_UV_T_B
   i32 boneIds[MAX_BONES_INFLUENCE];
   /** @brief Weights from each bone. */
   f32 boneWeights[MAX_BONES_INFLUENCE];
+
+  /** @brief Index of the vertex among the vertices moved by morph targets (see `MorphTargetSet`), -1 if none moves it. */
+  i32 morphSlot;
 };
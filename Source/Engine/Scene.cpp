@@ -15,10 +15,19 @@
 //								PUBLIC							 
 // -----------------------------------
 
+Scene::Scene()
+{
+	_transforms.Connect(_registry);
+}
 Scene::Scene(const fs::path& filePath)
 {
+	_transforms.Connect(_registry);
 	LoadFromFile(filePath);
 }
+Scene::~Scene()
+{
+	_transforms.Disconnect(_registry);
+}
 GameObject Scene::CreateObject(StringView objName)
 {
 	entt::entity id = _registry.create();
@@ -43,6 +52,11 @@ void Scene::DestroyObject(entt::entity id)
 void Scene::Clear()
 {
 	_registry.clear();
+	_transforms.Clear();
+}
+void Scene::UpdateTransforms()
+{
+	_transforms.Update();
 }
 void Scene::LoadFromFile(const fs::path& filePath)
 {
@@ -75,7 +89,10 @@ void Scene::SerializeScene(const fs::path& filePath)
 			String section = std::format("Entity{}:Transform", objectID);
 			conf.Update(section, "position", std::format("{},{},{}", transform->position.x, transform->position.y, transform->position.z));
 			conf.Update(section, "scale", std::format("{},{},{}", transform->scale.x, transform->scale.y, transform->scale.z));
-			conf.Update(section, "rotation", std::format("{},{},{}", transform->rotation.x, transform->rotation.y, transform->rotation.z));
+			const vec3f rotation = transform->GetEulerAngles();
+			conf.Update(section, "rotation", std::format("{},{},{}", rotation.x, rotation.y, rotation.z));
+			if (entt::entity parent = _transforms.GetParent(entity); parent != entt::null)
+				conf.Update(section, "parent", std::to_string(static_cast<u32>(parent)));
 		}
 		if (StaticMesh* staticMesh = object.GetComponent<StaticMesh>())
 		{
@@ -90,6 +107,12 @@ void Scene::SerializeScene(const fs::path& filePath)
 			String section = std::format("Entity{}:SkeletalMesh", objectID);
 			const fs::path* path = manager.GetSkeletalMeshPath(skeleton->id);
 			conf.Update(section, "path", path->string());
+			if (BakedAnimator* baked = object.GetComponent<BakedAnimator>())
+			{
+				conf.Update(section, "baked_clip", std::to_string(baked->clip));
+				conf.Update(section, "time_offset", std::to_string(baked->timeOffset));
+				conf.Update(section, "speed", std::to_string(baked->speed));
+			}
 		}
 		if (Light* light = object.GetComponent<Light>())
 		{
@@ -161,6 +184,10 @@ void Scene::DeserializeScene(const fs::path& filePath)
 
 	GameObject object;
 	u32 currentObjectId = static_cast<u32>(entt::null);
+
+	// The objects get new ids: the parents are attached once every object is created
+	UnorderedMap<u32, entt::entity> objects;
+	Vector<std::pair<entt::entity, u32>> parents;
 	for (const auto& it : conf.GetData())
 	{
 		const String& section = it.first;
@@ -173,6 +200,7 @@ void Scene::DeserializeScene(const fs::path& filePath)
 		{
 			currentObjectId = objectId;
 			object = CreateObject();
+			objects[objectId] = object.id;
 		}
 
 		if (component == "Tag")
@@ -188,9 +216,13 @@ void Scene::DeserializeScene(const fs::path& filePath)
 
 			auto& transform = object.AddComponent<Transform>();
 			transform.position = Utils::StringToVec3f(position);
-			transform.rotation = Utils::StringToVec3f(rotation);
+			transform.SetEulerAngles(Utils::StringToVec3f(rotation));
 			transform.scale = Utils::StringToVec3f(scale);
 			transform.UpdateTransformation();
+
+			const String& parent = conf.GetValue(section, "parent");
+			if (!parent.empty())
+				parents.emplace_back(object.id, static_cast<u32>(std::strtoul(parent.c_str(), nullptr, 10)));
 		}
 		else if (component == "StaticMesh")
 		{
@@ -206,7 +238,6 @@ void Scene::DeserializeScene(const fs::path& filePath)
 		else if (component == "SkeletalMesh")
 		{
 			SkeletalMesh& skmeshComponent = object.AddComponent<SkeletalMesh>();
-			Animator& animatorComponent = object.AddComponent<Animator>();
 
 			ModelsManager& modManager = ModelsManager::Get();
 			AnimationsManager& animManager = AnimationsManager::Get();
@@ -253,7 +284,28 @@ void Scene::DeserializeScene(const fs::path& filePath)
 			}
 			
 			skeleton->Clone(skmeshComponent);
-			animatorComponent.SetTargetSkeleton(skmeshComponent);
+			if (skmeshComponent.morphTargets)
+				object.AddComponent<MorphWeights>(skmeshComponent.morphTargets->GetDefaultWeights());
+
+			// A crowd instance plays a baked clip on the GPU in place of an animator
+			const String& bakedClip = conf.GetValue(section, "baked_clip");
+			if (!bakedClip.empty())
+			{
+				BakedAnimator& bakedComponent = object.AddComponent<BakedAnimator>();
+				bakedComponent.clip = Utils::StringToI32(bakedClip);
+
+				const String& timeOffset = conf.GetValue(section, "time_offset");
+				if (!timeOffset.empty())
+					bakedComponent.timeOffset = Utils::StringToF32(timeOffset);
+				const String& speed = conf.GetValue(section, "speed");
+				if (!speed.empty())
+					bakedComponent.speed = Utils::StringToF32(speed);
+			}
+			else
+			{
+				Animator& animatorComponent = object.AddComponent<Animator>();
+				animatorComponent.SetTargetSkeleton(skmeshComponent);
+			}
 		}
 		else if (component == "Light")
 		{
@@ -319,4 +371,11 @@ void Scene::DeserializeScene(const fs::path& filePath)
 			}
 		}
 	}
+
+	for (const auto& [entity, parentId] : parents)
+	{
+		auto it = objects.find(parentId);
+		if (it == objects.end() || !_transforms.SetParent(entity, it->second))
+			CONSOLE_WARN("Invalid parent {} of entity {}", parentId, static_cast<u32>(entity));
+	}
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core/Core.hpp"
+#include "Engine/ECS/TransformHierarchy.hpp"
 #include <entt/entt.hpp> // Entity component system
 
 class GameObject;
@@ -13,9 +14,13 @@ class GameObject;
 class Scene
 {
 public:
-	Scene() = default;
+	Scene();
 	Scene(const fs::path& filePath);
-	~Scene() = default;
+	~Scene();
+
+	/** @brief Delete copy constructor: the hierarchy of the transforms is connected to the registry */
+	Scene(const Scene&) = delete;
+	Scene& operator=(const Scene&) = delete;
 
 	/** @brief Loads a scene from a file. */
 	void LoadFromFile(const fs::path& filePath);
@@ -47,7 +52,16 @@ public:
 	/** @brief Provides access to the internal entity registry. */
 	entt::registry& Reg() { return _registry; }
 
+	/** @brief Provides access to the parent-child relations of the transforms. */
+	TransformHierarchy& Transforms() { return _transforms; }
+
+	/** @brief Computes the world matrices of the transforms changed since the last call, and of their children. */
+	void UpdateTransforms();
+
 private:
+	// Declared before the registry: destroyed after the transforms it tracks
+	TransformHierarchy _transforms;
+
 	// We can create a entt::registry to store our entities
 	entt::registry _registry;
 
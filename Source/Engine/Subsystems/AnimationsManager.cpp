@@ -3,14 +3,14 @@
 #include "Core/Log/Logger.hpp"
 #include "Engine/Subsystems/ModelsManager.hpp"
 #include "Engine/Filesystem/Filesystem.hpp"
+#include "Engine/ECS/Animation/AnimationFile.hpp"
 
 
 
-const Vector<Animation>& AnimationsManager::LoadAnimations(const SkeletalMesh& skeleton,
-																													 const Vector<fs::path> relativeAnims)
+const Vector<const Animation*>& AnimationsManager::LoadAnimations(const SkeletalMesh& skeleton,
+																																	 const Vector<fs::path> relativeAnims,
+																																	 JobSystem& jobSystem)
 {
-	static u32 animationId = 0;
-
 	// E.g. relativeAnims = [ 
 	//	"Mutant/Drunk_Walk/anim.gltf", 
 	//	"Mutant/Silly_Dancing/anim.gltf" 
@@ -18,23 +18,116 @@ const Vector<Animation>& AnimationsManager::LoadAnimations(const SkeletalMesh& s
 
 	CONSOLE_INFO("Loading animations for skeleton {}", skeleton.id);
 
-	auto [it, success] = _skeletonAnimations.emplace(skeleton.id, Vector<Animation>{});
+	auto [it, success] = _skeletonAnimations.emplace(skeleton.id, Vector<const Animation*>{});
 	assert(success);
 
-	Vector<Animation>& animVector = it->second;
-	animVector.reserve(relativeAnims.size());
-	for (const auto& relative : relativeAnims)
+	auto t0 = chrono::steady_clock::now();
+
+	// 1) The clips not in the library yet, once each
+	const u32 nrAnimations = static_cast<u32>(relativeAnims.size());
+	Vector<fs::path> paths(nrAnimations);
+	Vector<u32> newClips;
+	for (u32 i = 0; i < nrAnimations; i++)
 	{
-		auto& animation = animVector.emplace_back(skeleton, relative);
-		animation.id = animationId;
+		paths[i] = relativeAnims[i].lexically_normal();
+		if (!_animationIds.contains(paths[i]) && std::find(paths.begin(), paths.begin() + i, paths[i]) == paths.begin() + i)
+			newClips.push_back(i);
+	}
+
+	// 2) Independent imports: each task only writes its own slot
+	const u32 nrNewClips = static_cast<u32>(newClips.size());
+	Vector<UniquePtr<Animation>> imported(nrNewClips);
+	Vector<u8> fromCookedFile(nrNewClips, 0);
+	Vector<ClipCompressionReport> reports(nrNewClips);
+	jobSystem.ParallelFor(nrNewClips, 1, [&](u32 begin, u32 end) {
+		for (u32 i = begin; i < end; i++)
+		{
+			imported[i] = std::make_unique<Animation>();
+			Animation& animation = *imported[i];
+			fromCookedFile[i] = ImportAnimation(animation, paths[newClips[i]]);
+			if (_compressAnimations)
+				reports[i] = animation.Compress(_compressionSettings);
+			else if (_cookedSampleRate > 0.0f)
+				animation.Cook(_cookedSampleRate);
+		}
+	});
+
+	// 3) Merge in list order
+	u32 nrCooked = 0;
+	for (u32 i = 0; i < nrNewClips; i++)
+	{
+		const fs::path& relative = paths[newClips[i]];
+		Animation& animation = *imported[i];
+		animation.id = _nextAnimationId++;
+		nrCooked += fromCookedFile[i];
+		if (_compressAnimations)
+		{
+			const ClipCompressionReport& report = reports[i];
+			CONSOLE_INFO("Compressed animation {}: {} -> {} bytes (ratio {:.2f}), {}/{} keys, {}/{} constant tracks, {} dropped tracks, {} tracks over budget, max error {:.6f}",
+				relative.string(), report.rawSize, report.compressedSize, report.GetRatio(),
+				report.nrKeys, report.nrResampledKeys, report.nrConstantTracks, report.nrTracks, report.nrDroppedTracks, report.nrTracksOverBudget, report.maxError);
+		}
 		
-		_animationPaths.emplace(animationId, relative);
-		animationId++;
+		_animationIds.emplace(relative, animation.id);
+		_animationPaths.emplace(animation.id, relative);
+		_animations.emplace(animation.id, std::move(imported[i]));
 	}
+
+	// 4) Bind every clip of the list to the skeleton
+	Vector<const Animation*>& animVector = it->second;
+	animVector.reserve(nrAnimations);
+	for (u32 i = 0; i < nrAnimations; i++)
+	{
+		Animation& animation = *_animations.at(_animationIds.at(paths[i]));
+		if (animation.channelHashes && skeleton.boneHashes)
+		{
+			const ChannelRemap& remap = GetOrCreateRemap(skeleton, animation);
+			animation.BindSkeleton(skeleton.rigHash, &remap);
+			if (remap.nrMappedBones == 0)
+				CONSOLE_WARN("Animation {} drives no bone of skeleton {}", paths[i].string(), skeleton.id);
+		}
+		animVector.push_back(&animation);
+	}
+
+	auto t1 = chrono::steady_clock::now();
+	CONSOLE_INFO("Loaded {} animations for skeleton {} in {:.2f} ms on {} threads ({} shared, {} from cooked files, {} imported)",
+		nrAnimations, skeleton.id, chrono::duration<f64, std::milli>(t1 - t0).count(), jobSystem.GetNumThreads(),
+		nrAnimations - nrNewClips, nrCooked, nrNewClips - nrCooked);
 	return animVector;
 }
 
-const Vector<Animation>* AnimationsManager::GetSkeletonAnimations(u32 skeletonID)
+bool AnimationsManager::ImportAnimation(Animation& animation, const fs::path& relative) const
+{
+	if (!_useAnimationCache)
+	{
+		animation = Animation(relative);
+		return false;
+	}
+
+	fs::path source = Filesystem::GetSkeletalModelsPath() / relative;
+	fs::path cooked = AnimationFile::GetCookedPath(source);
+	AnimationFile::SourceKey key{};
+	key.sourceHash = AnimationFile::HashSource(source);
+	key.importFlags = Animation::GetImportFlags();
+	if (AnimationFile::Read(cooked, animation, key))
+		return true;
+
+	animation = Animation(relative);
+	if (animation.bonesAnimKeys && !AnimationFile::Write(cooked, animation, key))
+		CONSOLE_WARN("Cannot write the cooked animation {}", cooked.string());
+	return false;
+}
+
+void AnimationsManager::UnloadAnimations()
+{
+	_skeletonAnimations.clear();
+	_animationIds.clear();
+	_animationPaths.clear();
+	_animations.clear();
+	_remaps.clear();
+}
+
+const Vector<const Animation*>* AnimationsManager::GetSkeletonAnimations(u32 skeletonID)
 {
 	auto it = _skeletonAnimations.find(skeletonID);
 	if (it != _skeletonAnimations.end())
@@ -50,3 +143,19 @@ const fs::path* AnimationsManager::GetAnimationPath(u32 animationID) const
 		return &_animationPaths.at(animationID);
 	return nullptr;
 }
+
+// ----------------------------------------------------
+//										PRIVATE
+// ----------------------------------------------------
+
+const ChannelRemap& AnimationsManager::GetOrCreateRemap(const SkeletalMesh& skeleton, const Animation& animation)
+{
+	// The clips of a rig usually share their channels: one table per skeleton rig serves all of them
+	std::pair<u64, u64> key{ skeleton.rigHash, animation.GetLayoutHash() };
+	auto it = _remaps.find(key);
+	if (it != _remaps.end())
+		return it->second;
+
+	ChannelRemap remap = ChannelRemap::Create(skeleton.boneHashes.get(), skeleton.nrBones, animation.channelHashes.get(), animation.nrKeys);
+	return _remaps.emplace(key, std::move(remap)).first->second;
+}
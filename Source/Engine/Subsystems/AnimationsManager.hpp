@@ -1,10 +1,19 @@
 #pragma once
 
 #include "Core/Core.hpp"
+#include "Core/Thread/JobSystem.hpp"
 #include "Engine/ECS/Animation/Animation.hpp"
 
 class SkeletalMesh;
 
+/**
+ * @brief Library of the animation clips, shared by all the skeletal meshes.
+ *
+ * A clip is imported once, the first time a skeleton lists it: the skeletons listing it afterwards reuse the
+ * same `Animation`. Each skeleton plays the clips through remap tables from the channels of the clip to its
+ * bones (see `ChannelRemap`), built once per rig and channel layout, so a roster of characters sharing a
+ * rig shares both the clips and the tables.
+ */
 class AnimationsManager
 {
 public:
@@ -22,14 +31,21 @@ public:
 	 * This method loads multiple animations associated with a specific skeletal mesh,
 	 * using the provided relative paths.
 	 *
-	 * @param skeleton The skeletal mesh to which the animations belong.
+	 * The clips already in the library are shared, not imported again. The others are imported in parallel,
+	 * each one on its own (see `ImportAnimation`), cooked or compressed included. The animation ids are then
+	 * assigned in the order of the list, so they do not depend on which import finishes first.
+	 * Finally every clip of the list is bound to the skeleton (see `Animation::BindSkeleton`).
+	 *
+	 * @param skeleton The skeletal mesh to which the animations belong. Its bone names must be hashed (see `SkeletalMesh::HashBoneNames`).
 	 * @param relativeAnims A vector of relative paths to the animation files inside the skeletal model directory.
 	 *        Example: { "Mutant/Drunk_Walk/anim.gltf", "Mutant/Silly_Dancing/anim.gltf" }.
+	 * @param jobSystem The job system running the imports.
 	 * 
-	 * @return Pointer to a vector of loaded Animation objects.
+	 * @return The animations of the skeleton, in the order of the list.
 	 */
-	const Vector<Animation>& LoadAnimations(const SkeletalMesh& skeleton,
-																					const Vector<fs::path> relativeAnims);
+	const Vector<const Animation*>& LoadAnimations(const SkeletalMesh& skeleton,
+																								 const Vector<fs::path> relativeAnims,
+																								 JobSystem& jobSystem = JobSystem::Get());
 
 	/**
 	 * @brief Retrieves the vector of animations associated with a skeletal mesh.
@@ -37,17 +53,87 @@ public:
 	 *
 	 * @return Pointer to a vector of Animation objects, or nullptr if no animations are found.
 	 */
-	const Vector<Animation>* GetSkeletonAnimations(u32 skeletonID);
+	const Vector<const Animation*>* GetSkeletonAnimations(u32 skeletonID);
 
 	const fs::path* GetAnimationPath(u32 animationID) const;
 
+	/**
+	 * @brief Loads the keys of a single animation, from its cooked file (see `AnimationFile`) when it is
+	 * up to date, otherwise from the source file with Assimp. The cooked file is then written for the next load.
+	 * The animation is neither cooked nor compressed, nor added to the library.
+	 *
+	 * @param relative The relative path to the animation file inside the skeletal model directory.
+	 * @return Whether the keys were read from the cooked file.
+	 */
+	bool ImportAnimation(Animation& animation, const fs::path& relative) const;
+
+	/**
+	 * @brief Releases every animation and remap table. No animator may reference them anymore.
+	 * The animation ids keep increasing.
+	 */
+	void UnloadAnimations();
+
+	/** @return The number of clips in the library */
+	u32 GetNumAnimations() const { return static_cast<u32>(_animations.size()); }
+
+	/** @return The number of remap tables built so far: one per rig and channel layout */
+	u32 GetNumRemaps() const { return static_cast<u32>(_remaps.size()); }
+
+	/**
+	 * @brief Enables the cooked ".anim" files, read in place of the source files by the animations loaded from now on.
+	 *
+	 * @param enable Enabled by default.
+	 */
+	void SetAnimationCache(bool enable) { _useAnimationCache = enable; }
+
+	/**
+	 * @brief Enables the cooked clip layout for the animations loaded from now on.
+	 * Cooked animations are resampled at the given rate and sampled for all bones at once (see `CookedClip`).
+	 * 
+	 * @param framesPerSecond The resampling rate. Zero disables cooking, which is the default.
+	 */
+	void SetCookedSampleRate(f32 framesPerSecond) { _cookedSampleRate = framesPerSecond; }
+
+	/**
+	 * @brief Enables the lossy compression of the animations loaded from now on (see `CompressedClip`).
+	 * The compression ratio and the largest error of each clip are logged. Compressed animations are not cooked.
+	 *
+	 * @param enable Disabled by default.
+	 */
+	void SetCompression(bool enable, const ClipCompressionSettings& settings = ClipCompressionSettings{})
+	{
+		_compressAnimations = enable;
+		_compressionSettings = settings;
+	}
+
 private:
 	AnimationsManager() = default;
 	~AnimationsManager() = default;
+
+	// Resampling rate of cooked animations, zero if animations are not cooked
+	f32 _cookedSampleRate{ 0.0f };
+
+	bool _useAnimationCache{ true };
+
+	bool _compressAnimations{ false };
+	ClipCompressionSettings _compressionSettings{};
 	
+	const ChannelRemap& GetOrCreateRemap(const SkeletalMesh& skeleton, const Animation& animation);
+
+	u32 _nextAnimationId{ 0 };
+
+	// Map storing the pair (animation id, animation): the library
+	Map<u32, UniquePtr<Animation>> _animations;
+
+	// Map storing the pair (normalized relative path, animation id)
+	Map<fs::path, u32> _animationIds;
+
 	// Map storing the pair (skeleton id, animations)
-	Map<u32, Vector<Animation>> _skeletonAnimations;
+	Map<u32, Vector<const Animation*>> _skeletonAnimations;
 
 	// Map storing the pair (animation id, animation path)
 	Map<u32, fs::path> _animationPaths;
+
+	// Map storing the pair ((rig hash, channel layout hash), remap table). The tables never move.
+	Map<std::pair<u64, u64>, ChannelRemap> _remaps;
 };
\ No newline at end of file
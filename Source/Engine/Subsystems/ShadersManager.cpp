@@ -122,6 +122,8 @@ i32 ShadersManager::ResolveShaderType(StringView ext)
     return GL_GEOMETRY_SHADER;
   if (ext == "frag")
     return GL_FRAGMENT_SHADER;
+  if (ext == "comp")
+    return GL_COMPUTE_SHADER;
   
   throw std::runtime_error(std::format("Unknown file extension {}", ext.data()));
 }
@@ -139,6 +141,7 @@ void ShadersManager::ReadConfig(IniFileHandler& conf)
     const String& tese = conf.GetValue(section, "tess_eval");
     const String& geometry = conf.GetValue(section, "geometry");
     const String& fragment = conf.GetValue(section, "fragment");
+    const String& compute = conf.GetValue(section, "compute");
     if (!vertex.empty())
     {
       const Shader& vertShader = GetOrCreateShader(vertex);
@@ -164,6 +167,11 @@ void ShadersManager::ReadConfig(IniFileHandler& conf)
       const Shader& fragShader = GetOrCreateShader(fragment);
       program.AttachShader(fragShader);
     }
+    if (!compute.empty())
+    {
+      const Shader& compShader = GetOrCreateShader(compute);
+      program.AttachShader(compShader);
+    }
 
     CONSOLE_TRACE("Link program {}", section);
     if(!program.Link())
@@ -197,4 +205,15 @@ void ShadersManager::SetProgramsUniforms() const
   skeletalAnimProg.SetUniform1i("u_material.diffuseTexture", 0);
   skeletalAnimProg.SetUniform1i("u_material.specularTexture", 1);
   skeletalAnimProg.SetUniform1i("u_material.normalTexture", 2);
+  skeletalAnimProg.SetUniform1i("u_morphOffset", -1);
+
+  Program skeletalAnimShadowsProg = GetProgram("SkeletalAnimShadows");
+  skeletalAnimShadowsProg.SetUniform1i("u_morphOffset", -1);
+
+  Program skeletalAnimBakedProg = GetProgram("SkeletalAnimBaked");
+  skeletalAnimBakedProg.SetUniform1i("u_useNormalMap", 0);
+  skeletalAnimBakedProg.SetUniform1i("u_material.diffuseTexture", 0);
+  skeletalAnimBakedProg.SetUniform1i("u_material.specularTexture", 1);
+  skeletalAnimBakedProg.SetUniform1i("u_material.normalTexture", 2);
+  skeletalAnimBakedProg.SetUniform1i("u_bakedAnimation", 3);
 }
\ No newline at end of file
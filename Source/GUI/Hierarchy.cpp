@@ -32,6 +32,11 @@ static void Hierarchy_ListObjects(Scene& scene, GameObject& objSelected)
   for (auto [entity, tag] : scene.Reg().view<Tag>().each())
   {
     GameObject o{ entity, &scene.Reg() };
+
+    // The children under their parent
+    const f32 indent = static_cast<f32>(scene.Transforms().GetDepth(entity)) * 16.f;
+    if (indent > 0.f)
+      ImGui::Indent(indent);
     
 		selectableName.fill(0);
     std::format_to_n(selectableName.data(), selectableName.size(), "{}##{}", tag.value.data(), static_cast<u32>(entity));
@@ -62,6 +67,8 @@ static void Hierarchy_ListObjects(Scene& scene, GameObject& objSelected)
     
     ImGui::PopStyleColor(3);
     ImGui::EndGroup();
+    if (indent > 0.f)
+      ImGui::Unindent(indent);
 
     ImGui::Spacing();
   }
@@ -98,6 +105,27 @@ static void Hierarchy_ObjectMenuPopup(Scene& scene, GameObject& objSelected)
 
       scene.DestroyObject(objSelected.id);
     }
+    else if (objSelected.HasComponent<Transform>() && ImGui::BeginMenu("Set parent"))
+    {
+      // The transform of the object becomes relative to its parent
+      TransformHierarchy& transforms = scene.Transforms();
+      const entt::entity parent = transforms.GetParent(objSelected.id);
+      if (ImGui::MenuItem("None", nullptr, parent == entt::null))
+        transforms.SetParent(objSelected.id, entt::null);
+
+      Array<char, 64> label{};
+      for (auto [entity, tag, transform] : scene.Reg().view<Tag, Transform>().each())
+      {
+        if (entity == objSelected.id)
+          continue;
+
+        label.fill(0);
+        std::format_to_n(label.data(), label.size() - 1, "{}##{}", tag.value.data(), static_cast<u32>(entity));
+        if (ImGui::MenuItem(label.data(), nullptr, parent == entity) && !transforms.SetParent(objSelected.id, entity))
+          CONSOLE_WARN("Object {} is a child of the selected object", tag.value.data());
+      }
+      ImGui::EndMenu();
+    }
     ImGui::EndPopup();
   }
 }
@@ -6,7 +6,10 @@
 #include "Engine/Scene.hpp"
 #include "Engine/Camera.hpp"
 #include "Engine/ECS/ECS.hpp"
+#include "Engine/ECS/Animation/AnimationSystem.hpp"
 #include "Engine/IniFileHandler.hpp"
+#include "Engine/Graphics/BonePaletteBuffer.hpp"
+#include "Engine/Graphics/MorphTargetBuffer.hpp"
 #include "Engine/Graphics/Objects/Texture2D.hpp"
 #include "Engine/Subsystems/WindowManager.hpp"
 #include "Engine/Filesystem/Filesystem.hpp"
@@ -173,6 +176,37 @@ void ImGuiLayer::RenderTimeInfo(f64 delta, f64 avg, i32 frameRate)
 
   ImGui::End();
 }
+void ImGuiLayer::RenderAnimationInfo(const AnimationSystem& animationSystem, const BonePaletteBuffer& bonePalettes, const MorphTargetBuffer& morphTargets)
+{
+  static constexpr const char* lodNames[AnimationSystem::NUM_LODS] = { "Full rate", "Half rate", "Quarter rate" };
+  const AnimationSystem::Stats& stats = animationSystem.GetStats();
+
+  ImGui::Begin("Animation info", nullptr);
+  for (u32 lod = 0; lod < AnimationSystem::NUM_LODS; lod++)
+    ImGui::TextWrapped("%s: %u animators, %u updated", lodNames[lod], stats.nrAnimators[lod], stats.nrUpdated[lod]);
+  ImGui::Separator();
+  ImGui::TextWrapped("Sampled bones: %u", stats.nrSampledBones);
+  ImGui::TextWrapped("Skipped bones (frame rate): %u", stats.nrSkippedFrameBones);
+  ImGui::TextWrapped("Skipped bones (leaf bones): %u", stats.nrSkippedLeafBones);
+  if (animationSystem.GetCacheSettings().enabled)
+  {
+    ImGui::Separator();
+    ImGui::TextWrapped("Pose cache: %u hits / %u lookups (%.1f%%)", stats.nrCacheHits, stats.nrCacheLookups, stats.GetCacheHitRate() * 100.0f);
+  }
+  if (animationSystem.IsGpuEvaluationEnabled())
+  {
+    ImGui::Separator();
+    ImGui::TextWrapped("Evaluated on the GPU: %u animators", stats.nrGpuAnimators);
+  }
+  ImGui::Separator();
+  ImGui::TextWrapped("Palettes uploaded: %u", bonePalettes.GetNumUploads());
+  ImGui::TextWrapped("Palettes unchanged: %u", bonePalettes.GetNumSkippedUploads());
+  ImGui::TextWrapped("Palette buffer: %u matrices", bonePalettes.GetNumMatrices());
+  ImGui::Separator();
+  ImGui::TextWrapped("Morph targets: %u active, %u skipped (zero weight)", morphTargets.GetNumActiveTargets(), morphTargets.GetNumSkippedTargets());
+  ImGui::TextWrapped("Morphed vertices: %u", morphTargets.GetNumVertices());
+  ImGui::End();
+}
 void ImGuiLayer::RenderDebug(bool shadowMode, bool normalMode, bool wireframeMode)
 {
   ImGui::Begin("Debug", nullptr);
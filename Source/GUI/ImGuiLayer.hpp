@@ -7,6 +7,9 @@ class Camera;
 class Scene;
 class GameObject;
 class Animator;
+class AnimationSystem;
+class BonePaletteBuffer;
+class MorphTargetBuffer;
 
 /**
  * 
@@ -91,6 +94,7 @@ public:
 	void RenderDebugDepthMap(u32 texture);
 	void RenderGraphicsInfo();
 	void RenderTimeInfo(f64 delta, f64 avg, i32 frameRate);
+	void RenderAnimationInfo(const AnimationSystem& animationSystem, const BonePaletteBuffer& bonePalettes, const MorphTargetBuffer& morphTargets);
 	void RenderDebug(bool shadowMode, bool normalMode, bool wireframeMode);
 
 	vec2i viewportSize;
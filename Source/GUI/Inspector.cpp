@@ -55,8 +55,9 @@ static void Insp_Tag(Tag& tag)
     ImGui::EndTable();
   }
 }
-static void Insp_Light_ComboAttenuation(Attenuation& destAtt)
+static bool Insp_Light_ComboAttenuation(Attenuation& destAtt)
 {
+  bool changed = false;
   char currentAttRange[16]{};
   std::format_to_n(currentAttRange, sizeof(currentAttRange), "{}m", destAtt.range);
   if (ImGui::BeginCombo("##Range", currentAttRange))
@@ -68,13 +69,19 @@ static void Insp_Light_ComboAttenuation(Attenuation& destAtt)
       std::fill_n(label, sizeof(label), 0);
       std::format_to_n(label, sizeof(label), "{}m", attenuation.range);
       if (ImGui::Selectable(label, destAtt.range == attenuation.range))
+      {
         destAtt = attenuation;
+        changed = true;
+      }
     }
     ImGui::EndCombo();
   }
+  return changed;
 }
 static void Insp_DirectLight(GameObject& object, DirectionalLight& light)
 {
+  bool changed = false;
+
   // Create a table with two columns: one for the labels and one for input
   if (ImGui::BeginTable("Light_Table", 2, ImGuiTableFlags_SizingFixedFit))
   {
@@ -96,24 +103,27 @@ static void Insp_DirectLight(GameObject& object, DirectionalLight& light)
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Color");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::ColorEdit3("##Color", reinterpret_cast<f32*>(&light.color));
+    changed |= ImGui::ColorEdit3("##Color", reinterpret_cast<f32*>(&light.color));
     
     // 3 Row: intensity input
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Intensity");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::SliderFloat("##Intensity", &light.intensity, 0.0f, 1.0f);
+    changed |= ImGui::SliderFloat("##Intensity", &light.intensity, 0.0f, 1.0f);
 
     // 4 Row: direction input
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Direction");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::DragFloat3("##Direction", reinterpret_cast<f32*>(&light.direction), 0.1f, -FLT_MAX, FLT_MAX);
+    changed |= ImGui::DragFloat3("##Direction", reinterpret_cast<f32*>(&light.direction), 0.1f, -FLT_MAX, FLT_MAX);
 
     ImGui::EndTable();
   }
+  // The light is uploaded again only when it changed (see ChangeObserver)
+  if (changed)
+    object.PatchComponent<DirectionalLight>();
 
   ImGui::SeparatorText("Advanced");
   ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.55f, 0.f, 0.f, 0.5f));
@@ -134,6 +144,8 @@ static void Insp_DirectLight(GameObject& object, DirectionalLight& light)
 }
 static void Insp_PointLight(GameObject& object, PointLight& light)
 {
+  bool changed = false;
+
   // Create a table with two columns: one for the labels and one for input
   if (ImGui::BeginTable("Light_Table", 2, ImGuiTableFlags_SizingFixedFit))
   {
@@ -155,30 +167,33 @@ static void Insp_PointLight(GameObject& object, PointLight& light)
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Color");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::ColorEdit3("##Color", reinterpret_cast<f32*>(&light.color));
+    changed |= ImGui::ColorEdit3("##Color", reinterpret_cast<f32*>(&light.color));
 
     // 3 Row: diffuse input
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Intensity");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::SliderFloat("##Intensity", &light.intensity, 0.0f, 1.0f);
+    changed |= ImGui::SliderFloat("##Intensity", &light.intensity, 0.0f, 1.0f);
 
     // 4 Row: position input
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Position");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::DragFloat3("##Position", reinterpret_cast<f32*>(&light.position), 0.1f, -FLT_MAX, FLT_MAX);
+    changed |= ImGui::DragFloat3("##Position", reinterpret_cast<f32*>(&light.position), 0.1f, -FLT_MAX, FLT_MAX);
 
     // 5 Row: attenuation combo
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::TextWrapped("Attenuation range");
     ImGui::TableNextColumn(); /* Second column: input */
-    Insp_Light_ComboAttenuation(light.attenuation);
+    changed |= Insp_Light_ComboAttenuation(light.attenuation);
     ImGui::EndTable();
   }
+  // The light is uploaded again only when it changed (see ChangeObserver)
+  if (changed)
+    object.PatchComponent<PointLight>();
 
   ImGui::SeparatorText("Advanced");
   ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.55f, 0.f, 0.f, 0.5f));
@@ -199,6 +214,8 @@ static void Insp_PointLight(GameObject& object, PointLight& light)
 }
 static void Insp_SpotLight(GameObject& object, SpotLight& light)
 {
+  bool changed = false;
+
   // Create a table with two columns: one for the labels and one for input
   if (ImGui::BeginTable("Light_Table", 2, ImGuiTableFlags_SizingFixedFit))
   {
@@ -220,52 +237,55 @@ static void Insp_SpotLight(GameObject& object, SpotLight& light)
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Color");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::ColorEdit3("##Color", reinterpret_cast<f32*>(&light.color));
+    changed |= ImGui::ColorEdit3("##Color", reinterpret_cast<f32*>(&light.color));
 
     // 3 Row: diffuse input
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Intensity");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::SliderFloat("##Intensity", &light.intensity, 0.0f, 1.0f);
+    changed |= ImGui::SliderFloat("##Intensity", &light.intensity, 0.0f, 1.0f);
 
     // 4 Row: direction input
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Direction");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::DragFloat3("##Direction", reinterpret_cast<f32*>(&light.direction), 0.1f, -FLT_MAX, FLT_MAX);
+    changed |= ImGui::DragFloat3("##Direction", reinterpret_cast<f32*>(&light.direction), 0.1f, -FLT_MAX, FLT_MAX);
 
     // 5 Row: position input
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Position");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::DragFloat3("##Position", reinterpret_cast<f32*>(&light.position), 0.1f, -FLT_MAX, FLT_MAX);
+    changed |= ImGui::DragFloat3("##Position", reinterpret_cast<f32*>(&light.position), 0.1f, -FLT_MAX, FLT_MAX);
 
     // 6 Row: attenuation combo
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::TextWrapped("Attenuation range");
     ImGui::TableNextColumn(); // Second column: input
-    Insp_Light_ComboAttenuation(light.attenuation);
+    changed |= Insp_Light_ComboAttenuation(light.attenuation);
 
     // 7 Row: inner cutoff input
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Inner cutoff");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::SliderFloat("##Inner_Cutoff", &light.cutOff, 1.0f, light.outerCutOff);
+    changed |= ImGui::SliderFloat("##Inner_Cutoff", &light.cutOff, 1.0f, light.outerCutOff);
 
     // 8 Row: outer cutoff input
     ImGui::TableNextRow();
     ImGui::TableNextColumn(); // First column: label
     ImGui::Text("Outer cutoff");
     ImGui::TableNextColumn(); // Second column: input
-    ImGui::SliderFloat("##Outer_Cutoff", &light.outerCutOff, light.cutOff, 45.0f);
+    changed |= ImGui::SliderFloat("##Outer_Cutoff", &light.outerCutOff, light.cutOff, 45.0f);
 
     ImGui::EndTable();
   }
+  // The light is uploaded again only when it changed (see ChangeObserver)
+  if (changed)
+    object.PatchComponent<SpotLight>();
 
   ImGui::SeparatorText("Advanced");
   ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.55f, 0.f, 0.f, 0.5f));
@@ -284,8 +304,9 @@ static void Insp_SpotLight(GameObject& object, SpotLight& light)
   }
   ImGui::PopStyleColor(3);
 }
-static void Insp_Transform_TableRow(StringView label, vec3f& values, f32 resetValue)
+static bool Insp_Transform_TableRow(StringView label, vec3f& values, f32 resetValue)
 {
+  bool changed = false;
   ImGui::PushID(label.data());
 
   // First column: label
@@ -305,12 +326,15 @@ static void Insp_Transform_TableRow(StringView label, vec3f& values, f32 resetVa
   ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{ 0.9f, 0.2f, 0.2f, 1.0f });
   ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{ 0.7f, 0.05f, 0.1f, 1.0f });
   if (ImGui::Button("X", buttonSize))
+  {
     values.x = resetValue;
+    changed = true;
+  }
   ImGui::PopStyleColor(3);
   ImGui::SameLine();
   ImGui::SetNextItemWidth(itemWidth);
   
-  ImGui::DragFloat("##X", &values.x, 0.1f);
+  changed |= ImGui::DragFloat("##X", &values.x, 0.1f);
   ImGui::SameLine();
 
   // Y value
@@ -318,11 +342,14 @@ static void Insp_Transform_TableRow(StringView label, vec3f& values, f32 resetVa
   ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{ 0.3f, 0.8f, 0.3f, 1.0f });
   ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{ 0.1f, 0.6f, 0.1f, 1.0f });
   if (ImGui::Button("Y", buttonSize))
+  {
     values.y = resetValue;
+    changed = true;
+  }
   ImGui::PopStyleColor(3);
   ImGui::SameLine();
   ImGui::SetNextItemWidth(itemWidth);
-  ImGui::DragFloat("##Y", &values.y, 0.1f);
+  changed |= ImGui::DragFloat("##Y", &values.y, 0.1f);
   ImGui::SameLine();
 
   // Z value
@@ -330,14 +357,18 @@ static void Insp_Transform_TableRow(StringView label, vec3f& values, f32 resetVa
   ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{ 0.2f, 0.35f, 0.9f, 1.0f });
   ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{ 0.05f, 0.2f, 0.7f, 1.0f });
   if (ImGui::Button("Z", buttonSize))
+  {
     values.z = resetValue;
+    changed = true;
+  }
   ImGui::PopStyleColor(3);
   ImGui::SameLine();
   ImGui::SetNextItemWidth(itemWidth);
-  ImGui::DragFloat("##Z", &values.z, 0.1f);
+  changed |= ImGui::DragFloat("##Z", &values.z, 0.1f);
   ImGui::PopStyleVar();
 
   ImGui::PopID();
+  return changed;
 }
 static void Insp_Transform(GameObject& object, Transform& transform)
 {
@@ -348,18 +379,35 @@ static void Insp_Transform(GameObject& object, Transform& transform)
     ImGui::TableSetupColumn(nullptr, ImGuiTableColumnFlags_WidthStretch);
 
     // First row: position
+    bool changed = false;
     ImGui::TableNextRow();
-    Insp_Transform_TableRow("Position", transform.position, 0.f);
-
-    // First row: Rotation
+    changed |= Insp_Transform_TableRow("Position", transform.position, 0.f);
+
+    // First row: Rotation, edited as Euler angles. Read from the quaternion again only when it changed elsewhere
+    // (another object, the gizmo), so that the angles stay as typed.
+    static entt::entity eulerObject = entt::null;
+    static quat eulerSource{};
+    static vec3f eulerAngles{};
+    if (eulerObject != object.id || eulerSource != transform.rotation)
+    {
+      eulerObject = object.id;
+      eulerAngles = transform.GetEulerAngles();
+    }
     ImGui::TableNextRow();
-    Insp_Transform_TableRow("Rotation", transform.rotation, 0.f);
+    if (Insp_Transform_TableRow("Rotation", eulerAngles, 0.f))
+    {
+      transform.SetEulerAngles(eulerAngles);
+      changed = true;
+    }
+    eulerSource = transform.rotation;
 
     // First row: Scale
     ImGui::TableNextRow();
-    Insp_Transform_TableRow("Scale", transform.scale, 1.f);
+    changed |= Insp_Transform_TableRow("Scale", transform.scale, 1.f);
 
-    transform.UpdateTransformation();
+    // Only an edit makes the transform and its children dirty
+    if (changed)
+      transform.UpdateTransformation();
 
     ImGui::EndTable();
   }
@@ -519,6 +567,8 @@ static void Insp_SkeletalMesh(GameObject& object, SkeletalMesh& skeleton)
   {
     object.RemoveComponent<SkeletalMesh>();
     object.RemoveComponent<Animator>();
+    if (object.HasComponent<MorphWeights>())
+      object.RemoveComponent<MorphWeights>();
   }
   ImGui::PopStyleColor(3);
 }
@@ -543,16 +593,19 @@ static void Insp_Animator(GameObject& object, Animator& animator)
     ImGui::Text("Current animation: none");
   }
 
+  // Switching animation fades from the current one over this duration
+  static f32 crossFadeDuration = 0.25f;
   if (ImGui::BeginCombo("Animation list", (!animAttached ? "Select animation" : animAttachedPath->string().c_str())))
   {
-    for (const Animation& animation : *animationsVector)
+    for (const Animation* animation : *animationsVector)
     {
-      const fs::path* path = animManager.GetAnimationPath(animation.id);
+      const fs::path* path = animManager.GetAnimationPath(animation->id);
       if (ImGui::Selectable(path->string().c_str(), animAttachedPath == path))
-        animator.SetTargetAnimation(&animation);
+        animator.CrossFade(animation, crossFadeDuration);
     }
     ImGui::EndCombo();
   }
+  ImGui::SliderFloat("Crossfade", &crossFadeDuration, 0.0f, 2.0f, "%.2f s");
 
   if (animAttached)
   {
@@ -590,6 +643,22 @@ static void Insp_Animator(GameObject& object, Animator& animator)
   }
 }
 
+static void Insp_MorphWeights(GameObject& object, MorphWeights& morphWeights)
+{
+  SkeletalMesh* skeleton = object.GetComponent<SkeletalMesh>();
+  if (!skeleton || !skeleton->morphTargets)
+    return;
+
+  const MorphTargetSet& targets = *skeleton->morphTargets;
+  ImGui::Text("Targets: %u, moved vertices: %u", targets.GetNumTargets(), targets.GetNumSlots());
+  morphWeights.weights.resize(targets.GetNumTargets(), 0.0f);
+  for (u32 i = 0; i < targets.GetNumTargets(); i++)
+    ImGui::SliderFloat(targets.GetTarget(i).name.data(), &morphWeights.weights[i], 0.0f, 1.0f, "%.2f");
+
+  if (ImGui::Button("Reset weights"))
+    morphWeights.weights = targets.GetDefaultWeights();
+}
+
 static void Insp_AddTransformComponent(GameObject& object) 
 {
   if (object.HasComponent<Transform>())
@@ -711,6 +780,8 @@ static void Insp_AddSkeletalMeshComponent(GameObject& object)
         auto& anComponent = object.AddComponent<Animator>();
         skeleton->Clone(skComponent);
         anComponent.SetTargetSkeleton(skComponent);
+        if (skComponent.morphTargets)
+          object.AddComponent<MorphWeights>(skComponent.morphTargets->GetDefaultWeights());
 
         path.clear();
       }
@@ -754,6 +825,11 @@ static void Insp_ListAllComponents(GameObject& object)
     if (ImGui::CollapsingHeader("Animator"))
       Insp_Animator(object, *animator);
   }
+  if (MorphWeights* morphWeights = object.GetComponent<MorphWeights>())
+  {
+    if (ImGui::CollapsingHeader("MorphWeights"))
+      Insp_MorphWeights(object, *morphWeights);
+  }
   if (Light* light = object.GetComponent<Light>())
   {
     if (ImGui::CollapsingHeader("Light"))
@@ -12,6 +12,7 @@
 //                  PRIVATE                  
 // ------------------------------------------
 
+// The gizmos move the world matrix: the transform takes it relative to its parent
 static void GizmoWorldTranslation(Transform& transform, const mat4f& view, const mat4f& proj)
 {
   mat4f& model = transform.GetTransformation();
@@ -29,7 +30,7 @@ static void GizmoWorldTranslation(Transform& transform, const mat4f& view, const
     quat  rotation{};
     vec3f skew{};
     vec4f perspective{};
-    glm::decompose(model, translation, rotation, scale, skew, perspective);
+    glm::decompose(glm::inverse(transform.GetParentTransformation()) * model, translation, rotation, scale, skew, perspective);
 
     transform.position = translation;
     transform.UpdateTransformation();
@@ -52,15 +53,9 @@ static void GizmoWorldRotation(Transform& transform, const mat4f& view, const ma
     quat  rotation{};
     vec3f skew{};
     vec4f perspective{};
-    glm::decompose(model, translation, rotation, scale, skew, perspective);
+    glm::decompose(glm::inverse(transform.GetParentTransformation()) * model, translation, rotation, scale, skew, perspective);
 
-    vec3f rotationDegrees = glm::eulerAngles(rotation);  /* Get vector rotation in radians */
-    rotationDegrees.x = glm::degrees(rotationDegrees.x); /* Convert it in degrees */
-    rotationDegrees.y = glm::degrees(rotationDegrees.y);
-    rotationDegrees.z = glm::degrees(rotationDegrees.z);
-    const vec3f deltaRotation = rotationDegrees - transform.rotation;
-
-    transform.rotation += deltaRotation;
+    transform.rotation = rotation;
     transform.UpdateTransformation();
   }
 }
@@ -81,7 +76,7 @@ static void GizmoWorldScaling(Transform& transform, const mat4f& view, const mat
     quat  rotation{};
     vec3f skew{};
     vec4f perspective{};
-    glm::decompose(model, translation, rotation, scale, skew, perspective);
+    glm::decompose(glm::inverse(transform.GetParentTransformation()) * model, translation, rotation, scale, skew, perspective);
 
     transform.scale = scale;
     transform.UpdateTransformation();